@@ -5,12 +5,67 @@
 
 let wasmModule = null;
 let isInitialized = false;
+let isLoading = true;
+
+// Settles once initBridge() finishes: true when the engine loaded
+let resolveReady;
+const readyPromise = new Promise((resolve) => { resolveReady = resolve; });
+
+// Last file picked through chooseFile(), collected by takeChosenFile()
+let chosenFile = null;
+const FILE_SLICE_SIZE = 4 * 1024 * 1024;
+
+/**
+ * Read a File into one preallocated buffer, a slice at a time, so no
+ * intermediate string or full-size ArrayBuffer copy is made
+ * @param {File} file
+ * @returns {Promise<Uint8Array>}
+ */
+async function readFileSlices(file) {
+    const bytes = new Uint8Array(file.size);
+    for (let offset = 0; offset < file.size; offset += FILE_SLICE_SIZE) {
+        const slice = file.slice(offset, offset + FILE_SLICE_SIZE);
+        bytes.set(new Uint8Array(await slice.arrayBuffer()), offset);
+    }
+    return bytes;
+}
+
+/**
+ * Result envelopes are returned as plain objects; callers read the fields
+ * directly so payloads are never JSON-encoded just to be unwrapped.
+ */
+const makeError = (msg) => ({ success: false, error: String(msg) });
+const makeSuccess = (res) => ({ success: true, result: res });
+const errorMessage = (e) => (e && e.message ? e.message : String(e));
+
+/**
+ * Parse the (small) validation JSON produced by Rust into an object
+ * @param {string} json - Validation result JSON
+ * @returns {Object} {isValid, error, stats}
+ */
+function parseValidation(json) {
+    try {
+        return JSON.parse(String(json || '{}'));
+    } catch (e) {
+        return makeValidationError(e);
+    }
+}
+
+function makeValidationError(e) {
+    return {
+        isValid: false,
+        error: { message: String(e && e.message ? e.message : e), line: 0, column: 0 },
+        stats: {}
+    };
+}
 
 /**
  * Initialize the Rust WASM module
+ * @param {Promise<WebAssembly.Module>|WebAssembly.Module} [compiled] - Module
+ *   already being compiled by the page; fetched and compiled here otherwise
  * @returns {Promise<void>}
  */
-async function initBridge() {
+async function initBridge(compiled) {
     if (isInitialized) {
         console.log('[Bridge] Already initialized');
         return;
@@ -20,9 +75,12 @@ async function initBridge() {
 
     try {
         const wasm = await import('./pkg/airgap_json_formatter.js');
-        await wasm.default();
+        const module = await compiled;
+        await wasm.default(module ? { module_or_path: module } : undefined);
         wasmModule = wasm;
         isInitialized = true;
+        isLoading = false;
+        resolveReady(true);
 
         console.log('[Airgap] Rust WASM module loaded');
         console.log('[Airgap] All processing happens locally in browser');
@@ -30,6 +88,8 @@ async function initBridge() {
         console.log('[Airgap] Mode Active - Ready for secure JSON processing');
     } catch (error) {
         console.error('[Airgap] Failed to initialize WASM:', error);
+        isLoading = false;
+        resolveReady(false);
         throw error;
     }
 }
@@ -46,17 +106,30 @@ const JsonBridge = {
         return isInitialized;
     },
 
+    /**
+     * Check if the engine is still loading
+     * @returns {boolean} false once initBridge() succeeded or failed
+     */
+    isLoading() {
+        return isLoading;
+    },
+
+    /**
+     * Wait for initBridge() to finish; the engine loads in the background
+     * while the Qt interface starts
+     * @returns {Promise<boolean>} true when the engine loaded
+     */
+    whenReady() {
+        return readyPromise;
+    },
+
     /**
      * Format JSON with specified indentation
      * @param {string} input - JSON string to format
      * @param {string} indentType - "spaces:2", "spaces:4", or "tabs"
-     * @returns {string} JSON string with {success: boolean, result?: string, error?: string}
+     * @returns {Object} {success: boolean, result?: string, error?: string}
      */
     formatJson(input, indentType) {
-        // Always return a valid JSON string, no matter what
-        const makeError = (msg) => JSON.stringify({ success: false, error: String(msg) });
-        const makeSuccess = (res) => JSON.stringify({ success: true, result: String(res) });
-
         if (!isInitialized) {
             return makeError('WASM not initialized');
         }
@@ -82,57 +155,47 @@ const JsonBridge = {
                 console.error('[Bridge] formatJson returned null/undefined');
                 return makeError('formatJson returned null/undefined');
             }
-            return makeSuccess(result);
+            return makeSuccess(String(result));
         } catch (e) {
             console.error('[Bridge] formatJson error:', e);
-            return makeError(e && e.message ? e.message : String(e));
+            return makeError(errorMessage(e));
         }
     },
 
     /**
      * Minify JSON by removing whitespace
      * @param {string} input - JSON string to minify
-     * @returns {string} JSON string with {success: boolean, result?: string, error?: string}
+     * @returns {Object} {success: boolean, result?: string, error?: string}
      */
     minifyJson(input) {
         if (!isInitialized) {
-            return JSON.stringify({ success: false, error: 'WASM not initialized' });
+            return makeError('WASM not initialized');
         }
         // Ensure input is a string
         const inputStr = String(input || '');
         try {
             const result = wasmModule.minifyJson(inputStr);
-            return JSON.stringify({ success: true, result: String(result || '') });
+            return makeSuccess(String(result || ''));
         } catch (e) {
-            return JSON.stringify({ success: false, error: String(e) });
+            return makeError(e);
         }
     },
 
     /**
      * Validate JSON and return statistics
      * @param {string} input - JSON string to validate
-     * @returns {string} JSON string with validation result
+     * @returns {Object} {isValid, error, stats}
      */
     validateJson(input) {
         if (!isInitialized) {
-            return JSON.stringify({
-                isValid: false,
-                error: { message: 'WASM not initialized', line: 0, column: 0 },
-                stats: {}
-            });
+            return makeValidationError('WASM not initialized');
         }
         // Ensure input is a string
         const inputStr = String(input || '');
         try {
-            // wasmModule.validateJson already returns a JSON string
-            const result = wasmModule.validateJson(inputStr);
-            return String(result || '{}');
+            return parseValidation(wasmModule.validateJson(inputStr));
         } catch (e) {
-            return JSON.stringify({
-                isValid: false,
-                error: { message: String(e), line: 0, column: 0 },
-                stats: {}
-            });
+            return makeValidationError(e);
         }
     },
 
@@ -156,6 +219,106 @@ const JsonBridge = {
         }
     },
 
+    /**
+     * Format UTF-8 JSON bytes with specified indentation.
+     * The input is a view into the Qt heap and is consumed synchronously.
+     * @param {Uint8Array} bytes - UTF-8 encoded JSON
+     * @param {string} indentType - "spaces:2", "spaces:4", or "tabs"
+     * @returns {Object} {success: boolean, result?: Uint8Array, error?: string}
+     */
+    formatJsonUtf8(bytes, indentType) {
+        if (!isInitialized) {
+            return makeError('WASM not initialized');
+        }
+        const indentStr = (indentType === null || indentType === undefined) ? 'spaces:4' : String(indentType);
+        try {
+            return makeSuccess(wasmModule.formatJsonBytes(bytes, indentStr));
+        } catch (e) {
+            console.error('[Bridge] formatJsonUtf8 error:', e);
+            return makeError(errorMessage(e));
+        }
+    },
+
+    /**
+     * Minify UTF-8 JSON bytes
+     * @param {Uint8Array} bytes - UTF-8 encoded JSON
+     * @returns {Object} {success: boolean, result?: Uint8Array, error?: string}
+     */
+    minifyJsonUtf8(bytes) {
+        if (!isInitialized) {
+            return makeError('WASM not initialized');
+        }
+        try {
+            return makeSuccess(wasmModule.minifyJsonBytes(bytes));
+        } catch (e) {
+            return makeError(errorMessage(e));
+        }
+    },
+
+    /**
+     * Validate UTF-8 JSON bytes and return statistics
+     * @param {Uint8Array} bytes - UTF-8 encoded JSON
+     * @returns {Object} {isValid, error, stats}
+     */
+    validateJsonUtf8(bytes) {
+        if (!isInitialized) {
+            return makeValidationError('WASM not initialized');
+        }
+        try {
+            return parseValidation(wasmModule.validateJsonBytes(bytes));
+        } catch (e) {
+            return makeValidationError(e);
+        }
+    },
+
+    /**
+     * Parse UTF-8 JSON bytes once and produce the requested outputs
+     * @param {Uint8Array} bytes - UTF-8 encoded JSON
+     * @param {string} indentType - Indent style for the formatted output
+     * @param {number} outputs - Bitwise OR of 1 (formatted), 2 (minified), 4 (stats)
+     * @returns {Object} {validation: {isValid, error, stats}, formatted?: Uint8Array, minified?: Uint8Array}
+     */
+    processJsonUtf8(bytes, indentType, outputs) {
+        if (!isInitialized) {
+            return { validation: makeValidationError('WASM not initialized') };
+        }
+        const indentStr = (indentType === null || indentType === undefined) ? 'spaces:4' : String(indentType);
+        let output = null;
+        try {
+            output = wasmModule.processJsonBytes(bytes, indentStr, outputs);
+            return {
+                validation: parseValidation(output.validation),
+                // Each buffer is handed over once, not copied per access
+                formatted: output.takeFormatted(),
+                minified: output.takeMinified()
+            };
+        } catch (e) {
+            console.error('[Bridge] processJsonUtf8 error:', e);
+            return { validation: makeValidationError(e) };
+        } finally {
+            if (output) {
+                output.free();
+            }
+        }
+    },
+
+    /**
+     * Highlight UTF-8 JSON bytes with syntax colors
+     * @param {Uint8Array} bytes - UTF-8 encoded JSON
+     * @returns {Uint8Array|string} Highlighted HTML as UTF-8 bytes, or escaped text
+     */
+    highlightJsonUtf8(bytes) {
+        if (!isInitialized) {
+            return this.escapeHtml(new TextDecoder().decode(bytes));
+        }
+        try {
+            return wasmModule.highlightJsonBytes(bytes);
+        } catch (e) {
+            console.error('[Bridge] highlightJsonUtf8 error:', e);
+            return this.escapeHtml(new TextDecoder().decode(bytes));
+        }
+    },
+
     /**
      * Escape HTML special characters
      * @param {string} text - Text to escape
@@ -256,82 +419,148 @@ const JsonBridge = {
     /**
      * Save JSON to history
      * @param {string} json - JSON content to save
-     * @returns {Promise<string>} JSON result with success/error
+     * @returns {Promise<Object>} {success, id?, error?}
      */
     async saveToHistory(json) {
         try {
             if (!window.HistoryStorage) {
-                return JSON.stringify({ success: false, error: 'HistoryStorage not available' });
+                return makeError('HistoryStorage not available');
             }
             const jsonStr = String(json || '');
             const result = await window.HistoryStorage.save(jsonStr);
-            // Ensure we always return a valid JSON string
+            // Always answer with an envelope
             if (result === null || result === undefined) {
-                return JSON.stringify({ success: false, error: 'HistoryStorage.save returned null' });
+                return makeError('HistoryStorage.save returned null');
             }
-            return JSON.stringify(result);
+            return result;
         } catch (e) {
             console.error('[Bridge] saveToHistory error:', e);
-            return JSON.stringify({ success: false, error: String(e && e.message ? e.message : e) });
+            return makeError(errorMessage(e));
         }
     },
 
     /**
      * Load all history entries
-     * @returns {Promise<string>} JSON array of entries
+     * @returns {Promise<Object>} {success, entries?, error?}
      */
     async loadHistory() {
         try {
             if (!window.HistoryStorage) {
-                return JSON.stringify({ success: false, error: 'HistoryStorage not available' });
+                return makeError('HistoryStorage not available');
             }
             const result = await window.HistoryStorage.loadAll();
             if (result === null || result === undefined) {
-                return JSON.stringify({ success: false, error: 'HistoryStorage.loadAll returned null' });
+                return makeError('HistoryStorage.loadAll returned null');
             }
-            return JSON.stringify(result);
+            return result;
         } catch (e) {
             console.error('[Bridge] loadHistory error:', e);
-            return JSON.stringify({ success: false, error: String(e && e.message ? e.message : e) });
+            return makeError(errorMessage(e));
+        }
+    },
+
+    /**
+     * Load one page of history entry metadata
+     * @param {number} offset - Matching entries to skip
+     * @param {number} limit - Maximum entries to return
+     * @param {string} query - Preview filter
+     * @returns {Promise<Object>} {success, entries?, total?, error?}
+     */
+    async loadHistoryPage(offset, limit, query) {
+        try {
+            if (!window.HistoryStorage) {
+                return makeError('HistoryStorage not available');
+            }
+            const result = await window.HistoryStorage.loadPage(offset, limit, query);
+            if (result === null || result === undefined) {
+                return makeError('HistoryStorage.loadPage returned null');
+            }
+            return result;
+        } catch (e) {
+            console.error('[Bridge] loadHistoryPage error:', e);
+            return makeError(errorMessage(e));
         }
     },
 
     /**
      * Get a single history entry by ID
      * @param {string} id - Entry ID
-     * @returns {Promise<string>} JSON entry or error
+     * @returns {Promise<Object>} {success, entry?, error?}
      */
     async getHistoryEntry(id) {
         if (!window.HistoryStorage) {
-            return JSON.stringify({ success: false, error: 'HistoryStorage not available' });
+            return makeError('HistoryStorage not available');
         }
         const result = await window.HistoryStorage.get(id);
-        return JSON.stringify(result);
+        return result;
     },
 
     /**
      * Delete a history entry by ID
      * @param {string} id - Entry ID to delete
-     * @returns {Promise<string>} JSON result
+     * @returns {Promise<Object>} {success, error?}
      */
     async deleteHistoryEntry(id) {
         if (!window.HistoryStorage) {
-            return JSON.stringify({ success: false, error: 'HistoryStorage not available' });
+            return makeError('HistoryStorage not available');
         }
         const result = await window.HistoryStorage.delete(id);
-        return JSON.stringify(result);
+        return result;
     },
 
     /**
      * Clear all history entries
-     * @returns {Promise<string>} JSON result
+     * @returns {Promise<Object>} {success, error?}
      */
     async clearHistory() {
         if (!window.HistoryStorage) {
-            return JSON.stringify({ success: false, error: 'HistoryStorage not available' });
+            return makeError('HistoryStorage not available');
         }
         const result = await window.HistoryStorage.clear();
-        return JSON.stringify(result);
+        return result;
+    },
+
+    /**
+     * Show a file picker; must be called from a user gesture. The outcome
+     * is collected with takeChosenFile() once the file has been read.
+     */
+    chooseFile() {
+        chosenFile = null;
+        const input = document.createElement('input');
+        input.type = 'file';
+        input.accept = '.json,application/json,text/plain';
+        input.addEventListener('cancel', () => {
+            chosenFile = { state: 'canceled' };
+        });
+        input.addEventListener('change', async () => {
+            const file = input.files && input.files[0];
+            if (!file) {
+                chosenFile = { state: 'canceled' };
+                return;
+            }
+            try {
+                const bytes = await readFileSlices(file);
+                chosenFile = { state: 'ready', name: file.name, size: file.size, bytes };
+            } catch (e) {
+                console.error('[Bridge] chooseFile read error:', e);
+                chosenFile = { state: 'error', error: errorMessage(e) };
+            }
+        });
+        input.click();
+    },
+
+    /**
+     * Collect the file picked by chooseFile()
+     * @returns {Object|null} null while pending, otherwise
+     *   {state: 'ready', name, size, bytes: Uint8Array} | {state: 'canceled'} |
+     *   {state: 'error', error}; {state: 'none'} once taken
+     */
+    takeChosenFile() {
+        const result = chosenFile;
+        if (result) {
+            chosenFile = { state: 'none' };
+        }
+        return result;
     },
 
     /**
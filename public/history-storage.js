@@ -1,11 +1,16 @@
 /**
  * IndexedDB storage layer for JSON history
  * Provides persistent storage for formatted JSON documents
+ *
+ * History entries hold metadata only. Content is stored once per SHA-256
+ * hash in the blobs store, deflate-compressed where CompressionStream is
+ * available, and is read only when a single entry is opened.
  */
 
 const DB_NAME = 'AirgapJsonFormatter';
-const DB_VERSION = 1;
+const DB_VERSION = 2;
 const STORE_NAME = 'history';
+const BLOB_STORE_NAME = 'blobs';
 const MAX_ENTRIES = 100;
 
 let db = null;
@@ -42,6 +47,15 @@ async function initHistoryDB() {
                 store.createIndex('contentHash', 'contentHash', { unique: false });
                 console.log('[History] Object store created');
             }
+
+            if (!database.objectStoreNames.contains(BLOB_STORE_NAME)) {
+                database.createObjectStore(BLOB_STORE_NAME, { keyPath: 'hash' });
+                console.log('[History] Blob store created');
+            }
+
+            if (event.oldVersion >= 1 && event.oldVersion < 2) {
+                migrateInlineContent(request.transaction);
+            }
         };
     });
 }
@@ -59,6 +73,58 @@ async function hashContent(content) {
     return hashArray.map(b => b.toString(16).padStart(2, '0')).join('');
 }
 
+/**
+ * Move v1 inline content into the blob store. Runs inside the upgrade
+ * transaction, which cannot await compression, so migrated blobs are
+ * stored uncompressed.
+ * @param {IDBTransaction} transaction - Version change transaction
+ */
+function migrateInlineContent(transaction) {
+    const history = transaction.objectStore(STORE_NAME);
+    const blobs = transaction.objectStore(BLOB_STORE_NAME);
+    const request = history.openCursor();
+
+    request.onsuccess = () => {
+        const cursor = request.result;
+        if (!cursor) {
+            return;
+        }
+        const entry = cursor.value;
+        if (typeof entry.content === 'string' && entry.contentHash) {
+            blobs.put({ hash: entry.contentHash, encoding: 'identity', data: entry.content });
+            delete entry.content;
+            cursor.update(entry);
+        }
+        cursor.continue();
+    };
+}
+
+/**
+ * Compress content for the blob store
+ * @param {string} content - Content to compress
+ * @returns {Promise<{encoding: string, data: ArrayBuffer|string}>}
+ */
+async function compressContent(content) {
+    if (typeof CompressionStream === 'undefined') {
+        return { encoding: 'identity', data: content };
+    }
+    const stream = new Blob([content]).stream().pipeThrough(new CompressionStream('deflate'));
+    return { encoding: 'deflate', data: await new Response(stream).arrayBuffer() };
+}
+
+/**
+ * Restore content from a blob record
+ * @param {{encoding: string, data: ArrayBuffer|string}} blob - Stored blob
+ * @returns {Promise<string>}
+ */
+async function decompressContent(blob) {
+    if (blob.encoding !== 'deflate') {
+        return blob.data;
+    }
+    const stream = new Blob([blob.data]).stream().pipeThrough(new DecompressionStream('deflate'));
+    return await new Response(stream).text();
+}
+
 /**
  * Find entry by content hash
  * @param {string} contentHash - Hash to search for
@@ -134,21 +200,55 @@ async function enforceLimit() {
 }
 
 /**
- * Add a new entry to history
- * @param {object} entry - Entry to add
+ * Add a new entry to history together with its content blob
+ * @param {object} entry - Entry metadata to add
+ * @param {object} blob - Compressed content keyed by entry.contentHash
  * @returns {Promise<void>}
  */
-async function addEntry(entry) {
+async function addEntry(entry, blob) {
     if (!db) await initHistoryDB();
 
     return new Promise((resolve, reject) => {
-        const transaction = db.transaction([STORE_NAME], 'readwrite');
-        const store = transaction.objectStore(STORE_NAME);
-        const request = store.add(entry);
+        const transaction = db.transaction([STORE_NAME, BLOB_STORE_NAME], 'readwrite');
+        transaction.objectStore(BLOB_STORE_NAME).put({ hash: entry.contentHash, ...blob });
+        transaction.objectStore(STORE_NAME).add(entry);
 
-        request.onsuccess = () => resolve();
-        request.onerror = () => reject(request.error);
+        transaction.oncomplete = () => resolve();
+        transaction.onerror = () => reject(transaction.error);
+    });
+}
+
+/**
+ * Read an entry and its content blob
+ * @param {string} id - Entry ID
+ * @returns {Promise<object|null>} Entry with content, or null if not found
+ */
+async function readEntry(id) {
+    if (!db) await initHistoryDB();
+
+    const { entry, blob } = await new Promise((resolve, reject) => {
+        const transaction = db.transaction([STORE_NAME, BLOB_STORE_NAME], 'readonly');
+        const request = transaction.objectStore(STORE_NAME).get(id);
+        const result = { entry: null, blob: null };
+
+        request.onsuccess = () => {
+            result.entry = request.result || null;
+            if (result.entry && result.entry.contentHash) {
+                const blobRequest = transaction.objectStore(BLOB_STORE_NAME).get(result.entry.contentHash);
+                blobRequest.onsuccess = () => { result.blob = blobRequest.result || null; };
+            }
+        };
+        transaction.oncomplete = () => resolve(result);
+        transaction.onerror = () => reject(transaction.error);
     });
+
+    if (!entry) {
+        return null;
+    }
+    if (blob) {
+        entry.content = await decompressContent(blob);
+    }
+    return entry;
 }
 
 /**
@@ -170,7 +270,7 @@ async function updateEntry(entry) {
 }
 
 /**
- * Delete an entry by ID
+ * Delete an entry by ID, and its blob once no entry refers to it
  * @param {string} id - Entry ID to delete
  * @returns {Promise<void>}
  */
@@ -178,12 +278,27 @@ async function deleteEntry(id) {
     if (!db) await initHistoryDB();
 
     return new Promise((resolve, reject) => {
-        const transaction = db.transaction([STORE_NAME], 'readwrite');
+        const transaction = db.transaction([STORE_NAME, BLOB_STORE_NAME], 'readwrite');
         const store = transaction.objectStore(STORE_NAME);
-        const request = store.delete(id);
+        const request = store.get(id);
 
-        request.onsuccess = () => resolve();
-        request.onerror = () => reject(request.error);
+        request.onsuccess = () => {
+            const entry = request.result;
+            if (!entry) {
+                return;
+            }
+            store.delete(id);
+            if (entry.contentHash) {
+                const refs = store.index('contentHash').count(entry.contentHash);
+                refs.onsuccess = () => {
+                    if (refs.result === 0) {
+                        transaction.objectStore(BLOB_STORE_NAME).delete(entry.contentHash);
+                    }
+                };
+            }
+        };
+        transaction.oncomplete = () => resolve();
+        transaction.onerror = () => reject(transaction.error);
     });
 }
 
@@ -224,19 +339,22 @@ const HistoryStorage = {
                 return { success: true, id: existing.id, updated: true };
             }
 
+            // Compress before opening the write transaction; IndexedDB
+            // transactions cannot stay open across other awaits
+            const blob = await compressContent(json);
+
             // Enforce limit before adding new entry
             await enforceLimit();
 
             const entry = {
                 id: crypto.randomUUID(),
-                content: json,
                 contentHash: contentHash,
                 timestamp: new Date().toISOString(),
                 preview: json.substring(0, 100),
                 size: new Blob([json]).size
             };
 
-            await addEntry(entry);
+            await addEntry(entry, blob);
             return { success: true, id: entry.id, updated: false };
         } catch (e) {
             console.error('[History] Save failed:', e);
@@ -245,7 +363,8 @@ const HistoryStorage = {
     },
 
     /**
-     * Load all history entries sorted by timestamp (newest first)
+     * Load all history entries sorted by timestamp (newest first).
+     * Entries carry metadata only; use get() for the content.
      * @returns {Promise<{success: boolean, entries?: Array, error?: string}>}
      */
     async loadAll() {
@@ -274,30 +393,67 @@ const HistoryStorage = {
     },
 
     /**
-     * Get a single entry by ID
-     * @param {string} id - Entry ID
-     * @returns {Promise<{success: boolean, entry?: object, error?: string}>}
+     * Load one page of entry metadata, newest first, optionally keeping
+     * only entries whose preview contains query (case-insensitive)
+     * @param {number} offset - Matching entries to skip
+     * @param {number} limit - Maximum entries to return
+     * @param {string} query - Preview filter; empty matches every entry
+     * @returns {Promise<{success: boolean, entries?: Array, total?: number, error?: string}>}
      */
-    async get(id) {
+    async loadPage(offset, limit, query) {
         try {
             if (!db) await initHistoryDB();
 
+            const needle = String(query || '').toLowerCase();
             return new Promise((resolve, reject) => {
                 const transaction = db.transaction([STORE_NAME], 'readonly');
-                const store = transaction.objectStore(STORE_NAME);
-                const request = store.get(id);
+                const index = transaction.objectStore(STORE_NAME).index('timestamp');
+                const request = index.openCursor(null, 'prev');
+                const entries = [];
+                let total = 0;
 
                 request.onsuccess = () => {
-                    if (request.result) {
-                        resolve({ success: true, entry: request.result });
-                    } else {
-                        resolve({ success: false, error: 'Entry not found' });
+                    const cursor = request.result;
+                    if (!cursor) {
+                        resolve({ success: true, entries, total });
+                        return;
+                    }
+                    const entry = cursor.value;
+                    if (!needle || String(entry.preview || '').toLowerCase().includes(needle)) {
+                        if (total >= offset && entries.length < limit) {
+                            entries.push({
+                                id: entry.id,
+                                timestamp: entry.timestamp,
+                                preview: entry.preview,
+                                size: entry.size
+                            });
+                        }
+                        total++;
                     }
+                    cursor.continue();
                 };
                 request.onerror = () => {
                     reject({ success: false, error: String(request.error) });
                 };
             });
+        } catch (e) {
+            console.error('[History] LoadPage failed:', e);
+            return { success: false, error: String(e) };
+        }
+    },
+
+    /**
+     * Get a single entry by ID
+     * @param {string} id - Entry ID
+     * @returns {Promise<{success: boolean, entry?: object, error?: string}>}
+     */
+    async get(id) {
+        try {
+            const entry = await readEntry(id);
+            if (entry) {
+                return { success: true, entry };
+            }
+            return { success: false, error: 'Entry not found' };
         } catch (e) {
             console.error('[History] Get failed:', e);
             return { success: false, error: String(e) };
@@ -328,12 +484,12 @@ const HistoryStorage = {
             if (!db) await initHistoryDB();
 
             return new Promise((resolve, reject) => {
-                const transaction = db.transaction([STORE_NAME], 'readwrite');
-                const store = transaction.objectStore(STORE_NAME);
-                const request = store.clear();
+                const transaction = db.transaction([STORE_NAME, BLOB_STORE_NAME], 'readwrite');
+                transaction.objectStore(STORE_NAME).clear();
+                transaction.objectStore(BLOB_STORE_NAME).clear();
 
-                request.onsuccess = () => resolve({ success: true });
-                request.onerror = () => reject({ success: false, error: String(request.error) });
+                transaction.oncomplete = () => resolve({ success: true });
+                transaction.onerror = () => reject({ success: false, error: String(transaction.error) });
             });
         } catch (e) {
             console.error('[History] Clear failed:', e);
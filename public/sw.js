@@ -3,7 +3,7 @@
  * Enables offline functionality by caching all application assets
  */
 
-const CACHE_NAME = 'airgap-json-formatter-v4';
+const CACHE_NAME = 'airgap-json-formatter-v5';
 
 // Assets to precache for offline use (relative paths for GitHub Pages compatibility)
 const PRECACHE_ASSETS = [
@@ -12,6 +12,7 @@ const PRECACHE_ASSETS = [
     './bridge.js',
     './history-storage.js',
     './jspi-detect.js',
+    './wasm-loader.js',
     './pkg/airgap_json_formatter.js',
     './pkg/airgap_json_formatter_bg.wasm',
     './manifest.json',
@@ -0,0 +1,57 @@
+/**
+ * @file wasm-loader.js
+ * @brief Streaming compilation of the app's WebAssembly modules
+ *
+ * Both modules (Qt GUI and Rust JSON engine) are compiled with
+ * WebAssembly.compileStreaming, so compilation runs while the bytes
+ * download and the two compile in parallel. The service worker serves the
+ * .wasm files from Cache Storage under their own URLs; browsers with a
+ * compiled-code cache (Chrome, Edge) key it on that response and skip
+ * recompiling on repeat launches. Browsers no longer allow storing a
+ * WebAssembly.Module in IndexedDB, so the code cache is the durable copy.
+ */
+
+/**
+ * Compile the module at url, streaming where the response allows it
+ * @param {string} url - Path of the .wasm file
+ * @returns {Promise<WebAssembly.Module>}
+ */
+export async function compileWasm(url) {
+    const started = performance.now();
+    const response = fetch(url);
+    let module;
+    try {
+        if (typeof WebAssembly.compileStreaming !== 'function') {
+            throw new TypeError('compileStreaming unavailable');
+        }
+        module = await WebAssembly.compileStreaming(response);
+    } catch (error) {
+        // Servers without the application/wasm type, or older browsers:
+        // compile from the whole buffer instead
+        console.warn(`[WasmLoader] Streaming compile failed for ${url}, compiling from buffer:`, error.message);
+        const fallback = await fetch(url);
+        if (!fallback.ok) {
+            throw new Error(`Failed to fetch ${url}: ${fallback.status}`);
+        }
+        module = await WebAssembly.compile(await fallback.arrayBuffer());
+    }
+    console.log(`[WasmLoader] Compiled ${url} in ${Math.round(performance.now() - started)} ms`);
+    return module;
+}
+
+/**
+ * Emscripten instantiateWasm hook instantiating an already compiling module
+ * @param {Promise<WebAssembly.Module>} modulePromise - From compileWasm()
+ * @param {function(Error)} onError - Called when compiling or instantiating fails
+ * @returns {function(Object, function)} Hook for the Emscripten module config
+ */
+export function instantiateCompiled(modulePromise, onError) {
+    return (imports, receiveInstance) => {
+        modulePromise
+            .then((module) => WebAssembly.instantiate(module, imports)
+                .then((instance) => receiveInstance(instance, module)))
+            .catch(onError);
+        // Exports arrive through receiveInstance
+        return {};
+    };
+}
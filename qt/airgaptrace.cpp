@@ -0,0 +1,171 @@
+#include "airgaptrace.h"
+
+#ifdef AIRGAP_TRACING
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace {
+
+// operator new calls on the current thread. Plain integers, so counting
+// never allocates.
+thread_local quint64 t_operatorNewCalls = 0;
+thread_local quint64 t_operatorNewBytes = 0;
+
+struct ZoneEvent {
+    const char* name;
+    qint64 startNs;
+    qint64 durationNs;
+    quint64 operatorNewCalls;
+    quint64 operatorNewBytes;
+};
+
+// One thread's zones as a ring buffer; the mutex is only contended while
+// a trace is exported
+struct ThreadBuffer {
+    int tid = 0;
+    QMutex mutex;
+    std::vector<ZoneEvent> events;
+    size_t start = 0;
+};
+
+// Never destroyed, so zones closing during static destruction still have
+// somewhere to go
+QMutex& registryMutex()
+{
+    static QMutex* mutex = new QMutex;
+    return *mutex;
+}
+
+std::vector<std::shared_ptr<ThreadBuffer>>& registry()
+{
+    static auto* buffers = new std::vector<std::shared_ptr<ThreadBuffer>>;
+    return *buffers;
+}
+
+// The registry shares ownership, so zones outlive their thread
+ThreadBuffer& threadBuffer()
+{
+    thread_local const std::shared_ptr<ThreadBuffer> buffer = []() {
+        auto created = std::make_shared<ThreadBuffer>();
+        QMutexLocker lock(&registryMutex());
+        created->tid = int(registry().size()) + 1;
+        registry().push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    ++t_operatorNewCalls;
+    t_operatorNewBytes += size;
+    if (void* memory = std::malloc(size > 0 ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace AirgapTrace {
+
+Zone::Zone(const char* name) noexcept
+    : m_name(name)
+    , m_operatorNewCalls(t_operatorNewCalls)
+    , m_operatorNewBytes(t_operatorNewBytes)
+    , m_startNs(nowNs())
+{
+}
+
+Zone::~Zone()
+{
+    const qint64 endNs = nowNs();
+    const ZoneEvent event{m_name, m_startNs, endNs - m_startNs, t_operatorNewCalls - m_operatorNewCalls,
+                          t_operatorNewBytes - m_operatorNewBytes};
+
+    {
+        ThreadBuffer& buffer = threadBuffer();
+        QMutexLocker lock(&buffer.mutex);
+        if (buffer.events.size() < size_t(MaxEventsPerThread)) {
+            buffer.events.push_back(event);
+        } else {
+            buffer.events[buffer.start] = event;
+            buffer.start = (buffer.start + 1) % buffer.events.size();
+        }
+    }
+
+    // Growing the buffer is the tracer's own work, not the enclosing zone's
+    t_operatorNewCalls = m_operatorNewCalls + event.operatorNewCalls;
+    t_operatorNewBytes = m_operatorNewBytes + event.operatorNewBytes;
+}
+
+QByteArray appendTo(const QByteArray& chromeTrace)
+{
+    QJsonObject trace = QJsonDocument::fromJson(chromeTrace).object();
+    QJsonArray events = trace["traceEvents"].toArray();
+    events.append(QJsonObject{{"name", "process_name"}, {"ph", "M"}, {"pid", 2},
+                              {"args", QJsonObject{{"name", "Trace zones"}}}});
+
+    QMutexLocker registryLock(&registryMutex());
+    for (const std::shared_ptr<ThreadBuffer>& buffer : registry()) {
+        QMutexLocker lock(&buffer->mutex);
+        events.append(QJsonObject{{"name", "thread_name"}, {"ph", "M"}, {"pid", 2}, {"tid", buffer->tid},
+                                  {"args", QJsonObject{{"name", QString("thread %1").arg(buffer->tid)}}}});
+
+        for (size_t i = 0; i < buffer->events.size(); ++i) {
+            const ZoneEvent& event = buffer->events[(buffer->start + i) % buffer->events.size()];
+            const QJsonObject args{{"operatorNewCalls", double(event.operatorNewCalls)},
+                                   {"operatorNewBytes", double(event.operatorNewBytes)}};
+            events.append(QJsonObject{{"name", QString::fromLatin1(event.name)}, {"cat", "zone"}, {"ph", "X"},
+                                      {"ts", event.startNs / 1000.0}, {"dur", event.durationNs / 1000.0},
+                                      {"pid", 2}, {"tid", buffer->tid}, {"args", args}});
+        }
+    }
+
+    trace["traceEvents"] = events;
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+void clear()
+{
+    QMutexLocker registryLock(&registryMutex());
+    for (const std::shared_ptr<ThreadBuffer>& buffer : registry()) {
+        QMutexLocker lock(&buffer->mutex);
+        buffer->events.clear();
+        buffer->start = 0;
+    }
+}
+
+} // namespace AirgapTrace
+#endif
@@ -0,0 +1,70 @@
+#ifndef AIRGAPTRACE_H
+#define AIRGAPTRACE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+
+// Scoped trace zones for the hot paths inside an operation.
+//
+// AIRGAP_TRACE_ZONE("name") times the rest of the enclosing scope and
+// counts the operator new calls made on its thread meanwhile, nested zones
+// included. Zones are kept per thread, the most recent MaxEventsPerThread
+// of each, and AsyncSerialiser::chromeTrace() adds them to its task trace
+// as Chrome trace events, which Perfetto and Tracy's chrome importer read.
+// The name must be a string literal.
+//
+// Zones only exist when built with the AIRGAP_TRACING CMake option: the
+// macro expands to nothing otherwise, and the counters replace the global
+// operator new and delete only in tracing builds. The zone args say what
+// is counted, operatorNewCalls and operatorNewBytes: QString, QByteArray
+// and QList buffers come from malloc inside Qt and are not seen, and
+// over-aligned allocations are left to the default operator.
+namespace AirgapTrace {
+
+// Monotonic nanoseconds, shared by the zones and the task trace so that
+// both line up in one timeline
+inline qint64 nowNs()
+{
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed();
+}
+
+#ifdef AIRGAP_TRACING
+constexpr int MaxEventsPerThread = 100000;
+
+class Zone
+{
+public:
+    explicit Zone(const char* name) noexcept;
+    ~Zone();
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+private:
+    const char* m_name;
+    quint64 m_operatorNewCalls;
+    quint64 m_operatorNewBytes;
+    qint64 m_startNs;
+};
+
+// chromeTrace with the recorded zones appended as process 2
+QByteArray appendTo(const QByteArray& chromeTrace);
+void clear();
+#endif
+
+} // namespace AirgapTrace
+
+#ifdef AIRGAP_TRACING
+#define AIRGAP_TRACE_CONCAT_(a, b) a##b
+#define AIRGAP_TRACE_CONCAT(a, b) AIRGAP_TRACE_CONCAT_(a, b)
+#define AIRGAP_TRACE_ZONE(name) \
+    const AirgapTrace::Zone AIRGAP_TRACE_CONCAT(airgapTraceZone_, __LINE__)(name)
+#else
+#define AIRGAP_TRACE_ZONE(name) static_cast<void>(0)
+#endif
+
+#endif // AIRGAPTRACE_H
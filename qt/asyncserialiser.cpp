@@ -3,7 +3,19 @@
  * @brief Implementation of AsyncSerialiser task queue
  */
 #include "asyncserialiser.h"
+#include "airgaptrace.h"
 #include <QDebug>
+#include <QFile>
+#include <QPromise>
+#include <algorithm>
+
+// Worker tasks use a thread pool wherever threads exist and the JS bridge
+// is not involved
+#if defined(AIRGAP_HAS_CONCURRENT) && QT_CONFIG(thread) && !defined(__EMSCRIPTEN__)
+#define AIRGAP_WORKER_THREADS 1
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#endif
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten/emscripten.h>
@@ -18,11 +30,45 @@ AsyncSerialiser& AsyncSerialiser::instance()
     return instance;
 }
 
+#ifdef AIRGAP_WORKER_THREADS
+// Separate from the global pool, which builds tree models
+static QThreadPool& workerPool()
+{
+    static QThreadPool pool;
+    return pool;
+}
+#endif
+
+QFuture<QVariant> AsyncSerialiser::runOnWorker(WorkerJob job)
+{
+#ifdef AIRGAP_WORKER_THREADS
+    return QtConcurrent::run(&workerPool(), std::move(job));
+#else
+    QPromise<QVariant> promise;
+    auto future = promise.future();
+    promise.start();
+    promise.addResult(job());
+    promise.finish();
+    return future;
+#endif
+}
+
+int AsyncSerialiser::workerConcurrency()
+{
+#ifdef AIRGAP_WORKER_THREADS
+    return qMax(1, workerPool().maxThreadCount());
+#else
+    return 1;
+#endif
+}
+
 AsyncSerialiser::AsyncSerialiser()
+    : m_concurrentMode(concurrentModeSupported())
 {
-    m_watchdog.setSingleShot(true);
-    m_watchdog.setInterval(WATCHDOG_TIMEOUT_MS);
-    connect(&m_watchdog, &QTimer::timeout, this, &AsyncSerialiser::onWatchdogTimeout);
+    if (m_concurrentMode) {
+        qDebug() << "[AsyncSerialiser] JSPI mode: up to" << m_maxConcurrentTasks
+                 << "concurrent tasks";
+    }
 }
 
 AsyncSerialiser::~AsyncSerialiser()
@@ -30,88 +76,179 @@ AsyncSerialiser::~AsyncSerialiser()
     clearQueue();
 }
 
+bool AsyncSerialiser::concurrentModeSupported()
+{
+    // Concurrent suspensions need both a JSPI build and a JSPI-capable
+    // browser; Asyncify builds keep the single-flight FIFO
+#ifdef ENABLE_JSPI_BUILD
+    return jspiAvailable();
+#else
+    return false;
+#endif
+}
+
+void AsyncSerialiser::setMaxConcurrentTasks(int limit)
+{
+    limit = qMax(1, limit);
+    if (limit == m_maxConcurrentTasks) {
+        return;
+    }
+    m_maxConcurrentTasks = limit;
+    emit maxConcurrentTasksChanged();
+
+    // A raised limit may let queued tasks start now
+    QMetaObject::invokeMethod(this, &AsyncSerialiser::processNext, Qt::QueuedConnection);
+}
+
+void AsyncSerialiser::setWatchdogTimeout(int ms)
+{
+    m_watchdogTimeoutMs = qMax(1, ms);
+    m_metrics.setWatchdogMs(m_watchdogTimeoutMs);
+}
+
+bool AsyncSerialiser::isCurrentTaskSuperseded() const
+{
+    const int index = runningIndex(m_currentTaskId);
+    return index >= 0 && m_running.at(index).superseded;
+}
+
+void AsyncSerialiser::setCurrentTaskPayload(qint64 bytes)
+{
+    const int index = runningIndex(m_currentTaskId);
+    if (index >= 0)
+        m_running[index].timing.payloadBytes = bytes;
+}
+
+QByteArray AsyncSerialiser::chromeTrace() const
+{
+#ifdef AIRGAP_TRACING
+    // Zones use the same clock, so they line up with their tasks
+    return AirgapTrace::appendTo(m_metrics.chromeTrace());
+#else
+    return m_metrics.chromeTrace();
+#endif
+}
+
+bool AsyncSerialiser::exportChromeTrace(const QString& path) const
+{
+    const QByteArray trace = chromeTrace();
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "[AsyncSerialiser] Cannot write trace to" << path;
+        return false;
+    }
+    return file.write(trace) == trace.size();
+}
+
+void AsyncSerialiser::resetMetrics()
+{
+    m_metrics.reset();
+#ifdef AIRGAP_TRACING
+    AirgapTrace::clear();
+#endif
+    emit metricsChanged();
+}
+
 void AsyncSerialiser::enqueue(const QString& taskName, AsyncTask task)
 {
-    /*
-     * FUTURE JSPI BYPASS (Experimental)
-     * ==================================
-     * When JSPI (JavaScript Promise Integration) is widely supported, this bypass
-     * can be enabled to execute tasks directly without queuing. JSPI supports
-     * multiple concurrent WebAssembly suspensions, eliminating Asyncify's
-     * single-flight limitation.
-     *
-     * To enable JSPI bypass:
-     * 1. Build with -DENABLE_JSPI=ON in CMake
-     * 2. Uncomment the ENABLE_JSPI_RUNTIME_BYPASS block below
-     * 3. Test thoroughly in Chrome 137+ (or Firefox 130+ with flag enabled)
-     *
-     * The bypass maintains the same public API and signal emission pattern,
-     * ensuring drop-in compatibility when switching between Asyncify and JSPI modes.
-     *
-     * Browser Support Status (as of 2026-01):
-     * - Chrome 137+: JSPI enabled by default
-     * - Edge 137+: JSPI enabled (Chromium-based)
-     * - Firefox 130+: Behind flag (javascript.options.wasm_jspi)
-     * - Safari: Not supported (no timeline announced)
-     *
-     * Uncomment to enable:
-     *
-     * #ifdef ENABLE_JSPI_RUNTIME_BYPASS
-     * if (jspiAvailable()) {
-     *     // JSPI mode: Execute task directly without queuing
-     *     // JSPI supports concurrent suspensions, so no serialization needed
-     *     qDebug() << "[AsyncSerialiser] JSPI mode: direct execution for" << taskName;
-     *     emit taskStarted(taskName);
-     *
-     *     try {
-     *         QFuture<QVariant> future = task();
-     *
-     *         // Set up watcher for completion notification
-     *         auto* watcher = new QFutureWatcher<QVariant>(this);
-     *         connect(watcher, &QFutureWatcher<QVariant>::finished, this,
-     *             [this, watcher, taskName]() {
-     *                 bool success = !watcher->future().isCanceled();
-     *                 qDebug() << "[AsyncSerialiser] JSPI task completed:" << taskName
-     *                          << "Success:" << success;
-     *                 emit taskCompleted(taskName, success);
-     *                 watcher->deleteLater();
-     *             });
-     *         watcher->setFuture(future);
-     *     } catch (const std::exception& e) {
-     *         qWarning() << "[AsyncSerialiser] JSPI task exception:" << taskName
-     *                    << "-" << e.what();
-     *         emit taskCompleted(taskName, false);
-     *     } catch (...) {
-     *         qWarning() << "[AsyncSerialiser] JSPI task unknown exception:" << taskName;
-     *         emit taskCompleted(taskName, false);
-     *     }
-     *     return;
-     * }
-     * #endif
-     */
-
-    // Standard queue-based execution (Asyncify mode)
-    // This path serializes tasks to prevent concurrent Asyncify suspensions
+    enqueue(taskName, QString(), std::move(task), Priority::Normal);
+}
+
+void AsyncSerialiser::enqueue(const QString& taskName, Priority priority, AsyncTask task)
+{
+    enqueue(taskName, QString(), std::move(task), priority);
+}
+
+void AsyncSerialiser::enqueue(const QString& taskName, const QString& coalesceKey, AsyncTask task,
+                              Priority priority)
+{
+    enqueueTask({taskName, coalesceKey, std::move(task), Delivery()}, priority);
+}
+
+void AsyncSerialiser::enqueueWorker(const QString& taskName, const QString& coalesceKey, AsyncTask task,
+                                    Delivery deliver, Priority priority)
+{
+    if (!deliver) {
+        // Without a delivery, worker tasks would never report a result
+        deliver = [](const QVariant&) {};
+    }
+    enqueueTask({taskName, coalesceKey, std::move(task), std::move(deliver)}, priority);
+}
+
+void AsyncSerialiser::enqueueWorker(const QString& taskName, AsyncTask task, Delivery deliver)
+{
+    enqueueWorker(taskName, QString(), std::move(task), std::move(deliver));
+}
+
+void AsyncSerialiser::enqueueTask(QueuedTask queued, Priority priority)
+{
+    // Every task goes through the queue. In Asyncify builds at most one runs
+    // at a time; in JSPI mode processNext() starts independent tasks early.
+    const QString taskName = queued.name;
+    const QString coalesceKey = queued.coalesceKey;
+    queued.lane = laneIndex(priority);
+    queued.enqueuedNs = m_metrics.now();
+
+    if (!coalesceKey.isEmpty()) {
+        // A running task with the same key now produces a stale result
+        for (RunningTask& running : m_running) {
+            if (running.coalesceKey == coalesceKey && !running.superseded) {
+                running.superseded = true;
+                qDebug() << "[AsyncSerialiser] Running task superseded:" << running.name;
+                m_metrics.recordSuperseded(running.name);
+                emit taskSuperseded(running.name);
+                emit metricsChanged();
+            }
+        }
+
+        // Replace a pending task with the same key instead of appending
+        for (int lane = 0; lane < LANE_COUNT; ++lane) {
+            for (int i = 0; i < m_lanes[lane].size(); ++i) {
+                QueuedTask& pending = m_lanes[lane][i];
+                if (pending.coalesceKey != coalesceKey)
+                    continue;
+
+                qDebug() << "[AsyncSerialiser] Coalesced task:" << pending.name
+                         << "replaced by" << taskName;
+                const QString replacedName = pending.name;
+                if (lane == laneIndex(priority)) {
+                    pending = std::move(queued);
+                } else {
+                    m_lanes[lane].removeAt(i);
+                    m_lanes[laneIndex(priority)].enqueue(std::move(queued));
+                    emit queueLengthChanged();
+                }
+                m_metrics.recordSuperseded(replacedName);
+                emit taskSuperseded(replacedName);
+                emit metricsChanged();
+                return;
+            }
+        }
+    }
 
     // Check queue size limit to prevent unbounded growth
-    if (m_queue.size() >= MAX_QUEUE_SIZE) {
+    if (queueLength() >= MAX_QUEUE_SIZE) {
         qWarning() << "[AsyncSerialiser] Queue full (" << MAX_QUEUE_SIZE
                    << "), rejecting task:" << taskName;
+        m_metrics.recordRejected(taskName);
         emit taskRejected(taskName);
+        emit metricsChanged();
         return;
     }
 
-    m_queue.enqueue({taskName, std::move(task)});
+    m_lanes[laneIndex(priority)].enqueue(std::move(queued));
     emit queueLengthChanged();
 
+    const int length = queueLength();
+    m_metrics.recordQueueLength(length);
     qDebug() << "[AsyncSerialiser] Enqueued task:" << taskName
-             << "Queue size:" << m_queue.size();
+             << "Priority:" << laneIndex(priority) << "Queue size:" << length;
 
     // Emit warning if queue is getting long
-    if (m_queue.size() > QUEUE_LENGTH_WARNING_THRESHOLD) {
-        qWarning() << "[AsyncSerialiser] Queue length warning: " << m_queue.size()
+    if (length > QUEUE_LENGTH_WARNING_THRESHOLD) {
+        qWarning() << "[AsyncSerialiser] Queue length warning: " << length
                    << " tasks pending (threshold: " << QUEUE_LENGTH_WARNING_THRESHOLD << ")";
-        emit queueLengthWarning(m_queue.size());
+        emit queueLengthWarning(length);
     }
 
     // Use invokeMethod to process on next event loop tick
@@ -121,45 +258,168 @@ void AsyncSerialiser::enqueue(const QString& taskName, AsyncTask task)
 
 void AsyncSerialiser::clearQueue()
 {
-    qDebug() << "[AsyncSerialiser] Clearing queue. Pending tasks:" << m_queue.size();
+    qDebug() << "[AsyncSerialiser] Clearing queue. Pending tasks:" << queueLength()
+             << "Running:" << m_running.size();
 
-    m_queue.clear();
-    m_watchdog.stop();
-#ifdef __EMSCRIPTEN__
-    stopEmscriptenWatchdog();
-#endif
-
-    if (m_watcher) {
-        m_watcher->cancel();
-        m_watcher->deleteLater();
-        m_watcher = nullptr;
+    for (int lane = 0; lane < LANE_COUNT; ++lane) {
+        m_lanes[lane].clear();
+        m_skipCounts[lane] = 0;
     }
 
-    m_isBusy = false;
+    while (!m_running.isEmpty()) {
+        releaseTask(m_running.size() - 1, true);
+    }
+    m_currentTaskId = 0;
     emit queueLengthChanged();
 }
 
 void AsyncSerialiser::processNext()
 {
-    // CRITICAL: The single-flight guard
-    if (m_isBusy || m_queue.isEmpty()) {
-        return;
+    // CRITICAL: The single-flight guard lives in canStart() (the limit is
+    // 1 outside JSPI mode, except between worker tasks)
+    QueuedTask next;
+    while (takeNextTask(next)) {
+        startTask(std::move(next));
+    }
+}
+
+bool AsyncSerialiser::takeNextTask(QueuedTask& next)
+{
+    int selected = -1;
+    int ready[LANE_COUNT];
+    for (int lane = 0; lane < LANE_COUNT; ++lane) {
+        ready[lane] = firstReadyIndex(lane);
+    }
+
+    // Starvation protection: a lane passed over too often runs next
+    for (int lane = 1; lane < LANE_COUNT && selected < 0; ++lane) {
+        if (ready[lane] >= 0 && m_skipCounts[lane] >= STARVATION_LIMIT) {
+            qDebug() << "[AsyncSerialiser] Serving starved lane:" << lane;
+            selected = lane;
+        }
+    }
+
+    // Otherwise the highest-priority lane with a runnable task
+    for (int lane = 0; lane < LANE_COUNT && selected < 0; ++lane) {
+        if (ready[lane] >= 0) {
+            selected = lane;
+        }
     }
 
-    m_isBusy = true;
-    QueuedTask queued = m_queue.dequeue();
-    m_currentTaskName = queued.name;
+    if (selected < 0) {
+        return false;
+    }
+
+    m_skipCounts[selected] = 0;
+    for (int lane = selected + 1; lane < LANE_COUNT; ++lane) {
+        if (!m_lanes[lane].isEmpty()) {
+            ++m_skipCounts[lane];
+        }
+    }
+
+    next = m_lanes[selected].takeAt(ready[selected]);
     emit queueLengthChanged();
+    return true;
+}
 
-    qDebug() << "[AsyncSerialiser] Starting task:" << m_currentTaskName
-             << "Queue remaining:" << m_queue.size();
-    emit taskStarted(m_currentTaskName);
+int AsyncSerialiser::firstReadyIndex(int lane) const
+{
+    // Outside JSPI mode only the head may start, so a lane stays FIFO even
+    // while worker tasks overlap
+    const QQueue<QueuedTask>& queue = m_lanes[lane];
+    const int candidates = m_concurrentMode ? queue.size() : qMin(1, int(queue.size()));
+    for (int i = 0; i < candidates; ++i) {
+        if (canStart(queue.at(i))) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-    // Start watchdog (Qt timer + emscripten fallback for WASM reliability)
-    m_watchdog.start();
+bool AsyncSerialiser::canStart(const QueuedTask& task) const
+{
+    if (m_running.isEmpty()) {
+        return true;
+    }
+
+    int workers = 0;
+    for (const RunningTask& running : m_running) {
+        if (running.worker)
+            ++workers;
+    }
+
+    if (task.deliver) {
+        // Worker tasks overlap each other, never main-thread tasks; ordered
+        // delivery keeps same-named tasks in order, so only a shared
+        // coalescing key makes them dependent
+        if (workers < m_running.size() || workers >= workerConcurrency())
+            return false;
+        for (const RunningTask& running : m_running) {
+            if (!task.coalesceKey.isEmpty() && running.coalesceKey == task.coalesceKey)
+                return false;
+        }
+        return true;
+    }
+
+    return workers == 0 && m_running.size() < effectiveConcurrency() && !conflictsWithRunning(task);
+}
+
+bool AsyncSerialiser::conflictsWithRunning(const QueuedTask& task) const
+{
+    // Tasks sharing a name or coalescing key stay ordered with respect to
+    // each other; anything else is independent
+    for (const RunningTask& running : m_running) {
+        if (running.name == task.name)
+            return true;
+        if (!task.coalesceKey.isEmpty() && running.coalesceKey == task.coalesceKey)
+            return true;
+    }
+    return false;
+}
+
+void AsyncSerialiser::startTask(QueuedTask queued)
+{
+    AIRGAP_TRACE_ZONE("AsyncSerialiser::startTask");
+    RunningTask running;
+    running.id = ++m_nextTaskId;
+    running.name = queued.name;
+    running.coalesceKey = queued.coalesceKey;
+    running.worker = bool(queued.deliver);
+    running.deliver = std::move(queued.deliver);
+    running.timing.id = running.id;
+    running.timing.name = running.name;
+    running.timing.lane = queued.lane;
+    running.timing.track = freeTrack();
+    running.timing.enqueuedNs = queued.enqueuedNs;
+    running.timing.startedNs = m_metrics.now();
+
+    const quint64 id = running.id;
+    const QString taskName = running.name;
+
+    // Per-task watchdog (Qt timer + emscripten fallback for WASM reliability).
+    // Worker jobs cannot be stopped once on the pool, and a timed-out task
+    // is never delivered, so worker tasks are left to finish.
+    if (!running.worker) {
+        running.watchdog = new QTimer(this);
+        running.watchdog->setSingleShot(true);
+        running.watchdog->setInterval(m_watchdogTimeoutMs);
+        connect(running.watchdog, &QTimer::timeout, this, [this, id]() { onWatchdogTimeout(id); });
+    }
+
+    m_running.append(running);
+    m_currentTaskId = id;
+    emit queueLengthChanged();
+
+    qDebug() << "[AsyncSerialiser] Starting task:" << taskName
+             << "Queue remaining:" << queueLength() << "Running:" << m_running.size();
+    emit taskStarted(taskName);
+
+    if (m_running.last().watchdog) {
+        m_running.last().watchdog->start();
 #ifdef __EMSCRIPTEN__
-    startEmscriptenWatchdog();
+        startEmscriptenWatchdog(m_running.last());
 #endif
+    }
 
     // Execute the task - handle exceptions to prevent queue blockage
     QFuture<QVariant> future;
@@ -167,97 +427,216 @@ void AsyncSerialiser::processNext()
         // Execute the task - this may trigger Asyncify suspension
         future = queued.task();
     } catch (const std::exception& e) {
-        qWarning() << "[AsyncSerialiser] Exception in task" << m_currentTaskName
-                   << ":" << e.what();
-        m_watchdog.stop();
-        emit taskCompleted(m_currentTaskName, false);
-        m_isBusy = false;
-        processNext();
+        qWarning() << "[AsyncSerialiser] Exception in task" << taskName << ":" << e.what();
+        recordFinished(runningIndex(id), false, false);
+        releaseTask(runningIndex(id), false);
+        emit taskCompleted(taskName, false);
         return;
     } catch (...) {
-        qWarning() << "[AsyncSerialiser] Unknown exception in task" << m_currentTaskName;
-        m_watchdog.stop();
-        emit taskCompleted(m_currentTaskName, false);
-        m_isBusy = false;
-        processNext();
+        qWarning() << "[AsyncSerialiser] Unknown exception in task" << taskName;
+        recordFinished(runningIndex(id), false, false);
+        releaseTask(runningIndex(id), false);
+        emit taskCompleted(taskName, false);
+        return;
+    }
+
+    const int index = runningIndex(id);
+    if (index < 0) {
+        // The task cleared the queue while running
         return;
     }
 
     // Set up watcher for completion
-    m_watcher = new QFutureWatcher<QVariant>(this);
-    connect(m_watcher, &QFutureWatcher<QVariant>::finished,
-            this, &AsyncSerialiser::onTaskFinished);
-    m_watcher->setFuture(future);
+    auto* watcher = new QFutureWatcher<QVariant>(this);
+    m_running[index].watcher = watcher;
+    connect(watcher, &QFutureWatcher<QVariant>::finished, this, [this, id]() { onTaskFinished(id); });
+    watcher->setFuture(future);
 }
 
-void AsyncSerialiser::onTaskFinished()
+int AsyncSerialiser::freeTrack() const
 {
-    m_watchdog.stop();
+    // Lowest trace row not used by a running task; row 0 is the queue
+    int track = 1;
+    while (std::any_of(m_running.cbegin(), m_running.cend(),
+                       [track](const RunningTask& running) { return running.timing.track == track; }))
+        ++track;
+    return track;
+}
+
+void AsyncSerialiser::recordFinished(int index, bool success, bool timedOut)
+{
+    if (index < 0)
+        return;
+
+    // Worker tasks finished when their future did, not when delivered
+    RunningTask& running = m_running[index];
+    if (running.timing.finishedNs == 0)
+        running.timing.finishedNs = m_metrics.now();
+    m_metrics.recordFinished(running.timing, success, timedOut);
+    emit metricsChanged();
+}
+
+int AsyncSerialiser::runningIndex(quint64 id) const
+{
+    for (int i = 0; i < m_running.size(); ++i) {
+        if (m_running.at(i).id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void AsyncSerialiser::releaseTask(int index, bool cancel)
+{
+    if (index < 0) {
+        return;
+    }
+
+    RunningTask running = m_running.takeAt(index);
+    if (running.watchdog) {
+        running.watchdog->stop();
+        running.watchdog->deleteLater();
+    }
 #ifdef __EMSCRIPTEN__
-    stopEmscriptenWatchdog();
+    stopEmscriptenWatchdog(running);
 #endif
 
-    bool success = !m_watcher->future().isCanceled();
-    qDebug() << "[AsyncSerialiser] Task completed:" << m_currentTaskName
-             << "Success:" << success;
+    if (running.watcher) {
+        running.watcher->disconnect(this);
+        if (cancel) {
+            running.watcher->cancel();
+        }
+        running.watcher->deleteLater();
+    }
+}
+
+int AsyncSerialiser::queueLength() const
+{
+    int length = 0;
+    for (const auto& lane : m_lanes) {
+        length += lane.size();
+    }
+    return length;
+}
+
+void AsyncSerialiser::onTaskFinished(quint64 id)
+{
+    const int index = runningIndex(id);
+    if (index < 0) {
+        return;
+    }
+
+    const QFuture<QVariant> future = m_running.at(index).watcher->future();
+    const bool success = !future.isCanceled();
+
+    if (m_running.at(index).worker) {
+        // Held until every earlier worker task has delivered
+        RunningTask& running = m_running[index];
+        running.timing.finishedNs = m_metrics.now();
+        running.finished = true;
+        running.succeeded = success;
+        if (success && future.resultCount() > 0)
+            running.result = future.result();
+        deliverFinishedWorkers();
+        processNext();
+        return;
+    }
 
-    emit taskCompleted(m_currentTaskName, success);
+    const QString taskName = m_running.at(index).name;
+    qDebug() << "[AsyncSerialiser] Task completed:" << taskName << "Success:" << success;
 
-    m_watcher->deleteLater();
-    m_watcher = nullptr;
-    m_isBusy = false;
+    recordFinished(index, success, false);
+    releaseTask(index, false);
+    emit taskCompleted(taskName, success);
 
     // Chain to next task
     processNext();
 }
 
-void AsyncSerialiser::onWatchdogTimeout()
+void AsyncSerialiser::deliverFinishedWorkers()
 {
-    qWarning() << "[AsyncSerialiser] WATCHDOG TIMEOUT for task:" << m_currentTaskName;
-
-#ifdef __EMSCRIPTEN__
-    stopEmscriptenWatchdog();
-#endif
+    // Workers finish in any order; results go out in start order. The
+    // running list is kept in start order.
+    while (!m_running.isEmpty() && m_running.first().worker && m_running.first().finished) {
+        const quint64 id = m_running.first().id;
+        const QString taskName = m_running.first().name;
+        const bool success = m_running.first().succeeded;
+        const Delivery deliver = std::move(m_running.first().deliver);
+        const QVariant result = std::move(m_running.first().result);
+
+        qDebug() << "[AsyncSerialiser] Task completed:" << taskName << "Success:" << success;
+
+        // Still listed as running, so isCurrentTaskSuperseded() applies
+        m_currentTaskId = id;
+        if (success) {
+            AIRGAP_TRACE_ZONE("AsyncSerialiser::deliver");
+            try {
+                deliver(result);
+            } catch (const std::exception& e) {
+                qWarning() << "[AsyncSerialiser] Exception delivering" << taskName << ":" << e.what();
+            } catch (...) {
+                qWarning() << "[AsyncSerialiser] Unknown exception delivering" << taskName;
+            }
+        }
 
-    emit taskTimedOut(m_currentTaskName);
-    emit taskCompleted(m_currentTaskName, false);
+        const int index = runningIndex(id);
+        recordFinished(index, success, false);
+        releaseTask(index, false);
+        emit taskCompleted(taskName, success);
+    }
+}
 
-    if (m_watcher) {
-        m_watcher->cancel();
-        m_watcher->deleteLater();
-        m_watcher = nullptr;
+void AsyncSerialiser::onWatchdogTimeout(quint64 id)
+{
+    const int index = runningIndex(id);
+    if (index < 0) {
+        return;
     }
 
-    m_isBusy = false;
+    const QString taskName = m_running.at(index).name;
+    qWarning() << "[AsyncSerialiser] WATCHDOG TIMEOUT for task:" << taskName;
+
+    recordFinished(index, false, true);
+    releaseTask(index, true);
+    emit taskTimedOut(taskName);
+    emit taskCompleted(taskName, false);
+
     processNext();
 }
 
 #ifdef __EMSCRIPTEN__
-void AsyncSerialiser::startEmscriptenWatchdog()
+void AsyncSerialiser::startEmscriptenWatchdog(RunningTask& task)
 {
-    stopEmscriptenWatchdog(); // Clear any existing timer
-    m_emscriptenTimerId = emscripten_set_timeout(
+    stopEmscriptenWatchdog(task); // Clear any existing timer
+    // The task id travels as user data; the callback looks the task up again
+    task.emscriptenTimerId = emscripten_set_timeout(
         &AsyncSerialiser::emscriptenWatchdogCallback,
-        WATCHDOG_TIMEOUT_MS,
-        this
+        m_watchdogTimeoutMs,
+        reinterpret_cast<void*>(static_cast<uintptr_t>(task.id))
     );
-    qDebug() << "[AsyncSerialiser] Started emscripten watchdog timer id:" << m_emscriptenTimerId;
+    qDebug() << "[AsyncSerialiser] Started emscripten watchdog timer id:" << task.emscriptenTimerId;
 }
 
-void AsyncSerialiser::stopEmscriptenWatchdog()
+void AsyncSerialiser::stopEmscriptenWatchdog(RunningTask& task)
 {
-    if (m_emscriptenTimerId != 0) {
-        emscripten_clear_timeout(m_emscriptenTimerId);
-        m_emscriptenTimerId = 0;
+    if (task.emscriptenTimerId != 0) {
+        emscripten_clear_timeout(task.emscriptenTimerId);
+        task.emscriptenTimerId = 0;
     }
 }
 
 void AsyncSerialiser::emscriptenWatchdogCallback(void* userData)
 {
-    auto* self = static_cast<AsyncSerialiser*>(userData);
-    self->m_emscriptenTimerId = 0; // Timer has fired, clear the ID
+    AsyncSerialiser& self = instance();
+    const quint64 id = static_cast<quint64>(reinterpret_cast<uintptr_t>(userData));
+    const int index = self.runningIndex(id);
+    if (index < 0) {
+        return;
+    }
+    self.m_running[index].emscriptenTimerId = 0; // Timer has fired, clear the ID
     // Invoke through Qt event loop for thread safety
-    QMetaObject::invokeMethod(self, &AsyncSerialiser::onWatchdogTimeout, Qt::QueuedConnection);
+    QMetaObject::invokeMethod(&self, [&self, id]() { self.onWatchdogTimeout(id); },
+                              Qt::QueuedConnection);
 }
 #endif
 
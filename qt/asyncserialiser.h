@@ -4,6 +4,8 @@
  *
  * The AsyncSerialiser ensures that only one async task executes at a time,
  * preventing concurrent Asyncify suspensions that could crash the WASM runtime.
+ * JSPI builds running on a JSPI-capable browser may run independent tasks
+ * concurrently instead.
  */
 #pragma once
 
@@ -13,7 +15,9 @@
 #include <QtCore/QFutureWatcher>
 #include <QTimer>
 #include <QVariant>
+#include <QVariantMap>
 #include <functional>
+#include "taskmetrics.h"
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -23,9 +27,29 @@
  * @class AsyncSerialiser
  * @brief Singleton class that serializes async task execution
  *
- * This class provides a FIFO queue for async operations. Only one task
- * runs at a time (guarded by m_isBusy), ensuring no concurrent Asyncify
- * suspensions occur in the WebAssembly environment.
+ * This class provides prioritised FIFO queues for async operations. Only
+ * one task runs at a time in Asyncify builds, ensuring no concurrent
+ * Asyncify suspensions occur in the WebAssembly environment. Each priority
+ * lane is FIFO; the highest-priority non-empty lane runs next, and a lane
+ * passed over STARVATION_LIMIT times is served ahead of higher lanes.
+ *
+ * Concurrent mode: when built with ENABLE_JSPI_BUILD and jspiAvailable()
+ * is true at startup, up to maxConcurrentTasks independent tasks run at
+ * once. Tasks are independent unless they share a name or a coalescing key;
+ * dependent tasks still run in FIFO order. Every running task has its own
+ * watchdog. In Asyncify builds the limit is always 1.
+ *
+ * Worker tasks: enqueueWorker() tasks hand their CPU work to
+ * runOnWorker(), which uses a thread pool on desktop builds with
+ * QtConcurrent. Consecutive worker tasks run in parallel, up to the pool
+ * size, while main-thread tasks (clipboard, history, UI) wait for them and
+ * stay serialized. Results are delivered on the main thread in the order
+ * the tasks started, so completion order matches enqueue order. Worker
+ * tasks have no watchdog, so every one of them delivers.
+ *
+ * Metrics: every task's queue wait and run time are recorded per task
+ * name, with rejection, timeout and supersede counts; see metrics() and
+ * chromeTrace().
  *
  * Usage example:
  * @code
@@ -43,8 +67,29 @@ class AsyncSerialiser : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(int queueLength READ queueLength NOTIFY queueLengthChanged)
+    Q_PROPERTY(int interactiveQueueLength READ interactiveQueueLength NOTIFY queueLengthChanged)
+    Q_PROPERTY(int normalQueueLength READ normalQueueLength NOTIFY queueLengthChanged)
+    Q_PROPERTY(int backgroundQueueLength READ backgroundQueueLength NOTIFY queueLengthChanged)
+    Q_PROPERTY(int runningTaskCount READ runningTaskCount NOTIFY queueLengthChanged)
+    Q_PROPERTY(bool concurrentMode READ isConcurrentMode CONSTANT)
+    Q_PROPERTY(int maxConcurrentTasks READ maxConcurrentTasks WRITE setMaxConcurrentTasks NOTIFY maxConcurrentTasksChanged)
+    Q_PROPERTY(QVariantMap metrics READ metrics NOTIFY metricsChanged)
 
 public:
+    /**
+     * @brief Scheduling class of a task
+     *
+     * Interactive: direct user actions that should feel instant (clipboard, opening an entry)
+     * Normal: document processing (format, minify, validate)
+     * Background: bookkeeping the user does not wait on (history save/scan)
+     */
+    enum class Priority {
+        Interactive = 0,
+        Normal,
+        Background
+    };
+    Q_ENUM(Priority)
+
     /**
      * @brief Type alias for async tasks
      *
@@ -53,6 +98,16 @@ public:
      */
     using AsyncTask = std::function<QFuture<QVariant>()>;
 
+    /**
+     * @brief CPU work for runOnWorker(); must not touch main-thread objects
+     */
+    using WorkerJob = std::function<QVariant()>;
+
+    /**
+     * @brief Main-thread continuation receiving a worker task's result
+     */
+    using Delivery = std::function<void(const QVariant& result)>;
+
     /**
      * @brief Get the singleton instance
      * @return Reference to the single AsyncSerialiser instance
@@ -70,6 +125,59 @@ public:
      */
     void enqueue(const QString& taskName, AsyncTask task);
 
+    /**
+     * @brief Enqueue an async task in a priority lane
+     * @param taskName Identifier for logging and signals
+     * @param priority Lane the task waits in
+     * @param task Lambda or function returning QFuture<QVariant>
+     */
+    void enqueue(const QString& taskName, Priority priority, AsyncTask task);
+
+    /**
+     * @brief Enqueue a task that coalesces with others sharing its key
+     * @param taskName Identifier for logging and signals
+     * @param coalesceKey Tasks with the same key supersede each other
+     * @param task Lambda or function returning QFuture<QVariant>
+     *
+     * A pending task with the same key is replaced in place (keeping its
+     * queue position) instead of appending a new one. If the running task
+     * has the same key it is marked superseded; it can poll
+     * isCurrentTaskSuperseded() to skip work whose result is stale.
+     * An empty key behaves like enqueue(taskName, priority, task). A
+     * replacement with a different priority moves to the back of its lane.
+     */
+    void enqueue(const QString& taskName, const QString& coalesceKey, AsyncTask task,
+                 Priority priority = Priority::Normal);
+
+    /**
+     * @brief Enqueue a task whose work runs off the main thread
+     * @param taskName Identifier for logging and signals
+     * @param coalesceKey Same meaning as for enqueue(); may be empty
+     * @param task Runs on the main thread when started, typically reading
+     *        caches, and returns the future of runOnWorker()
+     * @param deliver Called on the main thread with the future's result,
+     *        after every earlier-started worker task has delivered
+     *
+     * isCurrentTaskSuperseded() refers to this task while deliver runs.
+     * A task that times out, throws or is cancelled is not delivered.
+     */
+    void enqueueWorker(const QString& taskName, const QString& coalesceKey, AsyncTask task,
+                       Delivery deliver, Priority priority = Priority::Normal);
+    void enqueueWorker(const QString& taskName, AsyncTask task, Delivery deliver);
+
+    /**
+     * @brief Run job on the worker thread pool
+     *
+     * Without thread support (WebAssembly, or no QtConcurrent) the job
+     * runs immediately on the calling thread and the future is finished.
+     */
+    static QFuture<QVariant> runOnWorker(WorkerJob job);
+
+    /**
+     * @brief Number of worker tasks that may run at once
+     */
+    static int workerConcurrency();
+
     /**
      * @brief Clear all pending tasks (emergency reset)
      *
@@ -82,7 +190,100 @@ public:
      * @brief Get the number of pending tasks in the queue
      * @return Number of tasks waiting to execute (excludes current task)
      */
-    int queueLength() const { return m_queue.size(); }
+    int queueLength() const;
+
+    /**
+     * @brief Get the number of pending tasks in one priority lane
+     */
+    int queueLength(Priority priority) const { return m_lanes[laneIndex(priority)].size(); }
+    int interactiveQueueLength() const { return queueLength(Priority::Interactive); }
+    int normalQueueLength() const { return queueLength(Priority::Normal); }
+    int backgroundQueueLength() const { return queueLength(Priority::Background); }
+
+    /**
+     * @brief Get the number of tasks currently executing
+     */
+    int runningTaskCount() const { return m_running.size(); }
+
+    /**
+     * @brief Whether independent tasks may run concurrently (JSPI mode)
+     */
+    bool isConcurrentMode() const { return m_concurrentMode; }
+
+    /**
+     * @brief Concurrency limit used in concurrent mode
+     *
+     * Ignored (treated as 1) when concurrent mode is unavailable.
+     */
+    int maxConcurrentTasks() const { return m_maxConcurrentTasks; }
+    void setMaxConcurrentTasks(int limit);
+
+    /**
+     * @brief Watchdog timeout for main-thread tasks, in milliseconds
+     *
+     * Worker tasks are not watched: a job on the pool cannot be stopped, so
+     * they always run to completion and deliver. Applies to tasks started
+     * after the change.
+     */
+    int watchdogTimeout() const { return m_watchdogTimeoutMs; }
+    void setWatchdogTimeout(int ms);
+
+    /**
+     * @brief Number of tasks that may currently run at once
+     */
+    int effectiveConcurrency() const { return m_concurrentMode ? m_maxConcurrentTasks : 1; }
+
+    /**
+     * @brief Check whether a newer task with the same key was enqueued
+     *        while the current task is running
+     * @return True if the running task's result is stale
+     *
+     * The current task is the most recently started one that is still
+     * running; in concurrent mode call this from within the task itself.
+     */
+    bool isCurrentTaskSuperseded() const;
+
+    /**
+     * @brief Record the size of the current task's input
+     * @param bytes Payload size, summed per task name in metrics()
+     *
+     * Call from within the task or its delivery, like
+     * isCurrentTaskSuperseded().
+     */
+    void setCurrentTaskPayload(qint64 bytes);
+
+    /**
+     * @brief Snapshot of the task metrics
+     * @return Map with "watchdogMs", "peakQueueLength" and "tasks"
+     *
+     * "tasks" maps each task name to its counts (count, succeeded, failed,
+     * rejected, timedOut, superseded, nearTimeout), its total payloadBytes,
+     * and "waitMs" (enqueue to start) and "runMs" (start to finish)
+     * percentiles: min, mean, p50, p90, p99, p999 and max. nearTimeout
+     * counts runs that took at least half of the watchdog timeout.
+     */
+    QVariantMap metrics() const { return m_metrics.snapshot(); }
+
+    /**
+     * @brief Recent tasks in Chrome trace-event JSON format
+     *
+     * Load the result in chrome://tracing or ui.perfetto.dev. On
+     * WebAssembly the same tasks also appear as performance.measure()
+     * entries in the browser profiler. AIRGAP_TRACING builds add the
+     * trace zones recorded meanwhile (see airgaptrace.h).
+     */
+    QByteArray chromeTrace() const;
+
+    /**
+     * @brief Write chromeTrace() to a file
+     * @return True if the whole trace was written
+     */
+    Q_INVOKABLE bool exportChromeTrace(const QString& path) const;
+
+    /**
+     * @brief Discard all recorded metrics and trace events
+     */
+    Q_INVOKABLE void resetMetrics();
 
     /**
      * @brief Check if JSPI (JavaScript Promise Integration) is available
@@ -90,8 +291,8 @@ public:
      *
      * JSPI allows WebAssembly to suspend and resume with multiple concurrent
      * suspensions, eliminating Asyncify's single-flight limitation.
-     * When JSPI is available, the AsyncSerialiser queue could potentially
-     * be bypassed for direct task execution.
+     * In ENABLE_JSPI_BUILD builds, a true result at startup enables
+     * concurrent mode.
      *
      * This queries window.JSPI_AVAILABLE set by jspi-detect.js
      */
@@ -134,36 +335,94 @@ signals:
      */
     void taskRejected(const QString& taskName);
 
+    /**
+     * @brief Emitted when a task is replaced by (pending) or marked stale
+     *        in favour of (running) a newer task with the same coalescing key
+     * @param taskName The name of the superseded task
+     */
+    void taskSuperseded(const QString& taskName);
+
+    /**
+     * @brief Emitted when the concurrency limit changes
+     */
+    void maxConcurrentTasksChanged();
+
+    /**
+     * @brief Emitted when a task finishes, is rejected or is superseded
+     */
+    void metricsChanged();
+
 private:
     AsyncSerialiser();
     ~AsyncSerialiser();
     AsyncSerialiser(const AsyncSerialiser&) = delete;
     AsyncSerialiser& operator=(const AsyncSerialiser&) = delete;
 
-    void processNext();
-    void onWatchdogTimeout();
-    void onTaskFinished();
-
     struct QueuedTask {
         QString name;
+        QString coalesceKey;
         AsyncTask task;
+        Delivery deliver;           // Set for worker tasks
+        int lane = 0;
+        qint64 enqueuedNs = 0;
+    };
+
+    struct RunningTask {
+        quint64 id = 0;
+        QString name;
+        QString coalesceKey;
+        bool superseded = false;
+        bool worker = false;
+        bool finished = false;      // Worker result waiting for earlier tasks
+        bool succeeded = false;
+        QVariant result;
+        Delivery deliver;
+        TaskMetrics::Task timing;
+        QTimer* watchdog = nullptr;
+        QFutureWatcher<QVariant>* watcher = nullptr;
+#ifdef __EMSCRIPTEN__
+        long emscriptenTimerId = 0;  // Fallback timer for WASM reliability
+#endif
     };
 
-    QQueue<QueuedTask> m_queue;
-    bool m_isBusy = false;
-    QString m_currentTaskName;
-    QTimer m_watchdog;
-    QFutureWatcher<QVariant>* m_watcher = nullptr;
+    void enqueueTask(QueuedTask queued, Priority priority);
+    void processNext();
+    bool takeNextTask(QueuedTask& next);
+    int firstReadyIndex(int lane) const;
+    bool canStart(const QueuedTask& task) const;
+    bool conflictsWithRunning(const QueuedTask& task) const;
+    void startTask(QueuedTask queued);
+    int runningIndex(quint64 id) const;
+    void releaseTask(int index, bool cancel);
+    static int laneIndex(Priority priority) { return static_cast<int>(priority); }
+    static bool concurrentModeSupported();
+    void onWatchdogTimeout(quint64 id);
+    void onTaskFinished(quint64 id);
+    void deliverFinishedWorkers();
+    void recordFinished(int index, bool success, bool timedOut);
+    int freeTrack() const;
+
+    static constexpr int LANE_COUNT = 3;
+
+    QQueue<QueuedTask> m_lanes[LANE_COUNT];
+    int m_skipCounts[LANE_COUNT] = {};  // Dispatches that passed over each non-empty lane
+    QList<RunningTask> m_running;
+    quint64 m_nextTaskId = 0;
+    quint64 m_currentTaskId = 0;
+    bool m_concurrentMode = false;
+    int m_maxConcurrentTasks = DEFAULT_MAX_CONCURRENT_TASKS;
+    int m_watchdogTimeoutMs = WATCHDOG_TIMEOUT_MS;
+    TaskMetrics m_metrics {WATCHDOG_TIMEOUT_MS};
 
 #ifdef __EMSCRIPTEN__
-    // Emscripten fallback timer handle for WASM reliability
-    long m_emscriptenTimerId = 0;
-    void startEmscriptenWatchdog();
-    void stopEmscriptenWatchdog();
+    void startEmscriptenWatchdog(RunningTask& task);
+    void stopEmscriptenWatchdog(RunningTask& task);
     static void emscriptenWatchdogCallback(void* userData);
 #endif
 
     static constexpr int WATCHDOG_TIMEOUT_MS = 30000;
+    static constexpr int DEFAULT_MAX_CONCURRENT_TASKS = 4;
     static constexpr int QUEUE_LENGTH_WARNING_THRESHOLD = 10;
     static constexpr int MAX_QUEUE_SIZE = 100;
+    static constexpr int STARVATION_LIMIT = 4;
 };
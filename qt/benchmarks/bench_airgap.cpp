@@ -0,0 +1,462 @@
+/**
+ * @file bench_airgap.cpp
+ * @brief Benchmarks for the native hot paths of the Qt layer
+ *
+ * Every benchmark runs against generated corpora of increasing size:
+ * - wide: a flat array of small records
+ * - deep: records nested 100 containers deep
+ * - strings: long strings with escapes and multi-byte characters
+ *
+ * Results are written as JSON, one entry per benchmark and corpus, with
+ * the mean and fastest time per iteration. Passing an earlier result file
+ * as --baseline reports entries that got slower than --tolerance allows
+ * and exits with status 1, so a run can gate a change.
+ *
+ * @code
+ * bench_airgap --max-size 16M --output after.json --baseline before.json
+ * @endcode
+ */
+#include "asyncserialiser.h"
+#include "historystore.h"
+#include "jsonhighlighter.h"
+#include "jsonindexer.h"
+#include "jsonparallelformatter.h"
+#include "jsonwriter.h"
+#include "qjsontreemodel.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPromise>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <functional>
+#include <limits>
+#include <memory>
+
+namespace {
+
+constexpr int ResultVersion = 1;
+// Iterations measured even when one takes longer than the minimum time
+constexpr int MinIterations = 3;
+// Tasks per iteration of the dispatch benchmarks; the queue holds at
+// most 100
+constexpr int DispatchBatch = 64;
+constexpr int DeepNesting = 100;
+
+const qsizetype CorpusSizes[] = {
+    1024,
+    64 * 1024,
+    1024 * 1024,
+    16 * 1024 * 1024,
+    128 * 1024 * 1024,
+    500 * 1024 * 1024,
+};
+
+struct Corpus {
+    QString name;
+    QByteArray utf8;
+    QString text;
+};
+
+// One timed iteration; state lives in the closure
+using Run = std::function<void()>;
+
+struct Benchmark {
+    QString name;
+    // Null Run when the benchmark does not apply to the corpus
+    std::function<Run(const Corpus&)> prepare;
+    // Dispatch benchmarks run once, without a corpus
+    bool usesCorpus = true;
+    // Operations per iteration, for per-operation timings
+    int operations = 1;
+};
+
+// Closes a top-level array once the generated elements reach size
+QByteArray closeArray(QByteArray json)
+{
+    if (json.endsWith(','))
+        json.chop(1);
+    json.append(']');
+    return json;
+}
+
+QByteArray wideCorpus(qsizetype size)
+{
+    QByteArray json = "[";
+    json.reserve(size + 256);
+    for (int i = 0; json.size() < size; ++i) {
+        json += "{\"id\":" + QByteArray::number(i) + ",\"name\":\"item " + QByteArray::number(i)
+                + "\",\"score\":" + QByteArray::number(i * 0.5) + ",\"ok\":true,\"tags\":[\"a\",\"b\"],"
+                  "\"parent\":null},";
+    }
+    return closeArray(json);
+}
+
+QByteArray deepCorpus(qsizetype size)
+{
+    QByteArray nested;
+    for (int depth = 0; depth < DeepNesting / 2; ++depth)
+        nested += "{\"k\":[";
+    nested += "1";
+    for (int depth = 0; depth < DeepNesting / 2; ++depth)
+        nested += "]}";
+
+    QByteArray json = "[";
+    json.reserve(size + nested.size() + 1);
+    while (json.size() < size)
+        json += nested + ',';
+    return closeArray(json);
+}
+
+QByteArray stringsCorpus(qsizetype size)
+{
+    const QByteArray piece = "lorem \\\"ipsum\\\" dolor \\\\ sit \xc3\xa9 amet \\u00e9\\n ";
+    QByteArray string = "\"";
+    while (string.size() < qBound<qsizetype>(piece.size(), size / 4, 64 * 1024))
+        string += piece;
+    string += "\",";
+
+    QByteArray json = "[";
+    json.reserve(size + string.size());
+    while (json.size() < size)
+        json += string;
+    return closeArray(json);
+}
+
+QString sizeLabel(qsizetype bytes)
+{
+    if (bytes >= 1024 * 1024)
+        return QString::number(bytes / (1024 * 1024)) + "M";
+    return QString::number(bytes / 1024) + "K";
+}
+
+// "64K", "16M" or "1G" in bytes; -1 if malformed
+qsizetype parseSize(QString text)
+{
+    qsizetype unit = 1;
+    if (text.endsWith('K', Qt::CaseInsensitive))
+        unit = 1024;
+    else if (text.endsWith('M', Qt::CaseInsensitive))
+        unit = 1024 * 1024;
+    else if (text.endsWith('G', Qt::CaseInsensitive))
+        unit = 1024 * 1024 * 1024;
+    if (unit > 1)
+        text.chop(1);
+
+    bool ok = false;
+    const qsizetype value = text.toLongLong(&ok);
+    return ok && value >= 0 ? value * unit : -1;
+}
+
+// Enqueues DispatchBatch tasks and runs the event loop until all of them
+// completed; tasks may complete while they are enqueued
+void runBatch(const std::function<void(AsyncSerialiser&)>& enqueue)
+{
+    AsyncSerialiser& serialiser = AsyncSerialiser::instance();
+    QEventLoop loop;
+    int completed = 0;
+    const auto connection = QObject::connect(&serialiser, &AsyncSerialiser::taskCompleted, &loop,
+                                             [&loop, &completed]() {
+        if (++completed == DispatchBatch)
+            loop.quit();
+    });
+    for (int i = 0; i < DispatchBatch; ++i)
+        enqueue(serialiser);
+    if (completed < DispatchBatch)
+        loop.exec();
+    QObject::disconnect(connection);
+}
+
+QFuture<QVariant> finishedFuture()
+{
+    QPromise<QVariant> promise;
+    auto future = promise.future();
+    promise.start();
+    promise.addResult(QVariant());
+    promise.finish();
+    return future;
+}
+
+QList<Benchmark> benchmarks()
+{
+    const JsonWriter::Indent indent = JsonWriter::Indent::fromString("spaces:4");
+
+    return {
+        {"parse.document", [](const Corpus& corpus) -> Run {
+            return [&corpus]() { QJsonDocument::fromJson(corpus.utf8); };
+        }},
+        {"format.writer", [indent](const Corpus& corpus) -> Run {
+            // The desktop formatJson path on a cache miss
+            return [&corpus, indent]() {
+                JsonWriter::toJson(QJsonDocument::fromJson(corpus.utf8), indent, corpus.utf8.size() * 2);
+            };
+        }},
+        {"format.parallel", [indent](const Corpus& corpus) -> Run {
+            if (corpus.utf8.size() < JsonParallelFormatter::MinParallelSize)
+                return nullptr;
+            return [&corpus, indent]() { JsonParallelFormatter::format(corpus.utf8, indent); };
+        }},
+        {"validate.indexer", [](const Corpus& corpus) -> Run {
+            return [&corpus]() { JsonIndexer::validate(corpus.utf8); };
+        }},
+        {"validate.incremental", [](const Corpus& corpus) -> Run {
+            // Alternates between the corpus and a copy with one space
+            // inserted after the top-level separator nearest the middle
+            QList<qsizetype> separators;
+            if (!JsonIndexer::validate(corpus.utf8, false, &separators).valid || separators.isEmpty())
+                return nullptr;
+            const qsizetype middle = separators.at(separators.size() / 2) + 1;
+            auto inputs = std::make_shared<QList<QByteArray>>(
+                QList<QByteArray>{corpus.utf8, QByteArray(corpus.utf8).insert(middle, ' ')});
+            auto indexer = std::make_shared<JsonIncrementalIndexer>();
+            indexer->validate(inputs->at(0));
+            auto next = std::make_shared<int>(1);
+            return [inputs, indexer, next]() {
+                indexer->validate(inputs->at(*next));
+                *next ^= 1;
+            };
+        }},
+        {"highlight.document", [](const Corpus& corpus) -> Run {
+            return [&corpus]() { JsonHighlighter::highlightDocument(corpus.text); };
+        }},
+        {"tree.loadJson", [](const Corpus& corpus) -> Run {
+            auto model = std::make_shared<QJsonTreeModel>();
+            return [&corpus, model]() { model->loadJson(corpus.text); };
+        }},
+        {"tree.serializeNode", [](const Corpus& corpus) -> Run {
+            // Copying the whole document from the tree view
+            auto model = std::make_shared<QJsonTreeModel>();
+            if (!model->loadJson(corpus.text))
+                return nullptr;
+            return [model]() { model->serializeNode(model->index(0, 0), "spaces:4"); };
+        }},
+        {"tree.search", [](const Corpus& corpus) -> Run {
+            // One page of value matches, as the search field shows them
+            auto model = std::make_shared<QJsonTreeModel>();
+            if (!model->loadJson(corpus.text))
+                return nullptr;
+            return [model]() { model->search("item 1", QJsonTreeModel::SearchValues); };
+        }},
+        {"history.save", [](const Corpus& corpus) -> Run {
+            // Distinct content each time, so every save writes a blob
+            auto dir = std::make_shared<QTemporaryDir>();
+            auto store = std::make_shared<HistoryStore>(dir->path());
+            auto counter = std::make_shared<int>(0);
+            return [&corpus, dir, store, counter]() {
+                store->add(corpus.text + '\n' + QString::number((*counter)++));
+            };
+        }},
+        {"history.load", [](const Corpus& corpus) -> Run {
+            // Startup replay of the index, then opening the entry
+            auto dir = std::make_shared<QTemporaryDir>();
+            const QString id = HistoryStore(dir->path()).add(corpus.text);
+            if (id.isEmpty())
+                return nullptr;
+            return [dir, id]() {
+                HistoryStore store(dir->path());
+                store.content(id);
+            };
+        }},
+        {"serialiser.enqueue", [](const Corpus&) -> Run {
+            return []() {
+                runBatch([](AsyncSerialiser& serialiser) { serialiser.enqueue("bench", finishedFuture); });
+            };
+        }, false, DispatchBatch},
+        {"serialiser.enqueueWorker", [](const Corpus&) -> Run {
+            return []() {
+                runBatch([](AsyncSerialiser& serialiser) {
+                    serialiser.enqueueWorker("bench", []() {
+                        return AsyncSerialiser::runOnWorker([]() { return QVariant(); });
+                    }, [](const QVariant&) {});
+                });
+            };
+        }, false, DispatchBatch},
+    };
+}
+
+// Times run until minTimeNs has elapsed, after one untimed warm-up
+QJsonObject measure(const Run& run, qint64 minTimeNs, int operations)
+{
+    run();
+
+    QElapsedTimer timer;
+    qint64 total = 0;
+    qint64 fastest = std::numeric_limits<qint64>::max();
+    int iterations = 0;
+    while (iterations < MinIterations || total < minTimeNs) {
+        timer.start();
+        run();
+        const qint64 elapsed = timer.nsecsElapsed();
+        total += elapsed;
+        fastest = qMin(fastest, elapsed);
+        ++iterations;
+    }
+
+    QJsonObject result;
+    result["iterations"] = iterations;
+    result["operations"] = operations;
+    result["nsPerIteration"] = double(total) / iterations;
+    result["nsPerOperation"] = double(total) / iterations / operations;
+    result["fastestNs"] = double(fastest);
+    return result;
+}
+
+QString resultKey(const QJsonObject& result)
+{
+    return result["benchmark"].toString() + '/' + result["corpus"].toString();
+}
+
+// Entries slower than the baseline by more than tolerance, as messages
+QStringList regressions(const QJsonArray& results, const QJsonArray& baseline, double tolerance)
+{
+    QHash<QString, double> before;
+    for (const QJsonValue& value : baseline)
+        before.insert(resultKey(value.toObject()), value.toObject()["nsPerIteration"].toDouble());
+
+    QStringList messages;
+    for (const QJsonValue& value : results) {
+        const QJsonObject result = value.toObject();
+        const double then = before.value(resultKey(result));
+        const double now = result["nsPerIteration"].toDouble();
+        if (then > 0 && now > then * (1 + tolerance)) {
+            messages.append(QString("%1: %2 ms -> %3 ms (+%4%)")
+                                .arg(resultKey(result))
+                                .arg(then / 1e6, 0, 'f', 3)
+                                .arg(now / 1e6, 0, 'f', 3)
+                                .arg((now / then - 1) * 100, 0, 'f', 1));
+        }
+    }
+    return messages;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bench_airgap");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks the native JSON paths of Airgap JSON Formatter.");
+    parser.addHelpOption();
+    const QCommandLineOption outputOption({"o", "output"}, "Write JSON results to <file> instead of stdout.", "file");
+    const QCommandLineOption maxSizeOption("max-size", "Largest corpus to generate, e.g. 64K, 16M or 1G.",
+                                           "size", "16M");
+    const QCommandLineOption filterOption("filter", "Only run benchmarks whose name contains <text>.", "text");
+    const QCommandLineOption minTimeOption("min-time", "Minimum measured time per entry in milliseconds.",
+                                           "ms", "200");
+    const QCommandLineOption baselineOption("baseline", "Compare against earlier results in <file>.", "file");
+    const QCommandLineOption toleranceOption("tolerance", "Slowdown over the baseline reported, in percent.",
+                                             "percent", "10");
+    const QCommandLineOption traceOption("trace", "Write the serialiser's Chrome trace, with trace zones in "
+                                         "AIRGAP_TRACING builds, to <file>.", "file");
+    parser.addOptions({outputOption, maxSizeOption, filterOption, minTimeOption, baselineOption, toleranceOption,
+                       traceOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const qsizetype maxSize = parseSize(parser.value(maxSizeOption));
+    if (maxSize < 0) {
+        err << "Invalid --max-size: " << parser.value(maxSizeOption) << Qt::endl;
+        return 2;
+    }
+    const qint64 minTimeNs = parser.value(minTimeOption).toLongLong() * 1000 * 1000;
+
+    QJsonArray baseline;
+    if (parser.isSet(baselineOption)) {
+        QFile file(parser.value(baselineOption));
+        if (!file.open(QIODevice::ReadOnly)) {
+            err << "Cannot read baseline " << file.fileName() << Qt::endl;
+            return 2;
+        }
+        baseline = QJsonDocument::fromJson(file.readAll()).object()["results"].toArray();
+    }
+
+    const QList<Benchmark> all = benchmarks();
+    QList<const Benchmark*> selected;
+    for (const Benchmark& benchmark : all) {
+        if (benchmark.name.contains(parser.value(filterOption)))
+            selected.append(&benchmark);
+    }
+
+    // Corpora are generated on demand; "none" is the dispatch benchmarks'
+    const std::function<QByteArray(qsizetype)> generators[] = {wideCorpus, deepCorpus, stringsCorpus};
+    const QString generatorNames[] = {"wide", "deep", "strings"};
+    QList<std::pair<QString, std::function<QByteArray()>>> corpora{{"none", []() { return QByteArray(); }}};
+    for (const qsizetype size : CorpusSizes) {
+        if (size > maxSize)
+            break;
+        for (int i = 0; i < 3; ++i) {
+            const auto generate = generators[i];
+            corpora.append({generatorNames[i] + '-' + sizeLabel(size), [generate, size]() { return generate(size); }});
+        }
+    }
+
+    QJsonArray results;
+    for (const auto& [name, generate] : corpora) {
+        // One corpus in memory at a time
+        Corpus corpus;
+        corpus.name = name;
+        corpus.utf8 = generate();
+        corpus.text = QString::fromUtf8(corpus.utf8);
+
+        for (const Benchmark* benchmark : selected) {
+            if (benchmark->usesCorpus == corpus.utf8.isEmpty())
+                continue;
+            const Run run = benchmark->prepare(corpus);
+            if (!run)
+                continue;
+
+            QJsonObject result = measure(run, minTimeNs, benchmark->operations);
+            result["benchmark"] = benchmark->name;
+            result["corpus"] = corpus.name;
+            result["bytes"] = double(corpus.utf8.size());
+            if (!corpus.utf8.isEmpty())
+                result["mbPerSecond"] = corpus.utf8.size() / (result["nsPerIteration"].toDouble() / 1e9) / 1e6;
+            results.append(result);
+
+            err << qSetFieldWidth(28) << Qt::left << benchmark->name << qSetFieldWidth(14) << corpus.name
+                << qSetFieldWidth(0) << QString::number(result["nsPerIteration"].toDouble() / 1e6, 'f', 3)
+                << " ms" << Qt::endl;
+        }
+    }
+
+    QJsonObject report;
+    report["version"] = ResultVersion;
+    report["qtVersion"] = QString(qVersion());
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["minTimeMs"] = double(minTimeNs / (1000 * 1000));
+    report["results"] = results;
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+            err << "Cannot write " << file.fileName() << Qt::endl;
+            return 2;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    if (parser.isSet(traceOption) && !AsyncSerialiser::instance().exportChromeTrace(parser.value(traceOption))) {
+        err << "Cannot write " << parser.value(traceOption) << Qt::endl;
+        return 2;
+    }
+
+    if (parser.isSet(baselineOption)) {
+        const QStringList slower = regressions(results, baseline, parser.value(toleranceOption).toDouble() / 100);
+        for (const QString& message : slower)
+            err << "Regression: " << message << Qt::endl;
+        if (!slower.isEmpty())
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include "documentcache.h"
+
+// Entries carry a fixed overhead on top of their values
+static constexpr qsizetype EntryOverhead = 256;
+
+DocumentCache::DocumentCache(qsizetype budget)
+    : m_entries(budget)
+{
+}
+
+DocumentCache::Key DocumentCache::keyFor(QByteArrayView utf8)
+{
+    Key key;
+    key.length = utf8.size();
+    // qHash is 32 bits on wasm32; two seeds keep the key 64 bits wide
+    if constexpr (sizeof(size_t) >= sizeof(quint64)) {
+        key.hash = qHash(utf8, 0);
+    } else {
+        key.hash = (quint64(qHash(utf8, 0)) << 32) | quint64(qHash(utf8, 0x9e3779b9u));
+    }
+    return key;
+}
+
+DocumentCache::Key DocumentCache::derivedKey(const Key& source, const QString& name)
+{
+    Key key;
+    key.length = source.length;
+    if constexpr (sizeof(size_t) >= sizeof(quint64)) {
+        key.hash = qHashMulti(0, source.hash, name);
+    } else {
+        key.hash = (quint64(qHashMulti(0, source.hash, name)) << 32)
+                   | quint64(qHashMulti(0x9e3779b9u, source.hash, name));
+    }
+    return key;
+}
+
+QVariant DocumentCache::value(const Key& key, const QString& name)
+{
+    const QMutexLocker locker(&m_mutex);
+    Entry* entry = m_entries.object(key);
+    if (entry) {
+        auto it = entry->values.constFind(name);
+        if (it != entry->values.constEnd()) {
+            ++m_hits;
+            return it.value();
+        }
+    }
+    ++m_misses;
+    return QVariant();
+}
+
+void DocumentCache::insert(const Key& key, const QString& name, const QVariant& value, qsizetype cost)
+{
+    const QMutexLocker locker(&m_mutex);
+    // A value that alone exceeds the budget would evict the whole entry
+    if (cost + EntryOverhead > m_entries.maxCost())
+        return;
+
+    // QCache charges an entry once, on insert; take it out and put it
+    // back so the new total applies
+    Entry* entry = m_entries.take(key);
+    if (!entry) {
+        entry = new Entry;
+        entry->cost = EntryOverhead;
+    }
+
+    entry->cost += cost - entry->costs.value(name, 0);
+    entry->values.insert(name, value);
+    entry->costs.insert(name, cost);
+
+    // Entries over budget are deleted by QCache rather than inserted
+    m_entries.insert(key, entry, entry->cost);
+}
+
+qsizetype DocumentCache::budget() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_entries.maxCost();
+}
+
+void DocumentCache::setBudget(qsizetype budget)
+{
+    const QMutexLocker locker(&m_mutex);
+    m_entries.setMaxCost(budget);
+}
+
+qsizetype DocumentCache::totalCost() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_entries.totalCost();
+}
+
+qsizetype DocumentCache::count() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
+
+quint64 DocumentCache::hits() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_hits;
+}
+
+quint64 DocumentCache::misses() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
+
+void DocumentCache::clear()
+{
+    const QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
+
+void DocumentCache::resetCounters()
+{
+    const QMutexLocker locker(&m_mutex);
+    m_hits = 0;
+    m_misses = 0;
+}
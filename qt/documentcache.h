@@ -0,0 +1,89 @@
+#ifndef DOCUMENTCACHE_H
+#define DOCUMENTCACHE_H
+
+#include <QByteArrayView>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVariant>
+
+// LRU cache of parsed documents and their derived outputs.
+//
+// Entries are keyed by a fast 64-bit hash of the input's UTF-8 bytes plus
+// its length, so toggling the indent type, switching between format and
+// minify, or rebuilding the tree for unchanged input skips the parse. Each
+// entry holds named values (the parsed QJsonDocument, formatted text per
+// indent type, minified text, validation results) and is charged their
+// estimated size in bytes. The least recently used entries are evicted
+// once the total exceeds the budget; a value larger than the whole budget
+// is not cached. Thread-safe: worker jobs look up values themselves
+// while the main thread inserts.
+class DocumentCache
+{
+public:
+    struct Key {
+        quint64 hash = 0;
+        qsizetype length = 0;
+
+        bool operator==(const Key& other) const
+        {
+            return hash == other.hash && length == other.length;
+        }
+    };
+
+    static constexpr qsizetype DefaultBudget = 32 * 1024 * 1024;
+
+    // Value names shared by the bridge operations
+    static inline const QString Document = QStringLiteral("document");
+    static inline const QString Minified = QStringLiteral("minified");
+    static inline const QString Validation = QStringLiteral("validation");
+    static QString formattedName(const QString& indentType)
+    {
+        return QStringLiteral("formatted:") + indentType;
+    }
+
+    explicit DocumentCache(qsizetype budget = DefaultBudget);
+
+    static Key keyFor(QByteArrayView utf8);
+    // Key for the output named name derived from the input keyed source,
+    // so an output is keyed without hashing its text
+    static Key derivedKey(const Key& source, const QString& name);
+
+    // The cached value, or an invalid QVariant. Counts a hit or a miss and
+    // marks the entry as most recently used.
+    QVariant value(const Key& key, const QString& name);
+    // Adds or replaces a value; cost is its estimated size in bytes
+    void insert(const Key& key, const QString& name, const QVariant& value, qsizetype cost);
+
+    qsizetype budget() const;
+    // Shrinking the budget evicts entries immediately
+    void setBudget(qsizetype budget);
+
+    qsizetype totalCost() const;
+    qsizetype count() const;
+    quint64 hits() const;
+    quint64 misses() const;
+
+    void clear();
+    void resetCounters();
+
+private:
+    struct Entry {
+        QHash<QString, QVariant> values;
+        QHash<QString, qsizetype> costs;
+        qsizetype cost = 0;
+    };
+
+    mutable QMutex m_mutex;
+    QCache<Key, Entry> m_entries;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
+
+inline size_t qHash(const DocumentCache::Key& key, size_t seed = 0) noexcept
+{
+    return qHashMulti(seed, key.hash, key.length);
+}
+
+#endif // DOCUMENTCACHE_H
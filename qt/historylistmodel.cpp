@@ -0,0 +1,124 @@
+#include "historylistmodel.h"
+#include <QVariantMap>
+
+HistoryListModel::HistoryListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int HistoryListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_rows.size();
+}
+
+QVariant HistoryListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size())
+        return QVariant();
+
+    const Row& row = m_rows.at(index.row());
+    switch (role) {
+        case EntryIdRole:
+            return row.id;
+        case TimestampRole:
+            return row.timestamp;
+        case Qt::DisplayRole:
+        case PreviewRole:
+            return row.preview;
+        case SizeRole:
+            return row.size;
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> HistoryListModel::roleNames() const
+{
+    return {
+        {EntryIdRole, "entryId"},
+        {TimestampRole, "timestamp"},
+        {PreviewRole, "preview"},
+        {SizeRole, "size"}
+    };
+}
+
+bool HistoryListModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (parent.isValid() || m_loading)
+        return false;
+    return m_totalCount < 0 || m_rows.size() < m_totalCount;
+}
+
+void HistoryListModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent))
+        return;
+    setLoading(true);
+    emit pageRequested(m_searchQuery, m_rows.size(), PageSize);
+}
+
+void HistoryListModel::setSearchQuery(const QString& query)
+{
+    if (query == m_searchQuery)
+        return;
+    m_searchQuery = query;
+    emit searchQueryChanged();
+    reload();
+}
+
+void HistoryListModel::reload()
+{
+    clear();
+    fetchMore();
+}
+
+void HistoryListModel::clear()
+{
+    beginResetModel();
+    m_rows.clear();
+    endResetModel();
+
+    // A page still in flight no longer matches the row count and is dropped
+    setLoading(false);
+    if (m_totalCount != -1) {
+        m_totalCount = -1;
+        emit totalCountChanged();
+    }
+}
+
+void HistoryListModel::appendPage(const QString& query, int offset, const QVariantList& entries, int total)
+{
+    if (!m_loading || query != m_searchQuery || offset != m_rows.size())
+        return;
+
+    setLoading(false);
+    if (total != m_totalCount) {
+        m_totalCount = total;
+        emit totalCountChanged();
+    }
+
+    if (entries.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + entries.size() - 1);
+    for (const QVariant& value : entries) {
+        const QVariantMap entry = value.toMap();
+        Row row;
+        row.id = entry.value("id").toString();
+        row.timestamp = entry.value("timestamp").toString();
+        row.preview = entry.value("preview").toString();
+        row.size = entry.value("size").toLongLong();
+        m_rows.append(row);
+    }
+    endInsertRows();
+}
+
+void HistoryListModel::setLoading(bool loading)
+{
+    if (loading == m_loading)
+        return;
+    m_loading = loading;
+    emit loadingChanged();
+}
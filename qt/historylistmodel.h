@@ -0,0 +1,80 @@
+#ifndef HISTORYLISTMODEL_H
+#define HISTORYLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+
+// Paged list of history entry metadata for the history panel.
+//
+// Rows hold only id, timestamp, preview and size; content is requested
+// separately when an entry is opened. Rows are loaded a page at a time:
+// fetchMore() emits pageRequested() and the owner answers with
+// appendPage(), so opening the panel costs one page regardless of how
+// many or how large the stored entries are. Pages for a stale query or
+// offset are ignored.
+class HistoryListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int totalCount READ totalCount NOTIFY totalCountChanged)
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+    Q_PROPERTY(QString searchQuery READ searchQuery WRITE setSearchQuery NOTIFY searchQueryChanged)
+
+public:
+    enum Roles {
+        EntryIdRole = Qt::UserRole + 1,
+        TimestampRole,
+        PreviewRole,
+        SizeRole
+    };
+    Q_ENUM(Roles)
+
+    static constexpr int PageSize = 20;
+
+    explicit HistoryListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool canFetchMore(const QModelIndex& parent = QModelIndex()) const override;
+    void fetchMore(const QModelIndex& parent = QModelIndex()) override;
+
+    // Entries matching the search query, loaded or not; -1 until the
+    // first page arrives
+    int totalCount() const { return m_totalCount; }
+    bool isLoading() const { return m_loading; }
+    QString searchQuery() const { return m_searchQuery; }
+    void setSearchQuery(const QString& query);
+
+    // Drops the loaded rows and requests the first page again
+    Q_INVOKABLE void reload();
+    Q_INVOKABLE void clear();
+
+    // Accepts a page of {id, timestamp, preview, size} maps
+    void appendPage(const QString& query, int offset, const QVariantList& entries, int total);
+
+signals:
+    void pageRequested(const QString& query, int offset, int limit);
+    void totalCountChanged();
+    void loadingChanged();
+    void searchQueryChanged();
+
+private:
+    struct Row {
+        QString id;
+        QString timestamp;
+        QString preview;
+        qint64 size = 0;
+    };
+
+    void setLoading(bool loading);
+
+    QVector<Row> m_rows;
+    QString m_searchQuery;
+    int m_totalCount = -1;
+    bool m_loading = false;
+};
+
+#endif // HISTORYLISTMODEL_H
@@ -0,0 +1,330 @@
+#include "historystore.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QUuid>
+#include <utility>
+
+namespace {
+
+const QString kIndexFile = QStringLiteral("index.jsonl");
+const QString kBlobsDir = QStringLiteral("blobs");
+const QString kBlobSuffix = QStringLiteral(".z");
+
+QJsonObject addRecord(const HistoryStore::Entry& entry)
+{
+    QJsonObject record;
+    record["op"] = QStringLiteral("add");
+    record["id"] = entry.id;
+    record["timestamp"] = entry.timestamp;
+    record["preview"] = entry.preview;
+    record["size"] = entry.size;
+    record["hash"] = entry.hash;
+    return record;
+}
+
+QJsonObject deleteRecord(const QString& id)
+{
+    QJsonObject record;
+    record["op"] = QStringLiteral("del");
+    record["id"] = id;
+    return record;
+}
+
+QByteArray recordLine(const QJsonObject& record)
+{
+    return QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n';
+}
+
+bool writeFile(const QString& path, const QByteArray& data)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(data);
+    return file.commit();
+}
+
+QString makePreview(const QString& content)
+{
+    QString preview = content.left(HistoryStore::PreviewLength).simplified();
+    if (content.length() > HistoryStore::PreviewLength)
+        preview += "...";
+    return preview;
+}
+
+QString contentHash(const QByteArray& utf8)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(utf8, QCryptographicHash::Sha256).toHex());
+}
+
+} // namespace
+
+HistoryStore::HistoryStore(const QString& directory)
+    : m_directory(directory)
+{
+}
+
+QString HistoryStore::indexPath() const
+{
+    return m_directory + '/' + kIndexFile;
+}
+
+QString HistoryStore::blobPath(const QString& hash) const
+{
+    return m_directory + '/' + kBlobsDir + '/' + hash + kBlobSuffix;
+}
+
+bool HistoryStore::writeBlob(const QString& hash, const QByteArray& utf8)
+{
+    // Identical content is already on disk under the same name
+    if (QFile::exists(blobPath(hash)))
+        return true;
+    return writeFile(blobPath(hash), qCompress(utf8));
+}
+
+void HistoryStore::ensureLoaded() const
+{
+    if (m_loaded)
+        return;
+    m_loaded = true;
+
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    // A torn final line from an interrupted append fails to parse and is
+    // counted as dead; compaction drops it
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+        const QJsonDocument doc = QJsonDocument::fromJson(line);
+        if (!doc.isObject()) {
+            ++m_deadRecords;
+            continue;
+        }
+        replay(doc.object());
+    }
+}
+
+void HistoryStore::replay(const QJsonObject& record) const
+{
+    const QString id = record["id"].toString();
+    const QString op = record["op"].toString();
+
+    if (op == QLatin1String("add") && !id.isEmpty()) {
+        // Re-adding an id moves the entry to the top
+        if (m_entries.contains(id)) {
+            m_idsByHash.remove(m_entries.value(id).hash);
+            m_order.removeOne(id);
+            ++m_deadRecords;
+        }
+        Entry entry;
+        entry.id = id;
+        entry.timestamp = record["timestamp"].toString();
+        entry.preview = record["preview"].toString();
+        entry.size = record["size"].toInteger();
+        entry.hash = record["hash"].toString();
+        m_entries.insert(id, entry);
+        m_idsByHash.insert(entry.hash, id);
+        m_order.append(id);
+        return;
+    }
+
+    if (op == QLatin1String("del") && m_entries.contains(id)) {
+        m_idsByHash.remove(m_entries.take(id).hash);
+        m_order.removeOne(id);
+        // Both the add and its tombstone are now dead
+        m_deadRecords += 2;
+        return;
+    }
+
+    ++m_deadRecords;
+}
+
+bool HistoryStore::appendRecord(const QJsonObject& record)
+{
+    QFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+        return false;
+    const QByteArray line = recordLine(record);
+    return file.write(line) == line.size();
+}
+
+QString HistoryStore::add(const QString& content)
+{
+    return addEntry(content, QUuid::createUuid().toString(QUuid::WithoutBraces),
+                    QDateTime::currentDateTime().toString(Qt::ISODate), makePreview(content));
+}
+
+QString HistoryStore::addEntry(const QString& content, const QString& id, const QString& timestamp,
+                               const QString& preview)
+{
+    ensureLoaded();
+    if (!QDir(m_directory).mkpath(kBlobsDir))
+        return QString();
+
+    const QByteArray utf8 = content.toUtf8();
+
+    Entry entry;
+    entry.hash = contentHash(utf8);
+    entry.id = m_idsByHash.value(entry.hash, id);
+    entry.timestamp = timestamp;
+    entry.preview = preview;
+    entry.size = content.size();
+
+    // Blob first: an index record never points at a missing blob
+    if (!writeBlob(entry.hash, utf8))
+        return QString();
+
+    const QJsonObject record = addRecord(entry);
+    if (!appendRecord(record))
+        return QString();
+    replay(record);
+
+    // Keep max MaxEntries entries
+    while (m_order.size() > MaxEntries)
+        tombstone(m_order.first());
+
+    return entry.id;
+}
+
+QVector<HistoryStore::Entry> HistoryStore::entries() const
+{
+    ensureLoaded();
+    QVector<Entry> result;
+    result.reserve(m_order.size());
+    for (auto it = m_order.crbegin(); it != m_order.crend(); ++it)
+        result.append(m_entries.value(*it));
+    return result;
+}
+
+QVector<HistoryStore::Entry> HistoryStore::page(int offset, int limit, const QString& query,
+                                              int* total) const
+{
+    ensureLoaded();
+    QVector<Entry> result;
+    int matched = 0;
+    for (auto it = m_order.crbegin(); it != m_order.crend(); ++it) {
+        const Entry& entry = *m_entries.constFind(*it);
+        if (!query.isEmpty() && !entry.preview.contains(query, Qt::CaseInsensitive))
+            continue;
+        if (matched >= offset && result.size() < limit)
+            result.append(entry);
+        ++matched;
+    }
+    if (total)
+        *total = matched;
+    return result;
+}
+
+int HistoryStore::count() const
+{
+    ensureLoaded();
+    return m_order.size();
+}
+
+bool HistoryStore::contains(const QString& id) const
+{
+    ensureLoaded();
+    return m_entries.contains(id);
+}
+
+QString HistoryStore::content(const QString& id) const
+{
+    if (!contains(id))
+        return QString();
+
+    QFile file(blobPath(m_entries.value(id).hash));
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+    return QString::fromUtf8(qUncompress(file.readAll()));
+}
+
+bool HistoryStore::tombstone(const QString& id)
+{
+    const QJsonObject record = deleteRecord(id);
+    if (!appendRecord(record))
+        return false;
+    replay(record);
+    // The blob is left for compaction to remove
+    return true;
+}
+
+bool HistoryStore::remove(const QString& id)
+{
+    if (!contains(id))
+        return false;
+    return tombstone(id);
+}
+
+bool HistoryStore::clear()
+{
+    ensureLoaded();
+    m_entries.clear();
+    m_order.clear();
+    m_idsByHash.clear();
+    m_deadRecords = 0;
+
+    QDir(m_directory + '/' + kBlobsDir).removeRecursively();
+    return !QFile::exists(indexPath()) || QFile::remove(indexPath());
+}
+
+bool HistoryStore::needsCompaction() const
+{
+    ensureLoaded();
+    return m_deadRecords >= CompactionThreshold;
+}
+
+bool HistoryStore::compact()
+{
+    ensureLoaded();
+
+    QByteArray index;
+    for (const QString& id : std::as_const(m_order))
+        index += recordLine(addRecord(m_entries.value(id)));
+    if (!writeFile(indexPath(), index))
+        return false;
+    m_deadRecords = 0;
+
+    // Remove blobs no live record refers to
+    QDir blobsDir(m_directory + '/' + kBlobsDir);
+    const QStringList files = blobsDir.entryList({"*" + kBlobSuffix}, QDir::Files);
+    for (const QString& fileName : files) {
+        if (!m_idsByHash.contains(QFileInfo(fileName).completeBaseName()))
+            blobsDir.remove(fileName);
+    }
+    return true;
+}
+
+bool HistoryStore::importLegacyFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    // Legacy files list the most recent entry first
+    const QJsonArray history = doc.array();
+    for (qsizetype i = history.size() - 1; i >= 0; --i) {
+        const QJsonObject legacy = history.at(i).toObject();
+        const QString content = legacy["content"].toString();
+
+        QString id = legacy["id"].toString();
+        if (id.isEmpty() || contains(id))
+            id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        const QString preview = legacy.contains("preview") ? legacy["preview"].toString() : makePreview(content);
+
+        if (addEntry(content, id, legacy["timestamp"].toString(), preview).isEmpty())
+            return false;
+    }
+
+    return QFile::remove(path);
+}
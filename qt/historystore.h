@@ -0,0 +1,90 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Desktop history storage: content-addressed blobs plus an append-only index.
+//
+// Content is stored once per distinct SHA-256 hash as a zlib-compressed
+// blob in blobs/<hash>.z and is only read when an entry is opened.
+// index.jsonl holds one small metadata record per line (id, timestamp,
+// preview, size, hash); saving appends an "add" record and deleting
+// appends a "del" tombstone, so neither rewrites existing data. Saving
+// content that is already stored moves its entry to the top instead of
+// writing the blob again. The index is replayed once into memory, after
+// which listing and lookup by id never touch the blobs. compact() rewrites
+// the index with the live entries only and removes unreferenced blobs;
+// callers run it in the background once needsCompaction() reports enough
+// dead records.
+class HistoryStore
+{
+public:
+    struct Entry {
+        QString id;
+        QString timestamp;  // ISO 8601
+        QString preview;
+        qint64 size = 0;    // Content length in characters
+        QString hash;       // Hex SHA-256 of the UTF-8 content
+    };
+
+    static constexpr int MaxEntries = 50;
+    static constexpr int PreviewLength = 100;
+    // Dead index records tolerated before compaction is due
+    static constexpr int CompactionThreshold = 20;
+
+    explicit HistoryStore(const QString& directory);
+
+    QString directory() const { return m_directory; }
+
+    // Adds an entry as the most recent; the oldest entries beyond
+    // MaxEntries are tombstoned. Content matching a live entry refreshes
+    // that entry instead. Returns the entry id, or an empty string.
+    QString add(const QString& content);
+
+    // Live entries, most recent first
+    QVector<Entry> entries() const;
+    // Up to limit live entries starting at offset, most recent first,
+    // keeping only those whose preview contains query (case-insensitive).
+    // total receives the number of matching entries.
+    QVector<Entry> page(int offset, int limit, const QString& query, int* total = nullptr) const;
+    int count() const;
+    bool contains(const QString& id) const;
+    // Content of an entry; empty if the id is unknown or unreadable
+    QString content(const QString& id) const;
+
+    bool remove(const QString& id);
+    bool clear();
+
+    bool needsCompaction() const;
+    bool compact();
+
+    // One-time import of the former single-file history.json layout.
+    // The legacy file is removed once its entries are stored.
+    bool importLegacyFile(const QString& path);
+
+private:
+    void ensureLoaded() const;
+    void replay(const QJsonObject& record) const;
+    bool appendRecord(const QJsonObject& record);
+    QString addEntry(const QString& content, const QString& id, const QString& timestamp,
+                     const QString& preview);
+    bool tombstone(const QString& id);
+    bool writeBlob(const QString& hash, const QByteArray& utf8);
+    QString indexPath() const;
+    QString blobPath(const QString& hash) const;
+
+    QString m_directory;
+
+    // In-memory view of the index, filled on first use
+    mutable bool m_loaded = false;
+    mutable QHash<QString, Entry> m_entries;
+    mutable QStringList m_order;      // Live ids, oldest first
+    mutable QHash<QString, QString> m_idsByHash;  // Live entry per content hash
+    mutable int m_deadRecords = 0;    // Index lines not describing a live entry
+};
+
+#endif // HISTORYSTORE_H
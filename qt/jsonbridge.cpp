@@ -1,5 +1,12 @@
 #include "jsonbridge.h"
 #include "asyncserialiser.h"
+#include "airgaptrace.h"
+#include "jsonhighlighter.h"
+#include "historystore.h"
+#include "documentcache.h"
+#include "jsonindexer.h"
+#include "jsonparallelformatter.h"
+#include "jsonwriter.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -9,38 +16,182 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QFile>
-#include <QDateTime>
-#include <QUuid>
+#include <QFileInfo>
 #include <QPromise>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <memory>
+
+#ifndef __EMSCRIPTEN__
+#include "jsonstreamformatter.h"
+#include <QUrl>
+#endif
+
+#if defined(AIRGAP_HAS_CONCURRENT) && QT_CONFIG(thread) && !defined(__EMSCRIPTEN__)
+#include <QtConcurrent/QtConcurrentRun>
+#define AIRGAP_FILE_FORMAT_THREADED 1
+#endif
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten/val.h>
 using namespace emscripten;
-#endif
 
-// Desktop-only: JSON formatting with indentation
-#ifndef __EMSCRIPTEN__
-static QString formatJsonNative(const QString &input, const QString &indentType) {
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(input.toUtf8(), &error);
+// UTF-8 payloads cross the bridge as byte views instead of strings. The
+// input is encoded once into the Qt heap and handed to JS as a
+// typed_memory_view (no copy); it is only valid until the next allocation
+// in this module, so JS must consume it synchronously.
+static val utf8View(const QByteArray &utf8) {
+    return val(typed_memory_view(size_t(utf8.size()),
+                                 reinterpret_cast<const unsigned char *>(utf8.constData())));
+}
 
-    if (error.error != QJsonParseError::NoError) {
-        return QString();
+static bool isUtf8Array(const val &value) {
+    return value.instanceof(val::global("Uint8Array"));
+}
+
+// Copies a JS Uint8Array of UTF-8 into the Qt heap with a single set()
+// and decodes it, skipping the std::string and JSON envelope round trips
+static QByteArray bytesFromArray(const val &array) {
+    const size_t length = array["length"].as<size_t>();
+    QByteArray bytes(qsizetype(length), Qt::Uninitialized);
+    val(typed_memory_view(length, reinterpret_cast<unsigned char *>(bytes.data())))
+        .call<void>("set", array);
+    return bytes;
+}
+
+static QString fromUtf8Array(const val &array) {
+    return QString::fromUtf8(bytesFromArray(array));
+}
+
+// Result envelopes are plain JS objects read field by field, so the
+// payload never goes through a JSON encode/decode just to be unwrapped
+static QString stringField(const val &object, const char *name, const QString &fallback = QString()) {
+    if (object.isUndefined() || object.isNull())
+        return fallback;
+    val field = object[name];
+    return field.isString() ? QString::fromStdString(field.as<std::string>()) : fallback;
+}
+
+static int intField(const val &object, const char *name) {
+    if (object.isUndefined() || object.isNull())
+        return 0;
+    val field = object[name];
+    return field.isNumber() ? field.as<int>() : 0;
+}
+
+// Reads a {success, result: Uint8Array, error} envelope into result
+static void readResultEnvelope(const val &reply, QVariantMap &result, const char *operation) {
+    AIRGAP_TRACE_ZONE("readResultEnvelope");
+    if (reply.isUndefined() || reply.isNull()) {
+        result["error"] = QString("%1 returned no result").arg(operation);
+        return;
+    }
+    const bool success = reply["success"].isTrue();
+    result["success"] = success;
+    if (success) {
+        result["result"] = fromUtf8Array(reply["result"]);
+    } else {
+        result["error"] = stringField(reply, "error", "Unknown error");
+    }
+}
+
+// History envelopes ({success, entries, total}) carry entry metadata as
+// plain objects too
+static QVariantList historyEntryList(const val &reply) {
+    QVariantList entries;
+    const val list = reply["entries"];
+    if (!list.isArray())
+        return entries;
+    const int length = list["length"].as<int>();
+    for (int i = 0; i < length; ++i) {
+        const val entry = list[i];
+        QVariantMap entryMap;
+        entryMap["id"] = stringField(entry, "id");
+        entryMap["timestamp"] = stringField(entry, "timestamp");
+        entryMap["preview"] = stringField(entry, "preview");
+        entryMap["size"] = intField(entry, "size");
+        entries.append(entryMap);
     }
+    return entries;
+}
 
-    QJsonDocument::JsonFormat format = QJsonDocument::Indented;
-    return QString::fromUtf8(doc.toJson(format));
+// The engine loads in the background while the interface starts; the
+// first operation waits for it inside its task, and later ones queue behind
+static void waitForEngine(const val &jsonBridge) {
+    if (!jsonBridge.call<bool>("isReady")) {
+        AIRGAP_TRACE_ZONE("JsonBridge whenReady");
+        jsonBridge.call<val>("whenReady").await();
+    }
 }
 
-static QString minifyJsonNative(const QString &input) {
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(input.toUtf8(), &error);
+static QVariantMap makeValidationError(const QString &message, int line = 0, int column = 0) {
+    QVariantMap error;
+    error["message"] = message;
+    error["line"] = line;
+    error["column"] = column;
+    return error;
+}
 
-    if (error.error != QJsonParseError::NoError) {
-        return QString();
+// Reads a {isValid, error, stats} object into result
+static void readValidation(const val &reply, QVariantMap &result) {
+    result["isValid"] = false;
+    result["stats"] = QVariantMap();
+    if (reply.isUndefined() || reply.isNull()) {
+        result["error"] = makeValidationError("validateJson returned no result");
+        return;
+    }
+
+    bool isValid = reply["isValid"].isTrue();
+    result["isValid"] = isValid;
+
+    if (isValid) {
+        QVariantMap stats;
+        val jsStats = reply["stats"];
+        stats["object_count"] = intField(jsStats, "objectCount");
+        stats["array_count"] = intField(jsStats, "arrayCount");
+        stats["string_count"] = intField(jsStats, "stringCount");
+        stats["number_count"] = intField(jsStats, "numberCount");
+        stats["boolean_count"] = intField(jsStats, "booleanCount");
+        stats["null_count"] = intField(jsStats, "nullCount");
+        stats["total_keys"] = intField(jsStats, "totalKeys");
+        stats["max_depth"] = intField(jsStats, "maxDepth");
+        result["stats"] = stats;
+    } else {
+        val jsError = reply["error"];
+        result["error"] = makeValidationError(stringField(jsError, "message", "Unknown error"),
+                                              intField(jsError, "line"), intField(jsError, "column"));
     }
+}
+#endif
 
-    return QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
+// Cache costs are estimates: QJsonDocument storage is roughly twice the
+// UTF-8 size, and strings are charged their UTF-16 size
+static qsizetype documentCost(const QByteArray &utf8) {
+    return utf8.size() * 2;
+}
+
+static qsizetype stringCost(const QString &text) {
+    return text.size() * qsizetype(sizeof(QChar));
+}
+
+// Validation maps are small and charged a flat cost
+static constexpr qsizetype ValidationCost = 1024;
+
+// Parsed document for utf8, from the cache when present; a successful
+// parse is cached under key
+static QJsonDocument cachedDocument(DocumentCache &cache, const DocumentCache::Key &key,
+                                    const QByteArray &utf8, QJsonParseError *error) {
+    const QVariant cached = cache.value(key, DocumentCache::Document);
+    if (cached.isValid()) {
+        error->error = QJsonParseError::NoError;
+        error->offset = 0;
+        return cached.value<QJsonDocument>();
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(utf8, error);
+    if (error->error == QJsonParseError::NoError)
+        cache.insert(key, DocumentCache::Document, QVariant::fromValue(doc), documentCost(utf8));
+    return doc;
 }
 
 static void countJsonStats(const QJsonValue &value, QVariantMap &stats, int depth) {
@@ -73,171 +224,366 @@ static void countJsonStats(const QJsonValue &value, QVariantMap &stats, int dept
     }
 }
 
-static QString getHistoryFilePath() {
-    // Check if running in Docker/container (workspace directory exists)
-    QDir workspaceDir("/workspace");
-    if (workspaceDir.exists()) {
-        // Use workspace directory for persistence in Docker
-        return "/workspace/.history.json";
+static QVariantMap documentStats(const QJsonDocument &doc) {
+    AIRGAP_TRACE_ZONE("documentStats");
+    QVariantMap stats;
+    stats["object_count"] = 0;
+    stats["array_count"] = 0;
+    stats["string_count"] = 0;
+    stats["number_count"] = 0;
+    stats["boolean_count"] = 0;
+    stats["null_count"] = 0;
+    stats["total_keys"] = 0;
+    stats["max_depth"] = 0;
+
+    if (doc.isObject()) {
+        countJsonStats(doc.object(), stats, 1);
+    } else if (doc.isArray()) {
+        countJsonStats(doc.array(), stats, 1);
     }
+    return stats;
+}
 
-    // Use standard app data location for native desktop
-    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir dir(dataPath);
-    if (!dir.exists()) {
-        dir.mkpath(".");
+#ifdef __EMSCRIPTEN__
+// Any top-level value is valid, as in the Rust formatter
+static constexpr bool ValidationRequiresContainer = false;
+#else
+// QJsonDocument only holds objects and arrays
+static constexpr bool ValidationRequiresContainer = true;
+#endif
+
+// Validation map from the structural indexer; no document is built
+static QVariantMap indexValidation(const JsonIndexer::Result &index) {
+    AIRGAP_TRACE_ZONE("indexValidation");
+    QVariantMap result;
+    result["isValid"] = index.valid;
+    if (!index.valid) {
+        QVariantMap error;
+        error["message"] = index.error;
+        error["line"] = index.errorLine;
+        error["column"] = index.errorColumn;
+        result["error"] = error;
+        result["stats"] = QVariantMap();
+        return result;
     }
-    return dataPath + "/history.json";
+
+    QVariantMap stats;
+    stats["object_count"] = index.stats.objects;
+    stats["array_count"] = index.stats.arrays;
+    stats["string_count"] = index.stats.strings;
+    stats["number_count"] = index.stats.numbers;
+    stats["boolean_count"] = index.stats.booleans;
+    stats["null_count"] = index.stats.nulls;
+    stats["total_keys"] = index.stats.keys;
+    stats["max_depth"] = index.stats.maxDepth;
+    result["stats"] = stats;
+    return result;
 }
 
-static QJsonArray loadHistoryFromFile() {
-    QFile file(getHistoryFilePath());
-    if (!file.exists()) {
-        return QJsonArray();
-    }
-    if (!file.open(QIODevice::ReadOnly)) {
-        return QJsonArray();
+// Validation error for UTF-8 input; the parse offset is in bytes
+static QVariantMap byteErrorMap(QByteArrayView utf8, const QJsonParseError &parseError) {
+    QVariantMap error;
+    error["message"] = parseError.errorString();
+    int line = 1, column = 1;
+    for (qsizetype i = 0; i < parseError.offset && i < utf8.size(); ++i) {
+        const char c = utf8[i];
+        if (c == '\n') {
+            line++;
+            column = 1;
+        } else if ((c & 0xC0) != 0x80) {
+            column++;
+        }
     }
-    QByteArray data = file.readAll();
-    file.close();
+    error["line"] = line;
+    error["column"] = column;
+    return error;
+}
 
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isArray()) {
-        return doc.array();
-    }
-    return QJsonArray();
+// Validation error for input QJsonDocument rejected, taken from the
+// structural indexer so that it matches validateJson(). Input only
+// QJsonDocument rejects falls back to its own byte offset.
+static QVariantMap parseFailureMap(QByteArrayView utf8, const QJsonParseError &parseError) {
+    const JsonIndexer::Result index = JsonIndexer::validate(utf8, ValidationRequiresContainer);
+    if (index.valid)
+        return byteErrorMap(utf8, parseError);
+    return indexValidation(index).value("error").toMap();
 }
 
-static bool saveHistoryToFile(const QJsonArray &history) {
-    QFile file(getHistoryFilePath());
-    if (!file.open(QIODevice::WriteOnly)) {
-        return false;
+// A file read by openFile(), with the tree store and line index built
+// for it, before they reach the models
+struct OpenedFile {
+    QVariantMap result;
+    QJsonTreeModel::BuildResult tree;
+    QString text;               // Formatted, for the line model
+    JsonLineModel::Index lines;
+};
+
+// Parses, formats and indexes an opened file; touches no models, so it is
+// safe on a worker thread
+static OpenedFile readOpenedFile(const QByteArray &utf8, const QString &fileName, const QString &indentType) {
+    OpenedFile file;
+    QVariantMap &result = file.result;
+    result["success"] = false;
+    result["fileName"] = fileName;
+    result["size"] = utf8.size();
+
+    QVariantMap validation;
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(utf8, &parseError);
+
+    if (parseError.error != QJsonParseError::NoError) {
+        const QVariantMap error = parseFailureMap(utf8, parseError);
+        validation["isValid"] = false;
+        validation["error"] = error;
+        validation["stats"] = QVariantMap();
+        result["error"] = error.value("message");
+    } else {
+        validation["isValid"] = true;
+        validation["stats"] = documentStats(doc);
+        file.text = QString::fromUtf8(
+            JsonWriter::toJson(doc, JsonWriter::Indent::fromString(indentType), utf8.size() * 2));
+        file.tree = QJsonTreeModel::buildStore(doc);
+        file.lines = JsonLineModel::indexText(file.text);
+        result["success"] = true;
     }
-    QJsonDocument doc(history);
-    file.write(doc.toJson());
-    file.close();
-    return true;
+
+    result["validation"] = validation;
+    return file;
 }
 
-static QString highlightJsonNative(const QString &input) {
-    // Syntax highlighting for desktop - produces jq-like colored output
-    // Wrap in <pre> to preserve whitespace and newlines
-    QString result = "<pre style=\"margin:0; font-family:monospace; white-space:pre-wrap;\">";
-    bool inString = false;
-    bool inKey = false;
-    bool escapeNext = false;
-
-    for (int i = 0; i < input.length(); ++i) {
-        QChar c = input[i];
-
-        if (escapeNext) {
-            // Handle escaped character - escape HTML entities if needed
-            if (c == '<') result += "&lt;";
-            else if (c == '>') result += "&gt;";
-            else if (c == '&') result += "&amp;";
-            else result += c;
-            escapeNext = false;
-            continue;
-        }
+// Desktop-only: JSON formatting with indentation
+#ifndef __EMSCRIPTEN__
+// openFile() on desktop: maps the file and reads it with readOpenedFile()
+static OpenedFile readLocalFile(const QString &localPath, const QString &indentType) {
+    AIRGAP_TRACE_ZONE("readLocalFile");
+    QFile input(localPath);
+    if (!input.open(QIODevice::ReadOnly) || input.size() == 0) {
+        OpenedFile file;
+        file.result["success"] = false;
+        file.result["error"] = input.isOpen()
+            ? QStringLiteral("File is empty")
+            : QString("Cannot open %1: %2").arg(localPath, input.errorString());
+        return file;
+    }
 
-        if (c == '\\' && inString) {
-            result += c;
-            escapeNext = true;
-            continue;
-        }
+    // The parser reads the mapping in place; the bytes are never copied
+    // into a QString
+    uchar *mapped = input.map(0, input.size());
+    const QByteArray bytes = mapped
+        ? QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), input.size())
+        : input.readAll();
+    OpenedFile file = readOpenedFile(bytes, QFileInfo(localPath).fileName(), indentType);
+    if (mapped)
+        input.unmap(mapped);
+    return file;
+}
 
-        if (c == '"') {
-            if (!inString) {
-                // Check if this is a key (followed eventually by :)
-                int j = i + 1;
-                while (j < input.length() && input[j] != '"') {
-                    if (input[j] == '\\') j++;
-                    j++;
-                }
-                j++; // skip closing quote
-                while (j < input.length() && input[j].isSpace()) j++;
-                inKey = (j < input.length() && input[j] == ':');
+// Another key for a document already cached is charged only its entry
+static constexpr qsizetype AliasCost = 0;
 
-                if (inKey) {
-                    result += "<span style=\"color:#8fa1b3;\">\"";  // Keys: light blue (jq style)
-                } else {
-                    result += "<span style=\"color:#a3be8c;\">\"";  // Strings: green (jq style)
-                }
-                inString = true;
-            } else {
-                result += "\"</span>";
-                inString = false;
-                inKey = false;
-            }
-            continue;
-        }
+// sizeHint is the input's UTF-8 size; output is reserved at twice that
+static QString formatDocumentNative(const QJsonDocument &doc, const QString &indentType, qsizetype sizeHint) {
+    AIRGAP_TRACE_ZONE("formatDocumentNative");
+    return QString::fromUtf8(JsonWriter::toJson(doc, JsonWriter::Indent::fromString(indentType), sizeHint * 2));
+}
 
-        if (inString) {
-            // Escape HTML entities
-            if (c == '<') result += "&lt;";
-            else if (c == '>') result += "&gt;";
-            else if (c == '&') result += "&amp;";
-            else result += c;
-            continue;
-        }
+static QString minifyDocumentNative(const QJsonDocument &doc, qsizetype sizeHint) {
+    AIRGAP_TRACE_ZONE("minifyDocumentNative");
+    return QString::fromUtf8(JsonWriter::toJson(doc, JsonWriter::Indent::minified(), sizeHint));
+}
 
-        // Numbers
-        if (c.isDigit() || (c == '-' && i + 1 < input.length() && input[i+1].isDigit())) {
-            result += "<span style=\"color:#d08770;\">";  // Numbers: orange (jq style)
-            while (i < input.length() && (input[i].isDigit() || input[i] == '.' || input[i] == '-' || input[i] == 'e' || input[i] == 'E' || input[i] == '+')) {
-                result += input[i];
-                i++;
-            }
-            result += "</span>";
-            i--;
-            continue;
-        }
+// Large top-level arrays are formatted in slices on the thread pool,
+// without building a document; null for any other input
+static QString formatSlicedNative(const QByteArray &utf8, const JsonWriter::Indent &indent) {
+    AIRGAP_TRACE_ZONE("formatSlicedNative");
+    if (utf8.size() < JsonParallelFormatter::MinParallelSize)
+        return QString();
+    const QByteArray output = JsonParallelFormatter::format(utf8, indent);
+    return output.isNull() ? QString() : QString::fromUtf8(output);
+}
 
-        // true/false
-        if (input.mid(i, 4) == "true") {
-            result += "<span style=\"color:#b48ead;\">true</span>";  // Booleans: purple (jq style)
-            i += 3;
-            continue;
-        }
-        if (input.mid(i, 5) == "false") {
-            result += "<span style=\"color:#b48ead;\">false</span>";  // Booleans: purple
-            i += 4;
-            continue;
-        }
-        // null
-        if (input.mid(i, 4) == "null") {
-            result += "<span style=\"color:#bf616a;\">null</span>";  // Null: red (jq style)
-            i += 3;
-            continue;
-        }
+// State shared by a desktop operation's worker job and its main-thread
+// delivery, which never run at the same time. The worker encodes and
+// hashes the input and reads the cache (DocumentCache locks); delivery
+// caches what the job computed.
+struct NativeJob {
+    QByteArray utf8;
+    DocumentCache::Key key {};
+    QJsonDocument doc;
+    QJsonParseError parseError {};
+    bool haveDocument = false;  // From the cache or a successful parse
+    bool parsed = false;        // Parsed by the job, so not cached yet
+
+    // Worker
+    void encode(const QString &input) {
+        AIRGAP_TRACE_ZONE("NativeJob::encode");
+        utf8 = input.toUtf8();
+        key = DocumentCache::keyFor(utf8);
+    }
 
-        // Brackets and braces
-        if (c == '{' || c == '}' || c == '[' || c == ']') {
-            result += "<span style=\"color:#c0c5ce;\">" + QString(c) + "</span>";  // Punctuation: light gray
-            continue;
+    // Worker
+    void lookUpDocument(DocumentCache &cache) {
+        const QVariant cached = cache.value(key, DocumentCache::Document);
+        if (cached.isValid()) {
+            doc = cached.value<QJsonDocument>();
+            haveDocument = true;
         }
+    }
 
-        // Colon and comma
-        if (c == ':' || c == ',') {
-            result += "<span style=\"color:#c0c5ce;\">" + QString(c) + "</span>";  // Punctuation: light gray
-            continue;
+    // Worker
+    bool parse() {
+        if (!haveDocument) {
+            AIRGAP_TRACE_ZONE("NativeJob::parse");
+            doc = QJsonDocument::fromJson(utf8, &parseError);
+            haveDocument = parsed = parseError.error == QJsonParseError::NoError;
         }
+        return haveDocument;
+    }
 
-        // All other characters (whitespace, newlines) - pass through
-        result += c;
+    // Main thread
+    void storeDocument(DocumentCache &cache) const {
+        if (parsed)
+            cache.insert(key, DocumentCache::Document, QVariant::fromValue(doc), documentCost(utf8));
+    }
+};
+
+// Format and minify produce one output each
+struct OutputJob : NativeJob {
+    QString output;
+    bool computed = false;      // Produced by the job rather than cached
+};
+
+struct ProcessJob : NativeJob {
+    QVariantMap validation;
+    QVariantMap error;          // Set when the input does not parse
+    QString formatted;
+    QString minified;
+    QJsonTreeModel::BuildResult tree;
+    bool validationComputed = false;
+    bool formattedComputed = false;
+    bool minifiedComputed = false;
+};
+
+// Main thread: caches what an OutputJob computed under name and builds the
+// completion result. The tree is usually built from the output next, so
+// the document is also cached under the output's derived key; sliced
+// output has no document.
+static QVariantMap outputResult(DocumentCache &cache, const OutputJob &job, const QString &name) {
+    AIRGAP_TRACE_ZONE("outputResult");
+    QVariantMap result;
+    result["success"] = false;
+
+    if (job.computed) {
+        job.storeDocument(cache);
+        cache.insert(job.key, name, job.output, stringCost(job.output));
+        if (job.haveDocument)
+            cache.insert(DocumentCache::derivedKey(job.key, name), DocumentCache::Document,
+                         QVariant::fromValue(job.doc), AliasCost);
     }
 
-    result += "</pre>";
+    if (job.output.isNull()) {
+        result["error"] = "Invalid JSON";
+    } else {
+        result["success"] = true;
+        result["result"] = job.output;
+    }
     return result;
 }
+
+// QML file dialogs hand over file: URLs
+static QString localFilePath(const QString &path) {
+    return path.startsWith(QLatin1String("file:")) ? QUrl(path).toLocalFile() : path;
+}
+
+static QVariantMap fileResultMap(const JsonStreamFormatter::FileResult &fileResult, const QString &outputPath) {
+    QVariantMap result;
+    result["success"] = fileResult.success;
+    result["outputPath"] = outputPath;
+    result["bytesRead"] = fileResult.bytesRead;
+    result["bytesWritten"] = fileResult.bytesWritten;
+    if (!fileResult.success)
+        result["error"] = fileResult.error;
+    return result;
+}
+
+static QString getHistoryDirectory() {
+    // Check if running in Docker/container (workspace directory exists)
+    QDir workspaceDir("/workspace");
+    if (workspaceDir.exists()) {
+        // Use workspace directory for persistence in Docker
+        return "/workspace/.history";
+    }
+
+    // Use standard app data location for native desktop
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return dataPath + "/history";
+}
+
+static QString getLegacyHistoryFilePath() {
+    if (QDir("/workspace").exists()) {
+        return "/workspace/.history.json";
+    }
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/history.json";
+}
+
+// Shared desktop history store; a history.json left by older versions is
+// migrated into it on first use
+static HistoryStore &historyStore() {
+    static HistoryStore store(getHistoryDirectory());
+    static bool migrated = false;
+    if (!migrated) {
+        migrated = true;
+        const QString legacyPath = getLegacyHistoryFilePath();
+        if (QFile::exists(legacyPath) && !store.importLegacyFile(legacyPath)) {
+            qWarning() << "Failed to migrate history from" << legacyPath;
+        }
+    }
+    return store;
+}
+
+// Compaction rewrites the index, so it runs as its own background task
+static void scheduleHistoryCompaction() {
+    if (!historyStore().needsCompaction()) {
+        return;
+    }
+    AsyncSerialiser::instance().enqueue("compactHistory", QStringLiteral("compactHistory"), []() {
+        QPromise<QVariant> promise;
+        auto future = promise.future();
+        promise.start();
+        bool success = historyStore().compact();
+        promise.addResult(QVariant::fromValue(success));
+        promise.finish();
+        return future;
+    }, AsyncSerialiser::Priority::Background);
+}
 #endif
 
 JsonBridge::JsonBridge(QObject *parent)
     : QObject(parent)
     , m_treeModel(new QJsonTreeModel(this))
+    , m_outputModel(new JsonLineModel(this))
+    , m_historyModel(new HistoryListModel(this))
+    , m_documentCache(std::make_shared<DocumentCache>())
+    , m_validationIndexer(std::make_shared<JsonIncrementalIndexer>(ValidationRequiresContainer))
 {
     checkReady();
     connectAsyncSerialiserSignals();
+
+    connect(m_treeModel, &QJsonTreeModel::loadProgress,
+            this, &JsonBridge::treeLoadProgress);
+    connect(m_treeModel, &QJsonTreeModel::loadFinished,
+            this, &JsonBridge::treeLoaded);
+
+    // The history panel pages through metadata on demand
+    connect(m_historyModel, &HistoryListModel::pageRequested,
+            this, &JsonBridge::loadHistoryPage);
+    connect(this, &JsonBridge::historyPageLoaded,
+            m_historyModel, &HistoryListModel::appendPage);
+}
+
+JsonBridge::~JsonBridge()
+{
+    cancelFileFormat();
 }
 
 void JsonBridge::connectAsyncSerialiserSignals()
@@ -267,9 +613,301 @@ QJsonTreeModel* JsonBridge::treeModel() const
     return m_treeModel;
 }
 
-bool JsonBridge::loadTreeModel(const QString &json)
+JsonLineModel* JsonBridge::outputModel() const
+{
+    return m_outputModel;
+}
+
+HistoryListModel* JsonBridge::historyModel() const
+{
+    return m_historyModel;
+}
+
+void JsonBridge::loadTreeModel(const QString &json)
+{
+    AIRGAP_TRACE_ZONE("JsonBridge::loadTreeModel");
+    // Supersedes any tree build still running for a previous input. The
+    // text is encoded, hashed and looked up in the build: a document parsed
+    // earlier for the same text skips the parse, and a new parse is cached.
+    // The last format or minify output already has a key derived from its
+    // input, so it is compared instead of hashed.
+    const std::shared_ptr<DocumentCache> cache = m_documentCache;
+    m_treeModel->loadJsonAsync(json, [cache, json, output = m_lastOutput, outputKey = m_lastOutputKey](
+                                         const QByteArray &utf8, QJsonParseError *error) {
+        const bool isOutput = !output.isNull() && json == output;
+        return cachedDocument(*cache, isOutput ? outputKey : DocumentCache::keyFor(utf8), utf8, error);
+    });
+}
+
+void JsonBridge::rememberOutput(const QString &output, const DocumentCache::Key &key)
+{
+    m_lastOutput = output;
+    m_lastOutputKey = key;
+}
+
+qint64 JsonBridge::cacheBudget() const
+{
+    return m_documentCache->budget();
+}
+
+void JsonBridge::setCacheBudget(qint64 bytes)
 {
-    return m_treeModel->loadJson(json);
+    bytes = qMax<qint64>(0, bytes);
+    if (bytes == m_documentCache->budget())
+        return;
+    m_documentCache->setBudget(bytes);
+    emit cacheBudgetChanged();
+}
+
+QVariantMap JsonBridge::cacheStats() const
+{
+    QVariantMap stats;
+    stats["hits"] = m_documentCache->hits();
+    stats["misses"] = m_documentCache->misses();
+    stats["entries"] = qint64(m_documentCache->count());
+    stats["cost"] = qint64(m_documentCache->totalCost());
+    stats["budget"] = qint64(m_documentCache->budget());
+    return stats;
+}
+
+QVariantMap JsonBridge::taskMetrics() const
+{
+    return AsyncSerialiser::instance().metrics();
+}
+
+bool JsonBridge::exportTaskTrace(const QString &path) const
+{
+#ifdef __EMSCRIPTEN__
+    // No file system to write to; the browser profiler shows the tasks as
+    // performance.measure() entries instead
+    Q_UNUSED(path);
+    return false;
+#else
+    return AsyncSerialiser::instance().exportChromeTrace(localFilePath(path));
+#endif
+}
+
+void JsonBridge::clearCache()
+{
+    m_documentCache->clear();
+    m_documentCache->resetCounters();
+}
+
+void JsonBridge::cancelTreeLoad()
+{
+    m_treeModel->cancelLoad();
+}
+
+void JsonBridge::formatFile(const QString &inputPath, const QString &outputPath, const QString &indentType)
+{
+    startFileFormat(inputPath, outputPath, indentType, false);
+}
+
+void JsonBridge::minifyFile(const QString &inputPath, const QString &outputPath)
+{
+    startFileFormat(inputPath, outputPath, QString(), true);
+}
+
+void JsonBridge::startFileFormat(const QString &inputPath, const QString &outputPath,
+                                 const QString &indentType, bool minify)
+{
+    // Supersedes any file job still running
+    cancelFileFormat();
+    const quint64 generation = ++m_fileGeneration;
+
+#ifdef __EMSCRIPTEN__
+    Q_UNUSED(inputPath)
+    Q_UNUSED(indentType)
+    Q_UNUSED(minify)
+    Q_UNUSED(generation)
+    QVariantMap result;
+    result["success"] = false;
+    result["outputPath"] = outputPath;
+    result["error"] = "File formatting is only available on desktop";
+    QMetaObject::invokeMethod(this, [this, result]() {
+        emit fileFormatCompleted(result);
+    }, Qt::QueuedConnection);
+#else
+    const QString in = localFilePath(inputPath);
+    const QString out = localFilePath(outputPath);
+    const JsonWriter::Indent indent = minify ? JsonWriter::Indent::minified()
+                                             : JsonWriter::Indent::fromString(indentType);
+
+#ifdef AIRGAP_FILE_FORMAT_THREADED
+    // Runs outside AsyncSerialiser: large files outlast its watchdog, and
+    // the job touches no bridge state until it completes
+    auto *watcher = new QFutureWatcher<JsonStreamFormatter::FileResult>(this);
+    m_fileWatcher = watcher;
+
+    connect(watcher, &QFutureWatcherBase::progressValueChanged,
+            this, [this, generation](int percent) {
+        if (generation == m_fileGeneration)
+            emit fileFormatProgress(percent);
+    });
+    connect(watcher, &QFutureWatcherBase::finished,
+            this, [this, watcher, generation, out]() {
+        watcher->deleteLater();
+        if (generation != m_fileGeneration || watcher->isCanceled()
+            || watcher->future().resultCount() == 0)
+            return;
+
+        m_fileWatcher = nullptr;
+        emit fileFormatCompleted(fileResultMap(watcher->future().result(), out));
+    });
+
+    watcher->setFuture(QtConcurrent::run([](QPromise<JsonStreamFormatter::FileResult> &promise,
+                                            const QString &source, const QString &target,
+                                            const JsonWriter::Indent &style) {
+        promise.setProgressRange(0, 100);
+        JsonStreamFormatter::FileResult fileResult = JsonStreamFormatter::formatFile(
+            source, target, style, [&promise](int percent) {
+                promise.setProgressValue(percent);
+                return !promise.isCanceled();
+            });
+        if (!fileResult.canceled)
+            promise.addResult(fileResult);
+    }, in, out, indent));
+#else
+    // No worker threads: format on the next event loop turn
+    QTimer::singleShot(0, this, [this, generation, in, out, indent]() {
+        if (generation != m_fileGeneration)
+            return;
+        const JsonStreamFormatter::FileResult fileResult = JsonStreamFormatter::formatFile(
+            in, out, indent, [this](int percent) {
+                emit fileFormatProgress(percent);
+                return true;
+            });
+        emit fileFormatCompleted(fileResultMap(fileResult, out));
+    });
+#endif
+#endif
+}
+
+void JsonBridge::cancelFileFormat()
+{
+    // Bumping the generation invalidates any pending completion; a
+    // canceled job discards its partial output
+    ++m_fileGeneration;
+
+    if (m_fileWatcher) {
+        m_fileWatcher->disconnect(this);
+        m_fileWatcher->cancel();
+        m_fileWatcher->deleteLater();
+        m_fileWatcher = nullptr;
+    }
+}
+
+void JsonBridge::openFile(const QString &path, const QString &indentType)
+{
+    const quint64 generation = ++m_openGeneration;
+
+#ifdef __EMSCRIPTEN__
+    Q_UNUSED(path)
+    // The picker must open within the user gesture, so this call is not
+    // queued; bridge.js reads the chosen file in slices and the poll below
+    // collects it once complete
+    val jsonBridge = val::global("window")["JsonBridge"];
+    if (jsonBridge.isUndefined() || jsonBridge.isNull()) {
+        QVariantMap result;
+        result["success"] = false;
+        result["error"] = "JsonBridge not available";
+        QMetaObject::invokeMethod(this, [this, result]() {
+            emit fileOpened(result);
+        }, Qt::QueuedConnection);
+        return;
+    }
+    jsonBridge.call<void>("chooseFile");
+    pollChosenFile(generation, indentType);
+#else
+    // Runs outside AsyncSerialiser like startFileFormat(): reading a large
+    // file outlasts its watchdog, and the job touches no bridge state. The
+    // tree store and line index are built with the text, so completion
+    // only swaps them into the models.
+    const QString localPath = localFilePath(path);
+#ifdef AIRGAP_FILE_FORMAT_THREADED
+    auto *watcher = new QFutureWatcher<OpenedFile>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        // A newer openFile() supersedes this one
+        if (generation != m_openGeneration || watcher->future().resultCount() == 0)
+            return;
+        emit fileOpened(showOpenedFile(watcher->future().takeResult()));
+    });
+    watcher->setFuture(QtConcurrent::run(readLocalFile, localPath, indentType));
+#else
+    // No worker threads: read on the next event loop turn
+    QTimer::singleShot(0, this, [this, generation, localPath, indentType]() {
+        if (generation == m_openGeneration)
+            emit fileOpened(showOpenedFile(readLocalFile(localPath, indentType)));
+    });
+#endif
+#endif
+}
+
+#ifdef __EMSCRIPTEN__
+void JsonBridge::pollChosenFile(quint64 generation, const QString &indentType)
+{
+    QTimer::singleShot(ChosenFilePollMs, this, [this, generation, indentType]() {
+        if (generation != m_openGeneration)
+            return;
+
+        val jsonBridge = val::global("window")["JsonBridge"];
+        val chosen = jsonBridge.call<val>("takeChosenFile");
+        if (chosen.isNull() || chosen.isUndefined()) {
+            // Still choosing or reading
+            pollChosenFile(generation, indentType);
+            return;
+        }
+
+        const QString state = stringField(chosen, "state");
+        if (state == "none" || state == "canceled")
+            return;
+
+        AsyncSerialiser::instance().enqueue("openFile", [this, chosen, state, indentType]() {
+            QPromise<QVariant> promise;
+            auto future = promise.future();
+            promise.start();
+
+            QVariantMap result;
+            result["success"] = false;
+
+            try {
+                if (state != "ready") {
+                    result["error"] = stringField(chosen, "error", "Cannot read file");
+                } else {
+                    // One copy from the JS buffer into the Qt heap
+                    result = showOpenedFile(readOpenedFile(bytesFromArray(chosen["bytes"]),
+                                                           stringField(chosen, "name"), indentType));
+                }
+            } catch (const std::exception &e) {
+                result["error"] = QString("Exception: %1").arg(e.what());
+            } catch (...) {
+                result["error"] = "Unknown error in openFile";
+            }
+
+            QMetaObject::invokeMethod(this, [this, result]() {
+                emit fileOpened(result);
+            }, Qt::QueuedConnection);
+
+            promise.addResult(QVariant::fromValue(result));
+            promise.finish();
+            return future;
+        });
+    });
+}
+#endif
+
+QVariantMap JsonBridge::showOpenedFile(OpenedFile &&file)
+{
+    // The text goes straight to the line model, never through a QML text
+    // control
+    QVariantMap result = std::move(file.result);
+    if (result.value("success").toBool()) {
+        m_treeModel->applyBuildResult(std::move(file.tree));
+        m_outputModel->setIndexedText(file.text, std::move(file.lines));
+        result["lineCount"] = m_outputModel->lineCount();
+    }
+    return result;
 }
 
 void JsonBridge::checkReady()
@@ -282,6 +920,11 @@ void JsonBridge::checkReady()
         if (!isReadyFunc.isUndefined()) {
             m_ready = jsonBridge.call<bool>("isReady");
         }
+        // Still loading alongside the interface; look again shortly
+        if (!m_ready && !jsonBridge["isLoading"].isUndefined() && jsonBridge.call<bool>("isLoading")) {
+            QTimer::singleShot(EngineReadyPollMs, this, &JsonBridge::checkReady);
+            return;
+        }
     }
 #else
     // Desktop mode is always ready
@@ -297,7 +940,9 @@ bool JsonBridge::isReady() const
 
 void JsonBridge::formatJson(const QString &input, const QString &indentType)
 {
+#ifdef __EMSCRIPTEN__
     AsyncSerialiser::instance().enqueue("formatJson", [this, input, indentType]() {
+        AIRGAP_TRACE_ZONE("JsonBridge::formatJson");
         QPromise<QVariant> promise;
         auto future = promise.future();
         promise.start();
@@ -305,34 +950,30 @@ void JsonBridge::formatJson(const QString &input, const QString &indentType)
         QVariantMap result;
         result["success"] = false;
 
-#ifdef __EMSCRIPTEN__
         try {
             val window = val::global("window");
             val jsonBridge = window["JsonBridge"];
 
-            if (jsonBridge.isUndefined() || jsonBridge.isNull()) {
+            const QByteArray utf8 = input.toUtf8();
+            AsyncSerialiser::instance().setCurrentTaskPayload(utf8.size());
+            const DocumentCache::Key key = DocumentCache::keyFor(utf8);
+            const QString name = DocumentCache::formattedName(indentType);
+            const QVariant cached = m_documentCache->value(key, name);
+
+            if (cached.isValid()) {
+                result["success"] = true;
+                result["result"] = cached;
+            } else if (jsonBridge.isUndefined() || jsonBridge.isNull()) {
                 result["error"] = "JsonBridge not available";
             } else {
-                std::string inputStd = input.toStdString();
-                std::string indentStd = indentType.toStdString();
-
-                // Call returns JSON string to avoid embind property access issues
-                std::string jsonResultStr = jsonBridge.call<std::string>("formatJson", inputStd, indentStd);
-
-                // Parse the JSON response
-                QJsonDocument doc = QJsonDocument::fromJson(QString::fromStdString(jsonResultStr).toUtf8());
-                if (doc.isNull() || !doc.isObject()) {
-                    result["error"] = "Failed to parse formatJson response";
-                } else {
-                    QJsonObject obj = doc.object();
-                    bool success = obj["success"].toBool();
-                    result["success"] = success;
-
-                    if (success) {
-                        result["result"] = obj["result"].toString();
-                    } else {
-                        result["error"] = obj["error"].toString();
-                    }
+                waitForEngine(jsonBridge);
+                AIRGAP_TRACE_ZONE("JsonBridge formatJsonUtf8");
+                val reply = jsonBridge.call<val>("formatJsonUtf8", utf8View(utf8),
+                                                 val(indentType.toStdString()));
+                readResultEnvelope(reply, result, "formatJson");
+                if (result["success"].toBool()) {
+                    const QString formatted = result["result"].toString();
+                    m_documentCache->insert(key, name, formatted, stringCost(formatted));
                 }
             }
         } catch (const std::exception &e) {
@@ -340,16 +981,6 @@ void JsonBridge::formatJson(const QString &input, const QString &indentType)
         } catch (...) {
             result["error"] = "Unknown error in formatJson";
         }
-#else
-        // Desktop native implementation
-        QString formatted = formatJsonNative(input, indentType);
-        if (formatted.isEmpty()) {
-            result["error"] = "Invalid JSON";
-        } else {
-            result["success"] = true;
-            result["result"] = formatted;
-        }
-#endif
 
         // Emit signal on main thread
         QMetaObject::invokeMethod(this, [this, result]() {
@@ -360,11 +991,50 @@ void JsonBridge::formatJson(const QString &input, const QString &indentType)
         promise.finish();
         return future;
     });
+#else
+    // Desktop native implementation; parsing and formatting run on a
+    // worker thread
+    auto job = std::make_shared<OutputJob>();
+    const QString name = DocumentCache::formattedName(indentType);
+    const std::shared_ptr<DocumentCache> cache = m_documentCache;
+
+    AsyncSerialiser::instance().enqueueWorker("formatJson", [job, cache, input, name, indentType]() {
+        AIRGAP_TRACE_ZONE("JsonBridge::formatJson");
+        return AsyncSerialiser::runOnWorker([job, cache, input, name, indentType]() -> QVariant {
+            AIRGAP_TRACE_ZONE("JsonBridge::formatJson worker");
+            job->encode(input);
+            job->output = cache->value(job->key, name).toString();
+            if (job->output.isNull())
+                job->lookUpDocument(*cache);
+
+            if (job->output.isNull() && !job->haveDocument) {
+                job->output = formatSlicedNative(job->utf8, JsonWriter::Indent::fromString(indentType));
+                job->computed = !job->output.isNull();
+            }
+            if (job->output.isNull() && job->parse()) {
+                job->output = formatDocumentNative(job->doc, indentType, job->utf8.size());
+                job->computed = true;
+            }
+            return QVariant();
+        });
+    }, [this, job, name](const QVariant &) {
+        AsyncSerialiser::instance().setCurrentTaskPayload(job->utf8.size());
+        const QVariantMap result = outputResult(*m_documentCache, *job, name);
+        rememberOutput(job->output, DocumentCache::derivedKey(job->key, name));
+
+        // Emit signal on main thread
+        QMetaObject::invokeMethod(this, [this, result]() {
+            emit formatCompleted(result);
+        }, Qt::QueuedConnection);
+    });
+#endif
 }
 
 void JsonBridge::minifyJson(const QString &input)
 {
+#ifdef __EMSCRIPTEN__
     AsyncSerialiser::instance().enqueue("minifyJson", [this, input]() {
+        AIRGAP_TRACE_ZONE("JsonBridge::minifyJson");
         QPromise<QVariant> promise;
         auto future = promise.future();
         promise.start();
@@ -372,33 +1042,28 @@ void JsonBridge::minifyJson(const QString &input)
         QVariantMap result;
         result["success"] = false;
 
-#ifdef __EMSCRIPTEN__
         try {
             val window = val::global("window");
             val jsonBridge = window["JsonBridge"];
 
-            if (jsonBridge.isUndefined() || jsonBridge.isNull()) {
+            const QByteArray utf8 = input.toUtf8();
+            AsyncSerialiser::instance().setCurrentTaskPayload(utf8.size());
+            const DocumentCache::Key key = DocumentCache::keyFor(utf8);
+            const QVariant cached = m_documentCache->value(key, DocumentCache::Minified);
+
+            if (cached.isValid()) {
+                result["success"] = true;
+                result["result"] = cached;
+            } else if (jsonBridge.isUndefined() || jsonBridge.isNull()) {
                 result["error"] = "JsonBridge not available";
             } else {
-                std::string inputStd = input.toStdString();
-
-                // Call returns JSON string to avoid embind property access issues
-                std::string jsonResultStr = jsonBridge.call<std::string>("minifyJson", inputStd);
-
-                // Parse the JSON response
-                QJsonDocument doc = QJsonDocument::fromJson(QString::fromStdString(jsonResultStr).toUtf8());
-                if (doc.isNull() || !doc.isObject()) {
-                    result["error"] = "Failed to parse minifyJson response";
-                } else {
-                    QJsonObject obj = doc.object();
-                    bool success = obj["success"].toBool();
-                    result["success"] = success;
-
-                    if (success) {
-                        result["result"] = obj["result"].toString();
-                    } else {
-                        result["error"] = obj["error"].toString();
-                    }
+                waitForEngine(jsonBridge);
+                AIRGAP_TRACE_ZONE("JsonBridge minifyJsonUtf8");
+                val reply = jsonBridge.call<val>("minifyJsonUtf8", utf8View(utf8));
+                readResultEnvelope(reply, result, "minifyJson");
+                if (result["success"].toBool()) {
+                    const QString minified = result["result"].toString();
+                    m_documentCache->insert(key, DocumentCache::Minified, minified, stringCost(minified));
                 }
             }
         } catch (const std::exception &e) {
@@ -406,16 +1071,6 @@ void JsonBridge::minifyJson(const QString &input)
         } catch (...) {
             result["error"] = "Unknown error in minifyJson";
         }
-#else
-        // Desktop native implementation
-        QString minified = minifyJsonNative(input);
-        if (minified.isEmpty()) {
-            result["error"] = "Invalid JSON";
-        } else {
-            result["success"] = true;
-            result["result"] = minified;
-        }
-#endif
 
         // Emit signal on main thread
         QMetaObject::invokeMethod(this, [this, result]() {
@@ -426,140 +1081,295 @@ void JsonBridge::minifyJson(const QString &input)
         promise.finish();
         return future;
     });
+#else
+    // Desktop native implementation; parsing and minifying run on a
+    // worker thread
+    auto job = std::make_shared<OutputJob>();
+    const std::shared_ptr<DocumentCache> cache = m_documentCache;
+
+    AsyncSerialiser::instance().enqueueWorker("minifyJson", [job, cache, input]() {
+        AIRGAP_TRACE_ZONE("JsonBridge::minifyJson");
+        return AsyncSerialiser::runOnWorker([job, cache, input]() -> QVariant {
+            AIRGAP_TRACE_ZONE("JsonBridge::minifyJson worker");
+            job->encode(input);
+            job->output = cache->value(job->key, DocumentCache::Minified).toString();
+            if (job->output.isNull())
+                job->lookUpDocument(*cache);
+
+            if (job->output.isNull() && !job->haveDocument) {
+                job->output = formatSlicedNative(job->utf8, JsonWriter::Indent::minified());
+                job->computed = !job->output.isNull();
+            }
+            if (job->output.isNull() && job->parse()) {
+                job->output = minifyDocumentNative(job->doc, job->utf8.size());
+                job->computed = true;
+            }
+            return QVariant();
+        });
+    }, [this, job](const QVariant &) {
+        AsyncSerialiser::instance().setCurrentTaskPayload(job->utf8.size());
+        const QVariantMap result = outputResult(*m_documentCache, *job, DocumentCache::Minified);
+        rememberOutput(job->output, DocumentCache::derivedKey(job->key, DocumentCache::Minified));
+
+        // Emit signal on main thread
+        QMetaObject::invokeMethod(this, [this, result]() {
+            emit minifyCompleted(result);
+        }, Qt::QueuedConnection);
+    });
+#endif
 }
 
 void JsonBridge::validateJson(const QString &input)
 {
-    AsyncSerialiser::instance().enqueue("validateJson", [this, input]() {
+    // Validation runs on every debounced keystroke; only the latest input
+    // matters, so pending validations coalesce into the newest one. The
+    // indexer runs on a worker thread where there is one, and rescans only
+    // the edited part of the previous input.
+    struct ValidationJob {
+        QByteArray utf8;
+        DocumentCache::Key key {};
+        QVariant cached;
+        std::shared_ptr<JsonIncrementalIndexer> indexer;
+    };
+    auto job = std::make_shared<ValidationJob>();
+    const std::shared_ptr<DocumentCache> cache = m_documentCache;
+
+    AsyncSerialiser::instance().enqueueWorker("validateJson", "validate", [this, job, cache, input]() {
+        AIRGAP_TRACE_ZONE("JsonBridge::validateJson");
+        // The job holds the indexer until it delivers. A validation dropped
+        // by clearQueue() may still be running with it, so the next one
+        // starts from a fresh indexer rather than share it.
+        job->indexer = std::move(m_validationIndexer);
+        if (!job->indexer)
+            job->indexer = std::make_shared<JsonIncrementalIndexer>(ValidationRequiresContainer);
+        return AsyncSerialiser::runOnWorker([job, cache, input]() -> QVariant {
+            AIRGAP_TRACE_ZONE("JsonBridge::validateJson worker");
+            // Unchanged input re-validates from the cache
+            job->utf8 = input.toUtf8();
+            job->key = DocumentCache::keyFor(job->utf8);
+            job->cached = cache->value(job->key, DocumentCache::Validation);
+            if (job->cached.isValid())
+                return job->cached;
+            return indexValidation(job->indexer->validate(job->utf8));
+        });
+    }, [this, job](const QVariant &value) {
+        m_validationIndexer = std::move(job->indexer);
+        AsyncSerialiser::instance().setCurrentTaskPayload(job->utf8.size());
+        const QVariantMap result = value.toMap();
+        if (!job->cached.isValid())
+            m_documentCache->insert(job->key, DocumentCache::Validation, result, ValidationCost);
+
+        // Emit signal on main thread, unless a newer validation made it stale
+        if (!AsyncSerialiser::instance().isCurrentTaskSuperseded()) {
+            QMetaObject::invokeMethod(this, [this, result]() {
+                emit validateCompleted(result);
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void JsonBridge::processJson(const QString &input, const QVariantMap &options)
+{
+    // Parses the input once and produces every requested output from it,
+    // instead of one parse each for validate, format, minify and the tree
+    const bool wantFormat = options.value("format").toBool();
+    const bool wantMinify = options.value("minify").toBool();
+    const bool wantStats = options.value("stats").toBool();
+    const bool wantTree = options.value("tree").toBool();
+    const QString indentType = options.value("indentType", "spaces:4").toString();
+    const QString formattedName = DocumentCache::formattedName(indentType);
+
+#ifdef __EMSCRIPTEN__
+    AsyncSerialiser::instance().enqueue("processJson", [this, input, options, wantFormat, wantMinify, wantStats,
+                                                         wantTree, indentType, formattedName]() {
+        AIRGAP_TRACE_ZONE("JsonBridge::processJson");
         QPromise<QVariant> promise;
         auto future = promise.future();
         promise.start();
 
         QVariantMap result;
-        result["isValid"] = false;
+        result["success"] = false;
+        result["tree"] = false;
+        result["options"] = options;
+
+        QVariantMap validation;
+        validation["isValid"] = false;
+        validation["stats"] = QVariantMap();
+
+        // Outputs of an earlier run on the same input come from the cache
+        const QByteArray utf8 = input.toUtf8();
+        AsyncSerialiser::instance().setCurrentTaskPayload(utf8.size());
+        const DocumentCache::Key key = DocumentCache::keyFor(utf8);
 
-#ifdef __EMSCRIPTEN__
         try {
             val window = val::global("window");
             val jsonBridge = window["JsonBridge"];
 
-            if (jsonBridge.isUndefined() || jsonBridge.isNull()) {
-                QVariantMap error;
-                error["message"] = "JsonBridge not available";
-                error["line"] = 0;
-                error["column"] = 0;
-                result["error"] = error;
-                result["stats"] = QVariantMap();
+            const QVariant cachedValidation = m_documentCache->value(key, DocumentCache::Validation);
+            QString formatted = wantFormat ? m_documentCache->value(key, formattedName).toString() : QString();
+            QString minified = wantMinify ? m_documentCache->value(key, DocumentCache::Minified).toString() : QString();
+
+            // Output flags match OUTPUT_* in src/processor.rs; only outputs
+            // missing from the cache are requested
+            int outputs = 0;
+            if (wantFormat && formatted.isNull()) outputs |= 1;
+            if (wantMinify && minified.isNull()) outputs |= 2;
+            if (wantStats && !cachedValidation.isValid()) outputs |= 4;
+
+            // Invalid input needs no outputs; its error is cached as well
+            if (cachedValidation.isValid()
+                && (outputs == 0 || !cachedValidation.toMap().value("isValid").toBool())) {
+                validation = cachedValidation.toMap();
+            } else if (jsonBridge.isUndefined() || jsonBridge.isNull()) {
+                validation["error"] = makeValidationError("JsonBridge not available");
             } else {
-                std::string inputStd = input.toStdString();
-
-                // Call returns JSON string to avoid embind property access issues
-                std::string jsonResultStr = jsonBridge.call<std::string>("validateJson", inputStd);
-
-                // Parse the JSON response
-                QJsonDocument doc = QJsonDocument::fromJson(QString::fromStdString(jsonResultStr).toUtf8());
-                if (doc.isNull() || !doc.isObject()) {
-                    QVariantMap error;
-                    error["message"] = "Failed to parse validateJson response";
-                    error["line"] = 0;
-                    error["column"] = 0;
-                    result["error"] = error;
-                    result["stats"] = QVariantMap();
+                waitForEngine(jsonBridge);
+                AIRGAP_TRACE_ZONE("JsonBridge processJsonUtf8");
+                val reply = jsonBridge.call<val>("processJsonUtf8", utf8View(utf8),
+                                                 val(indentType.toStdString()), val(outputs));
+                if (reply.isUndefined() || reply.isNull()) {
+                    validation["error"] = makeValidationError("processJson returned no result");
                 } else {
-                    QJsonObject obj = doc.object();
-                    bool isValid = obj["isValid"].toBool();
-                    result["isValid"] = isValid;
-
-                    if (isValid) {
-                        QVariantMap stats;
-                        QJsonObject jsStats = obj["stats"].toObject();
-                        stats["object_count"] = jsStats["objectCount"].toInt(0);
-                        stats["array_count"] = jsStats["arrayCount"].toInt(0);
-                        stats["string_count"] = jsStats["stringCount"].toInt(0);
-                        stats["number_count"] = jsStats["numberCount"].toInt(0);
-                        stats["boolean_count"] = jsStats["booleanCount"].toInt(0);
-                        stats["null_count"] = jsStats["nullCount"].toInt(0);
-                        stats["total_keys"] = jsStats["totalKeys"].toInt(0);
-                        stats["max_depth"] = jsStats["maxDepth"].toInt(0);
-                        result["stats"] = stats;
-                    } else {
-                        QJsonObject jsError = obj["error"].toObject();
-                        QVariantMap error;
-                        error["message"] = jsError["message"].toString("Unknown error");
-                        error["line"] = jsError["line"].toInt(0);
-                        error["column"] = jsError["column"].toInt(0);
-                        result["error"] = error;
-                        result["stats"] = QVariantMap();
+                    readValidation(reply["validation"], validation);
+                    const bool valid = validation.value("isValid").toBool();
+                    if ((outputs & 4) || !valid)
+                        m_documentCache->insert(key, DocumentCache::Validation, validation, ValidationCost);
+                    if (valid && (outputs & 1) && isUtf8Array(reply["formatted"])) {
+                        formatted = fromUtf8Array(reply["formatted"]);
+                        m_documentCache->insert(key, formattedName, formatted, stringCost(formatted));
+                    }
+                    if (valid && (outputs & 2) && isUtf8Array(reply["minified"])) {
+                        minified = fromUtf8Array(reply["minified"]);
+                        m_documentCache->insert(key, DocumentCache::Minified, minified, stringCost(minified));
                     }
                 }
             }
+
+            if (validation.value("isValid").toBool()) {
+                result["success"] = true;
+                if (wantFormat)
+                    result["formatted"] = formatted;
+                if (wantMinify)
+                    result["minified"] = minified;
+                // The tree model needs a Qt document. It is built after
+                // this task, like loadTreeModel(), and reported through
+                // treeLoaded instead of result["tree"].
+                if (wantTree)
+                    result["treePending"] = true;
+            }
         } catch (const std::exception &e) {
-            QVariantMap error;
-            error["message"] = QString("Exception: %1").arg(e.what());
-            error["line"] = 0;
-            error["column"] = 0;
-            result["error"] = error;
-            result["stats"] = QVariantMap();
+            validation["error"] = makeValidationError(QString("Exception: %1").arg(e.what()));
         } catch (...) {
-            QVariantMap error;
-            error["message"] = "Unknown error in validateJson";
-            error["line"] = 0;
-            error["column"] = 0;
-            result["error"] = error;
-            result["stats"] = QVariantMap();
+            validation["error"] = makeValidationError("Unknown error in processJson");
         }
+
+        result["validation"] = validation;
+        if (!result["success"].toBool())
+            result["error"] = validation.value("error").toMap().value("message").toString();
+
+        // Emit signal on main thread
+        const bool treePending = result.value("treePending").toBool();
+        QMetaObject::invokeMethod(this, [this, result, treePending, input]() {
+            emit processCompleted(result);
+            if (treePending)
+                loadTreeModel(input);
+        }, Qt::QueuedConnection);
+
+        promise.addResult(QVariant::fromValue(result));
+        promise.finish();
+        return future;
+    });
 #else
-        // Desktop native implementation
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(input.toUtf8(), &parseError);
-
-        if (parseError.error != QJsonParseError::NoError) {
-            QVariantMap error;
-            error["message"] = parseError.errorString();
-            // Calculate line and column from offset
-            int line = 1, column = 1;
-            for (int i = 0; i < parseError.offset && i < input.length(); ++i) {
-                if (input[i] == '\n') {
-                    line++;
-                    column = 1;
-                } else {
-                    column++;
-                }
+    // Desktop native implementation; the parse, every output and the tree
+    // store are built on a worker thread, and the store is swapped into the
+    // tree model on delivery
+    auto job = std::make_shared<ProcessJob>();
+    const std::shared_ptr<DocumentCache> cache = m_documentCache;
+
+    AsyncSerialiser::instance().enqueueWorker("processJson", [job, cache, input, wantFormat, wantMinify, wantStats,
+                                                               wantTree, indentType, formattedName]() {
+        AIRGAP_TRACE_ZONE("JsonBridge::processJson");
+        return AsyncSerialiser::runOnWorker([job, cache, input, wantFormat, wantMinify, wantStats, wantTree,
+                                             indentType, formattedName]() -> QVariant {
+            AIRGAP_TRACE_ZONE("JsonBridge::processJson worker");
+            // Outputs of an earlier run on the same input come from the cache
+            job->encode(input);
+            job->lookUpDocument(*cache);
+            if (wantStats)
+                job->validation = cache->value(job->key, DocumentCache::Validation).toMap();
+            if (wantFormat)
+                job->formatted = cache->value(job->key, formattedName).toString();
+            if (wantMinify)
+                job->minified = cache->value(job->key, DocumentCache::Minified).toString();
+
+            if (!job->parse()) {
+                job->error = parseFailureMap(job->utf8, job->parseError);
+                return QVariant();
+            }
+            if (wantStats && job->validation.isEmpty()) {
+                job->validation["isValid"] = true;
+                job->validation["stats"] = documentStats(job->doc);
+                job->validationComputed = true;
+            }
+            if (wantFormat && job->formatted.isNull()) {
+                job->formatted = formatDocumentNative(job->doc, indentType, job->utf8.size());
+                job->formattedComputed = true;
             }
-            error["line"] = line;
-            error["column"] = column;
-            result["error"] = error;
-            result["stats"] = QVariantMap();
+            if (wantMinify && job->minified.isNull()) {
+                job->minified = minifyDocumentNative(job->doc, job->utf8.size());
+                job->minifiedComputed = true;
+            }
+            if (wantTree)
+                job->tree = QJsonTreeModel::buildStore(job->doc);
+            return QVariant();
+        });
+    }, [this, job, options, wantFormat, wantMinify, wantStats, wantTree, formattedName](const QVariant &) {
+        AsyncSerialiser::instance().setCurrentTaskPayload(job->utf8.size());
+        QVariantMap result;
+        result["success"] = false;
+        result["tree"] = false;
+        result["options"] = options;
+
+        QVariantMap validation;
+        validation["isValid"] = false;
+        validation["stats"] = QVariantMap();
+
+        job->storeDocument(*m_documentCache);
+        if (!job->haveDocument) {
+            validation["error"] = job->error;
         } else {
-            result["isValid"] = true;
-            QVariantMap stats;
-            stats["object_count"] = 0;
-            stats["array_count"] = 0;
-            stats["string_count"] = 0;
-            stats["number_count"] = 0;
-            stats["boolean_count"] = 0;
-            stats["null_count"] = 0;
-            stats["total_keys"] = 0;
-            stats["max_depth"] = 0;
-
-            if (doc.isObject()) {
-                countJsonStats(doc.object(), stats, 1);
-            } else if (doc.isArray()) {
-                countJsonStats(doc.array(), stats, 1);
+            validation["isValid"] = true;
+            if (wantStats) {
+                validation = job->validation;
+                if (job->validationComputed)
+                    m_documentCache->insert(job->key, DocumentCache::Validation, validation, ValidationCost);
             }
-            result["stats"] = stats;
+            result["success"] = true;
+            if (wantFormat) {
+                if (job->formattedComputed)
+                    m_documentCache->insert(job->key, formattedName, job->formatted, stringCost(job->formatted));
+                result["formatted"] = job->formatted;
+            }
+            if (wantMinify) {
+                if (job->minifiedComputed)
+                    m_documentCache->insert(job->key, DocumentCache::Minified, job->minified,
+                                           stringCost(job->minified));
+                result["minified"] = job->minified;
+            }
+            if (wantTree)
+                result["tree"] = m_treeModel->applyBuildResult(std::move(job->tree));
         }
-#endif
+
+        result["validation"] = validation;
+        if (!result["success"].toBool())
+            result["error"] = validation.value("error").toMap().value("message").toString();
 
         // Emit signal on main thread
         QMetaObject::invokeMethod(this, [this, result]() {
-            emit validateCompleted(result);
+            emit processCompleted(result);
         }, Qt::QueuedConnection);
-
-        promise.addResult(QVariant::fromValue(result));
-        promise.finish();
-        return future;
     });
+#endif
 }
 
 QString JsonBridge::highlightJson(const QString &input)
@@ -578,9 +1388,15 @@ QString JsonBridge::highlightJson(const QString &input)
             return escaped;
         }
 
-        std::string inputStd = input.toStdString();
-        std::string result = jsonBridge.call<std::string>("highlightJson", inputStd);
-        return QString::fromStdString(result);
+        const QByteArray utf8 = input.toUtf8();
+
+        AIRGAP_TRACE_ZONE("JsonBridge highlightJsonUtf8");
+        // Returns highlighted UTF-8 bytes, or escaped text as a string
+        val reply = jsonBridge.call<val>("highlightJsonUtf8", utf8View(utf8));
+        if (isUtf8Array(reply)) {
+            return fromUtf8Array(reply);
+        }
+        return QString::fromStdString(reply.as<std::string>());
     } catch (const std::exception &e) {
         qWarning() << "highlightJson error:" << e.what();
     } catch (...) {
@@ -594,13 +1410,14 @@ QString JsonBridge::highlightJson(const QString &input)
     return escaped;
 #else
     // Desktop native implementation
-    return highlightJsonNative(input);
+    AIRGAP_TRACE_ZONE("JsonBridge::highlightJson");
+    return JsonHighlighter::highlightDocument(input);
 #endif
 }
 
 void JsonBridge::copyToClipboard(const QString &text)
 {
-    AsyncSerialiser::instance().enqueue("copyToClipboard", [this, text]() {
+    AsyncSerialiser::instance().enqueue("copyToClipboard", AsyncSerialiser::Priority::Interactive, [this, text]() {
         QPromise<QVariant> promise;
         auto future = promise.future();
         promise.start();
@@ -642,7 +1459,7 @@ void JsonBridge::copyToClipboard(const QString &text)
 
 void JsonBridge::readFromClipboard()
 {
-    AsyncSerialiser::instance().enqueue("readFromClipboard", [this]() {
+    AsyncSerialiser::instance().enqueue("readFromClipboard", AsyncSerialiser::Priority::Interactive, [this]() {
         QPromise<QVariant> promise;
         auto future = promise.future();
         promise.start();
@@ -692,7 +1509,7 @@ void JsonBridge::readFromClipboard()
 
 void JsonBridge::saveToHistory(const QString &json)
 {
-    AsyncSerialiser::instance().enqueue("saveToHistory", [this, json]() {
+    AsyncSerialiser::instance().enqueue("saveToHistory", AsyncSerialiser::Priority::Background, [this, json]() {
         QPromise<QVariant> promise;
         auto future = promise.future();
         promise.start();
@@ -711,11 +1528,8 @@ void JsonBridge::saveToHistory(const QString &json)
                 val result = jsPromise.await();
 
                 if (!result.isUndefined() && !result.isNull()) {
-                    std::string resultStr = result.as<std::string>();
-                    QJsonDocument doc = QJsonDocument::fromJson(QString::fromStdString(resultStr).toUtf8());
-                    QJsonObject obj = doc.object();
-                    success = obj["success"].toBool();
-                    id = obj["id"].toString();
+                    success = result["success"].isTrue();
+                    id = stringField(result, "id");
                 }
             }
         } catch (const std::exception &e) {
@@ -724,29 +1538,11 @@ void JsonBridge::saveToHistory(const QString &json)
             qWarning() << "Failed to save to history";
         }
 #else
-        // Desktop native implementation
-        QJsonArray history = loadHistoryFromFile();
-
-        id = QUuid::createUuid().toString(QUuid::WithoutBraces);
-        QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
-        QString preview = json.left(100).simplified();
-        if (json.length() > 100) preview += "...";
-
-        QJsonObject entry;
-        entry["id"] = id;
-        entry["content"] = json;
-        entry["timestamp"] = timestamp;
-        entry["preview"] = preview;
-        entry["size"] = json.size();
-
-        // Add to beginning of array (most recent first)
-        QJsonArray newHistory;
-        newHistory.append(entry);
-        for (int i = 0; i < history.size() && i < 49; ++i) { // Keep max 50 entries
-            newHistory.append(history[i]);
-        }
-
-        success = saveHistoryToFile(newHistory);
+        // Desktop native implementation: writes the new entry's file and
+        // appends one index record
+        id = historyStore().add(json);
+        success = !id.isEmpty();
+        scheduleHistoryCompaction();
 #endif
 
         // Emit signal on main thread
@@ -762,7 +1558,7 @@ void JsonBridge::saveToHistory(const QString &json)
 
 void JsonBridge::loadHistory()
 {
-    AsyncSerialiser::instance().enqueue("loadHistory", [this]() {
+    AsyncSerialiser::instance().enqueue("loadHistory", AsyncSerialiser::Priority::Background, [this]() {
         QPromise<QVariant> promise;
         auto future = promise.future();
         promise.start();
@@ -778,25 +1574,8 @@ void JsonBridge::loadHistory()
                 val jsPromise = jsonBridge.call<val>("loadHistory");
                 val result = jsPromise.await();
 
-                if (!result.isUndefined() && !result.isNull()) {
-                    std::string resultStr = result.as<std::string>();
-                    QJsonDocument doc = QJsonDocument::fromJson(QString::fromStdString(resultStr).toUtf8());
-                    QJsonObject obj = doc.object();
-
-                    if (obj["success"].toBool()) {
-                        QJsonArray entriesArray = obj["entries"].toArray();
-                        for (const QJsonValue &v : entriesArray) {
-                            QJsonObject entry = v.toObject();
-                            QVariantMap entryMap;
-                            entryMap["id"] = entry["id"].toString();
-                            entryMap["content"] = entry["content"].toString();
-                            entryMap["timestamp"] = entry["timestamp"].toString();
-                            entryMap["preview"] = entry["preview"].toString();
-                            entryMap["size"] = entry["size"].toInt();
-                            entries.append(entryMap);
-                        }
-                    }
-                }
+                if (!result.isUndefined() && !result.isNull() && result["success"].isTrue())
+                    entries = historyEntryList(result);
             }
         } catch (const std::exception &e) {
             qWarning() << "Failed to load history:" << e.what();
@@ -804,16 +1583,15 @@ void JsonBridge::loadHistory()
             qWarning() << "Failed to load history";
         }
 #else
-        // Desktop native implementation
-        QJsonArray history = loadHistoryFromFile();
-        for (const QJsonValue &v : history) {
-            QJsonObject entry = v.toObject();
+        // Desktop native implementation: listing reads only the index; the
+        // content is fetched with getHistoryEntry when an entry is opened
+        const QVector<HistoryStore::Entry> history = historyStore().entries();
+        for (const HistoryStore::Entry &entry : history) {
             QVariantMap entryMap;
-            entryMap["id"] = entry["id"].toString();
-            entryMap["content"] = entry["content"].toString();
-            entryMap["timestamp"] = entry["timestamp"].toString();
-            entryMap["preview"] = entry["preview"].toString();
-            entryMap["size"] = entry["size"].toInt();
+            entryMap["id"] = entry.id;
+            entryMap["timestamp"] = entry.timestamp;
+            entryMap["preview"] = entry.preview;
+            entryMap["size"] = entry.size;
             entries.append(entryMap);
         }
 #endif
@@ -829,9 +1607,64 @@ void JsonBridge::loadHistory()
     });
 }
 
+void JsonBridge::loadHistoryPage(int offset, int limit, const QString &query)
+{
+    // A newer page request replaces a pending one
+    AsyncSerialiser::instance().enqueue("loadHistoryPage", QStringLiteral("historyPage"),
+                                        [this, offset, limit, query]() {
+        QPromise<QVariant> promise;
+        auto future = promise.future();
+        promise.start();
+
+        QVariantList entries;
+        int total = 0;
+
+#ifdef __EMSCRIPTEN__
+        try {
+            val window = val::global("window");
+            val jsonBridge = window["JsonBridge"];
+
+            if (!jsonBridge.isUndefined() && !jsonBridge.isNull()) {
+                val jsPromise = jsonBridge.call<val>("loadHistoryPage", offset, limit, query.toStdString());
+                val result = jsPromise.await();
+
+                if (!result.isUndefined() && !result.isNull() && result["success"].isTrue()) {
+                    total = intField(result, "total");
+                    entries = historyEntryList(result);
+                }
+            }
+        } catch (const std::exception &e) {
+            qWarning() << "Failed to load history page:" << e.what();
+        } catch (...) {
+            qWarning() << "Failed to load history page";
+        }
+#else
+        // Desktop native implementation: served from the in-memory index
+        const QVector<HistoryStore::Entry> page = historyStore().page(offset, limit, query, &total);
+        for (const HistoryStore::Entry &entry : page) {
+            QVariantMap entryMap;
+            entryMap["id"] = entry.id;
+            entryMap["timestamp"] = entry.timestamp;
+            entryMap["preview"] = entry.preview;
+            entryMap["size"] = entry.size;
+            entries.append(entryMap);
+        }
+#endif
+
+        // Emit signal on main thread
+        QMetaObject::invokeMethod(this, [this, query, offset, entries, total]() {
+            emit historyPageLoaded(query, offset, entries, total);
+        }, Qt::QueuedConnection);
+
+        promise.addResult(QVariant::fromValue(entries));
+        promise.finish();
+        return future;
+    }, AsyncSerialiser::Priority::Background);
+}
+
 void JsonBridge::getHistoryEntry(const QString &id)
 {
-    AsyncSerialiser::instance().enqueue("getHistoryEntry", [this, id]() {
+    AsyncSerialiser::instance().enqueue("getHistoryEntry", AsyncSerialiser::Priority::Interactive, [this, id]() {
         QPromise<QVariant> promise;
         auto future = promise.future();
         promise.start();
@@ -848,16 +1681,9 @@ void JsonBridge::getHistoryEntry(const QString &id)
                 val jsPromise = jsonBridge.call<val>("getHistoryEntry", idStd);
                 val result = jsPromise.await();
 
-                if (!result.isUndefined() && !result.isNull()) {
-                    std::string resultStr = result.as<std::string>();
-                    QJsonDocument doc = QJsonDocument::fromJson(QString::fromStdString(resultStr).toUtf8());
-                    QJsonObject obj = doc.object();
-
-                    if (obj["success"].toBool()) {
-                        QJsonObject entry = obj["entry"].toObject();
-                        content = entry["content"].toString();
-                    }
-                }
+                // The content arrives as a JS string; it is converted once
+                if (!result.isUndefined() && !result.isNull() && result["success"].isTrue())
+                    content = stringField(result["entry"], "content");
             }
         } catch (const std::exception &e) {
             qWarning() << "Failed to get history entry:" << e.what();
@@ -866,14 +1692,7 @@ void JsonBridge::getHistoryEntry(const QString &id)
         }
 #else
         // Desktop native implementation
-        QJsonArray history = loadHistoryFromFile();
-        for (const QJsonValue &v : history) {
-            QJsonObject entry = v.toObject();
-            if (entry["id"].toString() == id) {
-                content = entry["content"].toString();
-                break;
-            }
-        }
+        content = historyStore().content(id);
 #endif
 
         // Emit signal on main thread
@@ -906,12 +1725,8 @@ void JsonBridge::deleteHistoryEntry(const QString &id)
                 val jsPromise = jsonBridge.call<val>("deleteHistoryEntry", idStd);
                 val result = jsPromise.await();
 
-                if (!result.isUndefined() && !result.isNull()) {
-                    std::string resultStr = result.as<std::string>();
-                    QJsonDocument doc = QJsonDocument::fromJson(QString::fromStdString(resultStr).toUtf8());
-                    QJsonObject obj = doc.object();
-                    success = obj["success"].toBool();
-                }
+                if (!result.isUndefined() && !result.isNull())
+                    success = result["success"].isTrue();
             }
         } catch (const std::exception &e) {
             qWarning() << "Failed to delete history entry:" << e.what();
@@ -919,21 +1734,10 @@ void JsonBridge::deleteHistoryEntry(const QString &id)
             qWarning() << "Failed to delete history entry";
         }
 #else
-        // Desktop native implementation
-        QJsonArray history = loadHistoryFromFile();
-        QJsonArray newHistory;
-        bool found = false;
-        for (const QJsonValue &v : history) {
-            QJsonObject entry = v.toObject();
-            if (entry["id"].toString() != id) {
-                newHistory.append(entry);
-            } else {
-                found = true;
-            }
-        }
-        if (found) {
-            success = saveHistoryToFile(newHistory);
-        }
+        // Desktop native implementation: appends a tombstone; the entry
+        // file is removed when the index is compacted
+        success = historyStore().remove(id);
+        scheduleHistoryCompaction();
 #endif
 
         // Emit signal on main thread
@@ -965,12 +1769,8 @@ void JsonBridge::clearHistory()
                 val jsPromise = jsonBridge.call<val>("clearHistory");
                 val result = jsPromise.await();
 
-                if (!result.isUndefined() && !result.isNull()) {
-                    std::string resultStr = result.as<std::string>();
-                    QJsonDocument doc = QJsonDocument::fromJson(QString::fromStdString(resultStr).toUtf8());
-                    QJsonObject obj = doc.object();
-                    success = obj["success"].toBool();
-                }
+                if (!result.isUndefined() && !result.isNull())
+                    success = result["success"].isTrue();
             }
         } catch (const std::exception &e) {
             qWarning() << "Failed to clear history:" << e.what();
@@ -979,7 +1779,7 @@ void JsonBridge::clearHistory()
         }
 #else
         // Desktop native implementation
-        success = saveHistoryToFile(QJsonArray());
+        success = historyStore().clear();
 #endif
 
         // Emit signal on main thread
@@ -5,6 +5,14 @@
 #include <QString>
 #include <QVariantMap>
 #include "qjsontreemodel.h"
+#include "jsonlinemodel.h"
+#include "historylistmodel.h"
+#include "documentcache.h"
+#include "jsonindexer.h"
+#include <memory>
+
+class QFutureWatcherBase;
+struct OpenedFile;
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -16,23 +24,60 @@ class JsonBridge : public QObject
     Q_OBJECT
     Q_PROPERTY(bool ready READ isReady NOTIFY readyChanged)
     Q_PROPERTY(QJsonTreeModel* treeModel READ treeModel CONSTANT)
+    Q_PROPERTY(JsonLineModel* outputModel READ outputModel CONSTANT)
+    Q_PROPERTY(HistoryListModel* historyModel READ historyModel CONSTANT)
     Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+    Q_PROPERTY(qint64 cacheBudget READ cacheBudget WRITE setCacheBudget NOTIFY cacheBudgetChanged)
 
 public:
     explicit JsonBridge(QObject *parent = nullptr);
+    ~JsonBridge() override;
 
     bool isReady() const;
     QJsonTreeModel* treeModel() const;
+    JsonLineModel* outputModel() const;
+    HistoryListModel* historyModel() const;
     bool isBusy() const;
 
+    // Parsed-document cache: memory budget in bytes and hit/miss counters
+    qint64 cacheBudget() const;
+    void setCacheBudget(qint64 bytes);
+    Q_INVOKABLE QVariantMap cacheStats() const;
+    Q_INVOKABLE void clearCache();
+
+    // AsyncSerialiser per-task timings and counters, and the same tasks as
+    // a Chrome trace file
+    Q_INVOKABLE QVariantMap taskMetrics() const;
+    Q_INVOKABLE bool exportTaskTrace(const QString &path) const;
+
     // Async operations (fire-and-forget, results via signals)
     Q_INVOKABLE void formatJson(const QString &input, const QString &indentType);
     Q_INVOKABLE void minifyJson(const QString &input);
     Q_INVOKABLE void validateJson(const QString &input);
 
+    // Single parse, multiple outputs. Options: format, minify, stats and
+    // tree (bools) plus indentType; result via processCompleted
+    Q_INVOKABLE void processJson(const QString &input, const QVariantMap &options);
+
     // Synchronous operations
     Q_INVOKABLE QString highlightJson(const QString &input);
-    Q_INVOKABLE bool loadTreeModel(const QString &json);
+
+    // Tree model loading (built off the GUI thread, result via treeLoaded)
+    Q_INVOKABLE void loadTreeModel(const QString &json);
+    Q_INVOKABLE void cancelTreeLoad();
+
+    // Streaming file-to-file formatting (desktop only). Runs in constant
+    // memory without building a document; paths may be file: URLs.
+    // Progress via fileFormatProgress, result via fileFormatCompleted.
+    Q_INVOKABLE void formatFile(const QString &inputPath, const QString &outputPath, const QString &indentType);
+    Q_INVOKABLE void minifyFile(const QString &inputPath, const QString &outputPath);
+    Q_INVOKABLE void cancelFileFormat();
+
+    // Opens a JSON file without passing its text through QML: desktop
+    // memory-maps path, the browser shows a file picker (path is ignored)
+    // and reads the file in slices. The document feeds the tree and output
+    // models directly; result via fileOpened.
+    Q_INVOKABLE void openFile(const QString &path, const QString &indentType);
 
     // Async clipboard operations (results via signals)
     Q_INVOKABLE void copyToClipboard(const QString &text);
@@ -41,6 +86,7 @@ public:
     // Async history methods (results via signals)
     Q_INVOKABLE void saveToHistory(const QString &json);
     Q_INVOKABLE void loadHistory();
+    Q_INVOKABLE void loadHistoryPage(int offset, int limit, const QString &query = QString());
     Q_INVOKABLE void getHistoryEntry(const QString &id);
     Q_INVOKABLE void deleteHistoryEntry(const QString &id);
     Q_INVOKABLE void clearHistory();
@@ -51,14 +97,25 @@ signals:
     void formatCompleted(const QVariantMap &result);
     void minifyCompleted(const QVariantMap &result);
     void validateCompleted(const QVariantMap &result);
+    void processCompleted(const QVariantMap &result);
 
     // History operations
     void historySaved(bool success, const QString &id);
     void historyLoaded(const QVariantList &entries);
+    void historyPageLoaded(const QString &query, int offset, const QVariantList &entries, int total);
     void historyEntryLoaded(const QString &content);
     void historyEntryDeleted(bool success);
     void historyCleared(bool success);
 
+    // Tree model operations
+    void treeLoadProgress(int percent);
+    void treeLoaded(bool success);
+
+    // File operations
+    void fileFormatProgress(int percent);
+    void fileFormatCompleted(const QVariantMap &result);
+    void fileOpened(const QVariantMap &result);
+
     // Clipboard operations
     void copyCompleted(bool success);
     void clipboardRead(const QString &content);
@@ -66,11 +123,33 @@ signals:
     // State signals
     void readyChanged();
     void busyChanged(bool busy);
+    void cacheBudgetChanged();
 
 private:
     bool m_ready = false;
     QJsonTreeModel* m_treeModel;
+    JsonLineModel* m_outputModel;
+    HistoryListModel* m_historyModel;
+    // Shared with worker jobs, which may outlive the bridge
+    std::shared_ptr<DocumentCache> m_documentCache;
+    // Lent to the running validation; see validateJson()
+    std::shared_ptr<JsonIncrementalIndexer> m_validationIndexer;
+    QFutureWatcherBase* m_fileWatcher = nullptr;
+    quint64 m_fileGeneration = 0;
+    quint64 m_openGeneration = 0;
+    // Last desktop format or minify output and its derived cache key
+    QString m_lastOutput;
+    DocumentCache::Key m_lastOutputKey {};
     void checkReady();
+    void rememberOutput(const QString &output, const DocumentCache::Key &key);
+    void startFileFormat(const QString &inputPath, const QString &outputPath,
+                         const QString &indentType, bool minify);
+    QVariantMap showOpenedFile(OpenedFile &&file);
+#ifdef __EMSCRIPTEN__
+    static constexpr int ChosenFilePollMs = 100;
+    static constexpr int EngineReadyPollMs = 50;
+    void pollChosenFile(quint64 generation, const QString &indentType);
+#endif
     void connectAsyncSerialiserSignals();
 };
 
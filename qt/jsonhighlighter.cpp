@@ -0,0 +1,291 @@
+#include "jsonhighlighter.h"
+#include <QLatin1String>
+
+namespace {
+
+enum Token { TokenString, TokenKey, TokenNumber, TokenBoolean, TokenNull, TokenPunctuation, TokenCount };
+
+// Span prefixes per markup (jq-like palette), indexed by Token. Within a
+// table every prefix has the colour at the same offset, so a string's
+// colour can be patched in place once a following ':' shows it was a key.
+struct MarkupTable {
+    QLatin1String open[TokenCount];
+    QLatin1String close;
+    int colorOffset;
+};
+
+constexpr int kColorLength = 7;  // strlen("#rrggbb")
+
+constexpr MarkupTable kHtmlTable = {
+    {
+        QLatin1String("<span style=\"color:#a3be8c;\">"),  // Strings: green
+        QLatin1String("<span style=\"color:#8fa1b3;\">"),  // Keys: light blue
+        QLatin1String("<span style=\"color:#d08770;\">"),  // Numbers: orange
+        QLatin1String("<span style=\"color:#b48ead;\">"),  // Booleans: purple
+        QLatin1String("<span style=\"color:#bf616a;\">"),  // Null: red
+        QLatin1String("<span style=\"color:#c0c5ce;\">"),  // Punctuation: light gray
+    },
+    QLatin1String("</span>"),
+    19  // strlen("<span style=\"color:")
+};
+
+constexpr MarkupTable kStyledTable = {
+    {
+        QLatin1String("<font color=\"#a3be8c\">"),
+        QLatin1String("<font color=\"#8fa1b3\">"),
+        QLatin1String("<font color=\"#d08770\">"),
+        QLatin1String("<font color=\"#b48ead\">"),
+        QLatin1String("<font color=\"#bf616a\">"),
+        QLatin1String("<font color=\"#c0c5ce\">"),
+    },
+    QLatin1String("</font>"),
+    13  // strlen("<font color=\"")
+};
+
+constexpr QLatin1String kPreOpen("<pre style=\"margin:0; font-family:monospace; white-space:pre-wrap;\">");
+constexpr QLatin1String kPreClose("</pre>");
+
+// Characters that cannot be copied verbatim into the markup. StyledText
+// collapses whitespace, so spaces and tabs are written as &nbsp;.
+inline bool needsEscape(QChar c, bool styled)
+{
+    switch (c.unicode()) {
+        case u'<':
+        case u'>':
+        case u'&':
+            return true;
+        case u' ':
+        case u'\t':
+            return styled;
+        default:
+            return false;
+    }
+}
+
+inline void appendEscaped(QString& out, QChar c, bool styled)
+{
+    switch (c.unicode()) {
+        case u'<': out += QLatin1String("&lt;"); return;
+        case u'>': out += QLatin1String("&gt;"); return;
+        case u'&': out += QLatin1String("&amp;"); return;
+        case u' ':
+            if (styled) { out += QLatin1String("&nbsp;"); return; }
+            break;
+        case u'\t':
+            if (styled) { out += QLatin1String("&nbsp;&nbsp;&nbsp;&nbsp;"); return; }
+            break;
+        default:
+            break;
+    }
+    out += c;
+}
+
+inline bool matchesLiteral(const QChar* p, const QChar* end, QLatin1String literal)
+{
+    if (end - p < literal.size())
+        return false;
+    for (qsizetype k = 0; k < literal.size(); ++k) {
+        if (p[k].unicode() != static_cast<uchar>(literal.data()[k]))
+            return false;
+    }
+    return true;
+}
+
+inline bool isNumberChar(QChar c)
+{
+    return c.isDigit() || c == u'.' || c == u'-' || c == u'e' || c == u'E' || c == u'+';
+}
+
+// Whether rest continues the current string, if one is open, and then
+// reaches a ':' past only whitespace; i.e. whether that string is a key
+bool keyFollows(QStringView rest, bool inString, bool escapeNext)
+{
+    qsizetype i = 0;
+    if (inString) {
+        for (;; ++i) {
+            if (i == rest.size())
+                return false;
+            if (escapeNext)
+                escapeNext = false;
+            else if (rest.at(i) == u'\\')
+                escapeNext = true;
+            else if (rest.at(i) == u'"')
+                break;
+        }
+        ++i;
+    }
+    while (i < rest.size() && rest.at(i).isSpace())
+        ++i;
+    return i < rest.size() && rest.at(i) == u':';
+}
+
+void setKeyColor(QString& out, qsizetype spanStart, const MarkupTable& table)
+{
+    const QLatin1String key = table.open[TokenKey];
+    QChar* color = out.data() + spanStart + table.colorOffset;
+    for (int k = 0; k < kColorLength; ++k)
+        color[k] = QLatin1Char(key.data()[table.colorOffset + k]);
+}
+
+} // namespace
+
+QString JsonHighlighter::highlightDocument(const QString& input)
+{
+    QString result;
+    // Span markup roughly triples typical formatted JSON; growth beyond
+    // this estimate is amortized by QString
+    result.reserve(kPreOpen.size() + input.size() * 3 + kPreClose.size());
+    result += kPreOpen;
+
+    State state;
+    highlight(input, Markup::Html, state, result);
+
+    result += kPreClose;
+    return result;
+}
+
+void JsonHighlighter::highlight(QStringView text, Markup markup, State& state, QString& out,
+                                QStringView lookahead)
+{
+    const MarkupTable& table = markup == Markup::Html ? kHtmlTable : kStyledTable;
+    const bool styled = markup == Markup::StyledText;
+
+    const QChar* p = text.data();
+    const QChar* const end = p + text.size();
+
+    // Output position of the span of a string opened in this range, while
+    // it may still turn out to be a key (open, or only whitespace seen
+    // since it closed). A string resumed from state already knows.
+    qsizetype pendingString = -1;
+
+    if (state.inString && p < end)
+        out += table.open[state.inKey ? TokenKey : TokenString];
+
+    while (p < end) {
+        if (state.inString) {
+            if (state.escapeNext) {
+                appendEscaped(out, *p++, styled);
+                state.escapeNext = false;
+                continue;
+            }
+
+            // Copy runs of plain characters at once; only quotes, escapes
+            // and markup-special characters need per-character handling
+            const QChar* run = p;
+            while (p < end && *p != u'"' && *p != u'\\' && !needsEscape(*p, styled))
+                ++p;
+            out.append(run, p - run);
+            if (p == end)
+                break;
+
+            if (*p == u'"') {
+                out += *p++;
+                out += table.close;
+                state.inString = false;
+                state.inKey = false;
+            } else if (*p == u'\\') {
+                out += *p++;
+                state.escapeNext = true;
+            } else {
+                appendEscaped(out, *p++, styled);
+            }
+            continue;
+        }
+
+        const QChar c = *p;
+
+        if (pendingString >= 0) {
+            if (c == u':') {
+                setKeyColor(out, pendingString, table);
+                pendingString = -1;
+            } else if (!c.isSpace()) {
+                pendingString = -1;
+            }
+        }
+
+        if (c == u'"') {
+            pendingString = out.size();
+            out += table.open[TokenString];
+            out += c;
+            ++p;
+            state.inString = true;
+            continue;
+        }
+
+        // Numbers
+        if (c.isDigit() || (c == u'-' && p + 1 < end && p[1].isDigit())) {
+            const QChar* run = p;
+            while (p < end && isNumberChar(*p))
+                ++p;
+            out += table.open[TokenNumber];
+            out.append(run, p - run);
+            out += table.close;
+            continue;
+        }
+
+        // true/false/null
+        if (c == u't' || c == u'f' || c == u'n') {
+            static constexpr QLatin1String literals[] = {
+                QLatin1String("true"), QLatin1String("false"), QLatin1String("null")
+            };
+            bool matched = false;
+            for (const QLatin1String& literal : literals) {
+                if (matchesLiteral(p, end, literal)) {
+                    out += table.open[c == u'n' ? TokenNull : TokenBoolean];
+                    out += literal;
+                    out += table.close;
+                    p += literal.size();
+                    matched = true;
+                    break;
+                }
+            }
+            if (matched)
+                continue;
+        }
+
+        // Brackets, braces, colon and comma
+        if (c == u'{' || c == u'}' || c == u'[' || c == u']' || c == u':' || c == u',') {
+            out += table.open[TokenPunctuation];
+            out += c;
+            out += table.close;
+            ++p;
+            continue;
+        }
+
+        // All other characters (whitespace, newlines) - pass through
+        appendEscaped(out, c, styled);
+        ++p;
+    }
+
+    // A string opened here whose ':' lies past the range end
+    if (pendingString >= 0 && keyFollows(lookahead, state.inString, state.escapeNext)) {
+        setKeyColor(out, pendingString, table);
+        state.inKey = state.inString;
+    }
+
+    // Close a string left open at the end of the range; it is reopened
+    // when highlighting resumes from state
+    if (state.inString && !text.isEmpty())
+        out += table.close;
+}
+
+void JsonHighlighter::advance(QStringView text, State& state, QStringView lookahead)
+{
+    bool openedHere = false;
+    for (const QChar c : text) {
+        if (state.escapeNext) {
+            state.escapeNext = false;
+        } else if (c == u'"') {
+            state.inString = !state.inString;
+            state.inKey = false;
+            openedHere = state.inString;
+        } else if (c == u'\\' && state.inString) {
+            state.escapeNext = true;
+        }
+    }
+
+    // Each string is looked ahead once, where it opens; later ranges
+    // inside it keep the answer
+    if (openedHere)
+        state.inKey = keyFollows(lookahead, true, state.escapeNext);
+}
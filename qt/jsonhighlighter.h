@@ -0,0 +1,40 @@
+#ifndef JSONHIGHLIGHTER_H
+#define JSONHIGHLIGHTER_H
+
+#include <QString>
+#include <QStringView>
+
+// Single-pass JSON syntax highlighter producing jq-like colours.
+//
+// Works directly on UTF-16 data and appends to a caller-owned buffer.
+// Highlighting can be resumed mid-document from a saved State, which lets
+// the output view style one visible line (or line segment) at a time.
+class JsonHighlighter
+{
+public:
+    enum class Markup {
+        Html,       // <span style="color:..."> for RichText
+        StyledText  // <font color="..."> with &nbsp; for Text.StyledText
+    };
+
+    // Lexer state carried across range boundaries
+    struct State {
+        bool inString = false;
+        bool escapeNext = false;
+        bool inKey = false;         // The open string is an object key
+    };
+
+    // Whole document as RichText HTML wrapped in <pre>
+    static QString highlightDocument(const QString& input);
+
+    // Highlights text starting from state, appending markup to out; state
+    // is updated to where the range ends. lookahead is the text after the
+    // range: it decides whether a string cut off by the range end is a key.
+    static void highlight(QStringView text, Markup markup, State& state, QString& out,
+                          QStringView lookahead = {});
+
+    // Updates state as if text had been highlighted, without producing output
+    static void advance(QStringView text, State& state, QStringView lookahead = {});
+};
+
+#endif // JSONHIGHLIGHTER_H
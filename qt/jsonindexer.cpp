@@ -0,0 +1,978 @@
+#include "jsonindexer.h"
+#include <QByteArray>
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define AIRGAP_INDEXER_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AIRGAP_INDEXER_SSE2
+#elif (defined(__aarch64__) && defined(__ARM_NEON)) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define AIRGAP_INDEXER_NEON
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define AIRGAP_INDEXER_SIMD128
+#endif
+
+#if defined(__PCLMUL__) && defined(__x86_64__)
+#include <wmmintrin.h>
+#define AIRGAP_INDEXER_CLMUL
+#endif
+
+namespace {
+
+// One 64-byte block loaded into vector registers. Each compare returns a
+// bitmask with bit i set for byte i.
+#if defined(AIRGAP_INDEXER_AVX2)
+struct Block {
+    __m256i v[2];
+
+    explicit Block(const uchar* p)
+    {
+        v[0] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        v[1] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    }
+    static quint64 bits(__m256i lo, __m256i hi)
+    {
+        return quint64(quint32(_mm256_movemask_epi8(lo))) | (quint64(quint32(_mm256_movemask_epi8(hi))) << 32);
+    }
+    quint64 eq(char c) const
+    {
+        const __m256i s = _mm256_set1_epi8(c);
+        return bits(_mm256_cmpeq_epi8(v[0], s), _mm256_cmpeq_epi8(v[1], s));
+    }
+    quint64 atMost(uchar c) const
+    {
+        const __m256i s = _mm256_set1_epi8(char(c));
+        return bits(_mm256_cmpeq_epi8(_mm256_min_epu8(v[0], s), v[0]),
+                    _mm256_cmpeq_epi8(_mm256_min_epu8(v[1], s), v[1]));
+    }
+    quint64 nonAscii() const { return bits(v[0], v[1]); }
+};
+#elif defined(AIRGAP_INDEXER_SSE2)
+struct Block {
+    __m128i v[4];
+
+    explicit Block(const uchar* p)
+    {
+        for (int i = 0; i < 4; ++i)
+            v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+    }
+    template <typename Compare>
+    quint64 bits(Compare compare) const
+    {
+        quint64 mask = 0;
+        for (int i = 0; i < 4; ++i)
+            mask |= quint64(quint32(_mm_movemask_epi8(compare(v[i])))) << (16 * i);
+        return mask;
+    }
+    quint64 eq(char c) const
+    {
+        const __m128i s = _mm_set1_epi8(c);
+        return bits([s](__m128i x) { return _mm_cmpeq_epi8(x, s); });
+    }
+    quint64 atMost(uchar c) const
+    {
+        const __m128i s = _mm_set1_epi8(char(c));
+        return bits([s](__m128i x) { return _mm_cmpeq_epi8(_mm_min_epu8(x, s), x); });
+    }
+    quint64 nonAscii() const
+    {
+        return bits([](__m128i x) { return x; });
+    }
+};
+#elif defined(AIRGAP_INDEXER_NEON)
+struct Block {
+    uint8x16_t v[4];
+
+    explicit Block(const uchar* p)
+    {
+        for (int i = 0; i < 4; ++i)
+            v[i] = vld1q_u8(p + 16 * i);
+    }
+    // NEON has no movemask: weight each lane by its bit and add pairwise
+    static quint64 bits(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d)
+    {
+        static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+        const uint8x16_t w = vld1q_u8(weights);
+        uint8x16_t sum0 = vpaddq_u8(vandq_u8(a, w), vandq_u8(b, w));
+        const uint8x16_t sum1 = vpaddq_u8(vandq_u8(c, w), vandq_u8(d, w));
+        sum0 = vpaddq_u8(sum0, sum1);
+        sum0 = vpaddq_u8(sum0, sum0);
+        return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+    }
+    quint64 eq(char c) const
+    {
+        const uint8x16_t s = vdupq_n_u8(uchar(c));
+        return bits(vceqq_u8(v[0], s), vceqq_u8(v[1], s), vceqq_u8(v[2], s), vceqq_u8(v[3], s));
+    }
+    quint64 atMost(uchar c) const
+    {
+        const uint8x16_t s = vdupq_n_u8(c);
+        return bits(vcleq_u8(v[0], s), vcleq_u8(v[1], s), vcleq_u8(v[2], s), vcleq_u8(v[3], s));
+    }
+    quint64 nonAscii() const
+    {
+        const uint8x16_t s = vdupq_n_u8(0x80);
+        return bits(vcgeq_u8(v[0], s), vcgeq_u8(v[1], s), vcgeq_u8(v[2], s), vcgeq_u8(v[3], s));
+    }
+};
+#elif defined(AIRGAP_INDEXER_SIMD128)
+struct Block {
+    v128_t v[4];
+
+    explicit Block(const uchar* p)
+    {
+        for (int i = 0; i < 4; ++i)
+            v[i] = wasm_v128_load(p + 16 * i);
+    }
+    template <typename Compare>
+    quint64 bits(Compare compare) const
+    {
+        quint64 mask = 0;
+        for (int i = 0; i < 4; ++i)
+            mask |= quint64(wasm_i8x16_bitmask(compare(v[i])) & 0xFFFF) << (16 * i);
+        return mask;
+    }
+    quint64 eq(char c) const
+    {
+        const v128_t s = wasm_i8x16_splat(c);
+        return bits([s](v128_t x) { return wasm_i8x16_eq(x, s); });
+    }
+    quint64 atMost(uchar c) const
+    {
+        const v128_t s = wasm_u8x16_splat(c);
+        return bits([s](v128_t x) { return wasm_u8x16_le(x, s); });
+    }
+    quint64 nonAscii() const
+    {
+        return bits([](v128_t x) { return x; });
+    }
+};
+#else
+struct Block {
+    const uchar* p;
+
+    explicit Block(const uchar* data) : p(data) {}
+
+    template <typename Predicate>
+    quint64 bits(Predicate predicate) const
+    {
+        quint64 mask = 0;
+        for (int i = 0; i < JsonIndexer::BlockSize; ++i)
+            mask |= quint64(predicate(p[i]) ? 1 : 0) << i;
+        return mask;
+    }
+    quint64 eq(char c) const
+    {
+        return bits([c](uchar b) { return b == uchar(c); });
+    }
+    quint64 atMost(uchar c) const
+    {
+        return bits([c](uchar b) { return b <= c; });
+    }
+    quint64 nonAscii() const
+    {
+        return bits([](uchar b) { return b >= 0x80; });
+    }
+};
+#endif
+
+// Character classes of one block
+struct Masks {
+    quint64 backslash;
+    quint64 quote;
+    quint64 op;             // { } [ ] : ,
+    quint64 whitespace;
+    quint64 newline;
+    quint64 control;        // Below 0x20
+    quint64 nonAscii;
+};
+
+Masks classify(const Block& block)
+{
+    Masks m;
+    m.backslash = block.eq('\\');
+    m.quote = block.eq('"');
+    m.op = block.eq('{') | block.eq('}') | block.eq('[') | block.eq(']') | block.eq(':') | block.eq(',');
+    m.newline = block.eq('\n');
+    m.whitespace = block.eq(' ') | block.eq('\t') | block.eq('\r') | m.newline;
+    m.control = block.atMost(0x1F);
+    m.nonAscii = block.nonAscii();
+    return m;
+}
+
+// Bit i is set when an odd number of bits at or below i are set, so the
+// prefix XOR of the quote mask marks everything from an opening quote up
+// to (not including) its closing quote
+inline quint64 prefixXor(quint64 x)
+{
+#if defined(AIRGAP_INDEXER_CLMUL)
+    const __m128i product = _mm_clmulepi64_si128(_mm_set_epi64x(0, qint64(x)), _mm_set1_epi8(char(0xFF)), 0);
+    return quint64(_mm_cvtsi128_si64(product));
+#else
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+#endif
+}
+
+// Bits below count
+inline quint64 lowBits(qsizetype count)
+{
+    return count >= 64 ? ~quint64(0) : (quint64(1) << count) - 1;
+}
+
+inline bool isHexDigit(uchar c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+inline bool isDigit(uchar c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Bytes that may follow a number or literal
+inline bool isTerminator(uchar c)
+{
+    switch (c) {
+        case ' ': case '\t': case '\n': case '\r':
+        case ',': case ':': case '[': case ']': case '{': case '}':
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Column of offset in code points from the start of its line
+int columnAt(const uchar* data, qsizetype size, qsizetype offset)
+{
+    int column = 1;
+    for (qsizetype i = qMin(offset, size) - 1; i >= 0 && data[i] != '\n'; --i) {
+        if ((data[i] & 0xC0) != 0x80)
+            ++column;
+    }
+    return column;
+}
+
+// Earliest string content error found in a block
+struct BlockError {
+    qsizetype offset = -1;
+    const char* message = nullptr;
+
+    void update(qsizetype at, const char* text)
+    {
+        if (offset < 0 || at < offset) {
+            offset = at;
+            message = text;
+        }
+    }
+};
+
+class Validator
+{
+public:
+    Validator(QByteArrayView utf8, bool requireContainer, QList<qsizetype>* separators)
+        : m_data(reinterpret_cast<const uchar*>(utf8.data()))
+        , m_size(utf8.size())
+        , m_requireContainer(requireContainer)
+        , m_separators(separators)
+    {
+    }
+
+    JsonIndexer::Result run();
+
+    // Incremental scans: checkpoints are appended to list while scanning
+    void record(QList<JsonIndexer::Checkpoint>* list) { m_checkpoints = list; }
+    void restore(const JsonIndexer::Checkpoint& checkpoint);
+    // Scans from start to the end of the input. Stops early at the first
+    // of count targets, offsets shift bytes on, whose state matches and
+    // returns its index; -1 once the result is complete.
+    int scan(qsizetype start, const JsonIndexer::Checkpoint* targets, int count, qsizetype shift);
+
+    const JsonIndexer::Result& result() const { return m_result; }
+    int line() const { return m_lineAtBlock + qPopulationCount(m_blockNewlines); }
+    qsizetype scannedBytes() const { return m_scanned; }
+
+private:
+    enum class State {
+        Value,              // Expecting a value
+        FirstValueOrEnd,    // After '[': a value or ']'
+        KeyOrEnd,           // After '{': a key or '}'
+        Key,                // After ',' in an object
+        Colon,
+        CommaOrEnd,         // After a value inside a container
+        Done                // Top-level value complete
+    };
+
+    bool scanBlock(qsizetype start, qsizetype length);
+    bool processBlock(const Block& block, qsizetype start, qsizetype length);
+    quint64 findEscaped(quint64 backslash);
+    void checkEscapes(quint64 escapes, qsizetype start, BlockError& error) const;
+    void checkUtf8(qsizetype start, qsizetype length, BlockError& error);
+
+    bool structural(qsizetype pos);
+    bool beginValue(qsizetype pos, uchar c);
+    bool literal(qsizetype pos, const char* text, qsizetype length);
+    bool number(qsizetype pos);
+    void endValue();
+    bool finish();
+
+    bool fail(const char* message, qsizetype offset);
+
+    void saveCheckpoint(qsizetype offset);
+    void closeSegment();
+    bool matches(const JsonIndexer::Checkpoint& checkpoint) const;
+
+    const uchar* m_data;
+    qsizetype m_size;
+    bool m_requireContainer;
+    QList<qsizetype>* m_separators;
+    JsonIndexer::Result m_result;
+
+    // Stage 1 carries between blocks
+    quint64 m_prevEscaped = 0;
+    quint64 m_inString = 0;         // All ones while inside a string
+    quint64 m_prevScalar = 0;
+    int m_utf8Pending = 0;          // Continuation bytes still expected
+    uchar m_utf8Low = 0x80;
+    uchar m_utf8High = 0xBF;
+
+    // Newline index: lines before the current block, and its newlines
+    int m_lineAtBlock = 1;
+    qsizetype m_blockStart = 0;
+    qsizetype m_blockLength = 0;
+    quint64 m_blockNewlines = 0;
+
+    // Stage 2
+    State m_state = State::Value;
+    QByteArray m_stack;             // '{' or '[' per open container
+
+    // Incremental scans
+    QList<JsonIndexer::Checkpoint>* m_checkpoints = nullptr;
+    qsizetype m_horizon = 0;        // End of the bytes read so far
+    int m_segmentMaxDepth = 0;      // Deepest value since the last checkpoint
+    qsizetype m_scanned = 0;
+};
+
+JsonIndexer::Result Validator::run()
+{
+    scan(0, nullptr, 0, 0);
+    return m_result;
+}
+
+int Validator::scan(qsizetype start, const JsonIndexer::Checkpoint* targets, int count, qsizetype shift)
+{
+    int next = 0;
+    while (start < m_size) {
+        qsizetype length = qMin<qsizetype>(JsonIndexer::BlockSize, m_size - start);
+
+        // A block never runs past the next target, so each is met exactly
+        while (next < count && targets[next].offset + shift < start)
+            ++next;
+        if (next < count) {
+            const qsizetype target = targets[next].offset + shift;
+            if (target == start) {
+                if (matches(targets[next])) {
+                    closeSegment();
+                    return next;
+                }
+                ++next;
+                continue;
+            }
+            length = qMin(length, target - start);
+        }
+
+        if (!scanBlock(start, length)) {
+            closeSegment();
+            return -1;
+        }
+        start += length;
+    }
+
+    if (finish())
+        m_result.valid = true;
+    closeSegment();
+    return -1;
+}
+
+bool Validator::scanBlock(qsizetype start, qsizetype length)
+{
+    if (m_checkpoints && (m_checkpoints->isEmpty()
+                          || start >= m_checkpoints->last().offset + JsonIncrementalIndexer::CheckpointInterval))
+        saveCheckpoint(start);
+    m_scanned += length;
+
+    const uchar* p = m_data + start;
+    uchar tail[JsonIndexer::BlockSize];
+    if (length < JsonIndexer::BlockSize) {
+        // Whitespace padding classifies as nothing of interest
+        std::memset(tail, ' ', sizeof(tail));
+        std::memcpy(tail, p, size_t(length));
+        p = tail;
+    }
+    return processBlock(Block(p), start, length);
+}
+
+void Validator::saveCheckpoint(qsizetype offset)
+{
+    closeSegment();
+
+    JsonIndexer::Checkpoint checkpoint;
+    checkpoint.offset = offset;
+    checkpoint.horizon = qMax(offset, m_horizon);
+    checkpoint.line = line();
+    checkpoint.stats = m_result.stats;
+    checkpoint.prevEscaped = m_prevEscaped;
+    checkpoint.inString = m_inString;
+    checkpoint.prevScalar = m_prevScalar;
+    checkpoint.utf8Pending = m_utf8Pending;
+    checkpoint.utf8Low = m_utf8Low;
+    checkpoint.utf8High = m_utf8High;
+    checkpoint.state = int(m_state);
+    checkpoint.stack = m_stack;
+    m_checkpoints->append(checkpoint);
+}
+
+// The segment after the last checkpoint ends here
+void Validator::closeSegment()
+{
+    if (m_checkpoints && !m_checkpoints->isEmpty())
+        m_checkpoints->last().segmentMaxDepth = m_segmentMaxDepth;
+    m_segmentMaxDepth = 0;
+}
+
+void Validator::restore(const JsonIndexer::Checkpoint& checkpoint)
+{
+    m_result.stats = checkpoint.stats;
+    m_prevEscaped = checkpoint.prevEscaped;
+    m_inString = checkpoint.inString;
+    m_prevScalar = checkpoint.prevScalar;
+    m_utf8Pending = checkpoint.utf8Pending;
+    m_utf8Low = checkpoint.utf8Low;
+    m_utf8High = checkpoint.utf8High;
+    m_lineAtBlock = checkpoint.line;
+    m_blockStart = checkpoint.offset;
+    m_blockLength = 0;
+    m_blockNewlines = 0;
+    m_state = State(checkpoint.state);
+    m_stack = checkpoint.stack;
+    m_horizon = checkpoint.horizon;
+}
+
+// Everything that decides how the rest of the input is scanned; offsets,
+// lines and counts only shift
+bool Validator::matches(const JsonIndexer::Checkpoint& checkpoint) const
+{
+    return m_prevEscaped == checkpoint.prevEscaped && m_inString == checkpoint.inString
+        && m_prevScalar == checkpoint.prevScalar && m_utf8Pending == checkpoint.utf8Pending
+        && m_utf8Low == checkpoint.utf8Low && m_utf8High == checkpoint.utf8High
+        && int(m_state) == checkpoint.state && m_stack == checkpoint.stack;
+}
+
+bool Validator::processBlock(const Block& block, qsizetype start, qsizetype length)
+{
+    const Masks m = classify(block);
+    const quint64 valid = lowBits(length);
+
+    m_lineAtBlock += qPopulationCount(m_blockNewlines);
+    m_blockStart = start;
+    m_blockLength = length;
+    m_blockNewlines = m.newline & valid;
+    m_horizon = qMax(m_horizon, start + length);
+
+    // String interiors. Blocks are shorter than 64 bytes at the end of
+    // the input and before checkpoints, so carries come from the last
+    // real byte rather than bit 63.
+    const quint64 escaped = findEscaped(m.backslash);
+    if (length < JsonIndexer::BlockSize)
+        m_prevEscaped = (escaped >> length) & 1;
+    const quint64 quotes = m.quote & ~escaped;
+    const quint64 inString = prefixXor(quotes) ^ m_inString;
+    m_inString = quint64(qint64(inString) >> 63);
+    // Contents and closing quote, but not the opening quote
+    const quint64 stringTail = inString ^ quotes;
+
+    // Structural positions: operators plus the first byte of each scalar
+    const quint64 scalar = ~(m.op | m.whitespace);
+    const quint64 nonQuoteScalar = scalar & ~quotes;
+    const quint64 followsScalar = (nonQuoteScalar << 1) | m_prevScalar;
+    m_prevScalar = (nonQuoteScalar >> (length - 1)) & 1;
+    quint64 structurals = (m.op | (scalar & ~followsScalar)) & ~stringTail & valid;
+
+    // String content errors; structural positions past the earliest one
+    // are not visited, so errors are reported in input order
+    BlockError error;
+    if (const quint64 controls = m.control & inString & valid)
+        error.update(start + qCountTrailingZeroBits(controls), "Control character in string");
+    if (const quint64 escapes = escaped & inString & valid) {
+        checkEscapes(escapes, start, error);
+        // \u escapes read up to four bytes on
+        m_horizon = qMax(m_horizon, start + length + 4);
+    }
+    if (m.nonAscii || m_utf8Pending)
+        checkUtf8(start, length, error);
+    if (error.offset >= 0)
+        structurals &= lowBits(error.offset - start);
+
+    for (; structurals; structurals &= structurals - 1) {
+        if (!structural(start + qCountTrailingZeroBits(structurals)))
+            return false;
+    }
+
+    return error.offset < 0 || fail(error.message, error.offset);
+}
+
+// Marks each byte preceded by an odd-length run of backslashes; a run may
+// continue from the previous block
+quint64 Validator::findEscaped(quint64 backslash)
+{
+    if (!backslash) {
+        const quint64 escaped = m_prevEscaped;
+        m_prevEscaped = 0;
+        return escaped;
+    }
+
+    constexpr quint64 EvenBits = 0x5555555555555555ULL;
+    backslash &= ~m_prevEscaped;
+    const quint64 followsEscape = (backslash << 1) | m_prevEscaped;
+    const quint64 oddSequenceStarts = backslash & ~EvenBits & ~followsEscape;
+    const quint64 sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+    m_prevEscaped = sequencesStartingOnEvenBits < backslash ? 1 : 0;
+    const quint64 invertMask = sequencesStartingOnEvenBits << 1;
+    return (EvenBits ^ invertMask) & followsEscape;
+}
+
+// Checks the character following each backslash
+void Validator::checkEscapes(quint64 escapes, qsizetype start, BlockError& error) const
+{
+    for (; escapes; escapes &= escapes - 1) {
+        const qsizetype pos = start + qCountTrailingZeroBits(escapes);
+        switch (m_data[pos]) {
+            case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                break;
+            case 'u':
+                for (qsizetype i = pos + 1; i <= pos + 4; ++i) {
+                    if (i >= m_size || !isHexDigit(m_data[i])) {
+                        error.update(i, "Invalid \\u escape");
+                        return;
+                    }
+                }
+                break;
+            default:
+                error.update(pos, "Invalid escape sequence");
+                return;
+        }
+    }
+}
+
+// Blocks holding non-ASCII bytes are checked with a byte loop; a sequence
+// may continue into the next block
+void Validator::checkUtf8(qsizetype start, qsizetype length, BlockError& error)
+{
+    for (qsizetype i = start; i < start + length; ++i) {
+        const uchar b = m_data[i];
+        if (m_utf8Pending) {
+            if (b < m_utf8Low || b > m_utf8High) {
+                error.update(i, "Invalid UTF-8");
+                return;
+            }
+            --m_utf8Pending;
+            m_utf8Low = 0x80;
+            m_utf8High = 0xBF;
+            continue;
+        }
+        if (b < 0x80)
+            continue;
+
+        // Lead byte; the bounds on the second byte exclude overlong
+        // forms, surrogates and code points past U+10FFFF
+        if (b >= 0xC2 && b <= 0xDF) {
+            m_utf8Pending = 1;
+        } else if (b >= 0xE0 && b <= 0xEF) {
+            m_utf8Pending = 2;
+            if (b == 0xE0)
+                m_utf8Low = 0xA0;
+            else if (b == 0xED)
+                m_utf8High = 0x9F;
+        } else if (b >= 0xF0 && b <= 0xF4) {
+            m_utf8Pending = 3;
+            if (b == 0xF0)
+                m_utf8Low = 0x90;
+            else if (b == 0xF4)
+                m_utf8High = 0x8F;
+        } else {
+            error.update(i, "Invalid UTF-8");
+            return;
+        }
+    }
+}
+
+bool Validator::structural(qsizetype pos)
+{
+    const uchar c = m_data[pos];
+
+    switch (m_state) {
+        case State::Value:
+            return beginValue(pos, c);
+        case State::FirstValueOrEnd:
+            if (c == ']') {
+                m_stack.chop(1);
+                endValue();
+                return true;
+            }
+            return beginValue(pos, c);
+        case State::KeyOrEnd:
+            if (c == '}') {
+                m_stack.chop(1);
+                endValue();
+                return true;
+            }
+            Q_FALLTHROUGH();
+        case State::Key:
+            if (c != '"')
+                return fail("Expected string key", pos);
+            ++m_result.stats.keys;
+            m_state = State::Colon;
+            return true;
+        case State::Colon:
+            if (c != ':')
+                return fail("Expected ':'", pos);
+            m_state = State::Value;
+            return true;
+        case State::CommaOrEnd: {
+            const char open = m_stack.back();
+            if (c == ',') {
+                if (m_separators && m_stack.size() == 1)
+                    m_separators->append(pos);
+                m_state = (open == '{') ? State::Key : State::Value;
+                return true;
+            }
+            if ((c == '}' && open == '{') || (c == ']' && open == '[')) {
+                m_stack.chop(1);
+                endValue();
+                return true;
+            }
+            return fail(open == '{' ? "Expected ',' or '}'" : "Expected ',' or ']'", pos);
+        }
+        case State::Done:
+            return fail("Unexpected data after document", pos);
+    }
+    return false;
+}
+
+bool Validator::beginValue(qsizetype pos, uchar c)
+{
+    JsonIndexer::Stats& stats = m_result.stats;
+    const int depth = int(m_stack.size()) + 1;
+
+    if (m_requireContainer && m_stack.isEmpty() && c != '{' && c != '[')
+        return fail("Expected object or array", pos);
+    stats.maxDepth = qMax(stats.maxDepth, depth);
+    m_segmentMaxDepth = qMax(m_segmentMaxDepth, depth);
+
+    switch (c) {
+        case '{':
+        case '[':
+            if (depth > JsonIndexer::MaxDepth)
+                return fail("Nesting too deep", pos);
+            if (c == '{') {
+                ++stats.objects;
+                m_state = State::KeyOrEnd;
+            } else {
+                ++stats.arrays;
+                m_state = State::FirstValueOrEnd;
+            }
+            m_stack.append(char(c));
+            return true;
+        case '"':
+            // Stage 1 already checked its contents
+            ++stats.strings;
+            endValue();
+            return true;
+        case 't':
+            ++stats.booleans;
+            return literal(pos, "true", 4);
+        case 'f':
+            ++stats.booleans;
+            return literal(pos, "false", 5);
+        case 'n':
+            ++stats.nulls;
+            return literal(pos, "null", 4);
+        default:
+            if (c == '-' || isDigit(c)) {
+                ++stats.numbers;
+                return number(pos);
+            }
+            return fail("Unexpected character", pos);
+    }
+}
+
+bool Validator::literal(qsizetype pos, const char* text, qsizetype length)
+{
+    for (qsizetype i = 1; i < length; ++i) {
+        if (pos + i >= m_size || m_data[pos + i] != uchar(text[i]))
+            return fail("Invalid literal", pos + i);
+    }
+    const qsizetype end = pos + length;
+    m_horizon = qMax(m_horizon, end + 1);
+    if (end < m_size && !isTerminator(m_data[end]))
+        return fail("Invalid literal", end);
+    endValue();
+    return true;
+}
+
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool Validator::number(qsizetype pos)
+{
+    qsizetype i = pos;
+    const auto digits = [this, &i]() {
+        const qsizetype first = i;
+        while (i < m_size && isDigit(m_data[i]))
+            ++i;
+        return i > first;
+    };
+
+    if (m_data[i] == '-')
+        ++i;
+    if (i < m_size && m_data[i] == '0')
+        ++i;
+    else if (!digits())
+        return fail("Invalid number", i);
+
+    if (i < m_size && m_data[i] == '.') {
+        ++i;
+        if (!digits())
+            return fail("Invalid number", i);
+    }
+    if (i < m_size && (m_data[i] == 'e' || m_data[i] == 'E')) {
+        ++i;
+        if (i < m_size && (m_data[i] == '+' || m_data[i] == '-'))
+            ++i;
+        if (!digits())
+            return fail("Invalid number", i);
+    }
+
+    m_horizon = qMax(m_horizon, i + 1);
+    if (i < m_size && !isTerminator(m_data[i]))
+        return fail("Invalid number", i);
+    endValue();
+    return true;
+}
+
+void Validator::endValue()
+{
+    m_state = m_stack.isEmpty() ? State::Done : State::CommaOrEnd;
+}
+
+bool Validator::finish()
+{
+    if (m_utf8Pending)
+        return fail("Invalid UTF-8", m_size);
+    if (m_inString)
+        return fail("Unterminated string", m_size);
+    if (m_state != State::Done)
+        return fail("Unexpected end of input", m_size);
+    return true;
+}
+
+bool Validator::fail(const char* message, qsizetype offset)
+{
+    m_result.valid = false;
+    m_result.error = QString::fromLatin1(message);
+    m_result.errorOffset = offset;
+
+    // Whole blocks come from the newline index; only a scalar that runs
+    // past the current block needs its bytes counted
+    int line = m_lineAtBlock + qPopulationCount(m_blockNewlines & lowBits(offset - m_blockStart));
+    for (qsizetype i = m_blockStart + m_blockLength; i < offset && i < m_size; ++i) {
+        if (m_data[i] == '\n')
+            ++line;
+    }
+
+    m_result.errorLine = line;
+    m_result.errorColumn = columnAt(m_data, m_size, offset);
+    return false;
+}
+
+} // namespace
+
+JsonIndexer::Result JsonIndexer::validate(QByteArrayView utf8, bool requireContainer)
+{
+    return Validator(utf8, requireContainer, nullptr).run();
+}
+
+JsonIndexer::Result JsonIndexer::validate(QByteArrayView utf8, bool requireContainer,
+                                          QList<qsizetype>* separators)
+{
+    separators->clear();
+    const Result result = Validator(utf8, requireContainer, separators).run();
+    if (!result.valid)
+        separators->clear();
+    return result;
+}
+
+// Length of the common start of a and b
+static qsizetype commonPrefix(QByteArrayView a, QByteArrayView b)
+{
+    constexpr qsizetype Chunk = 4096;
+    const qsizetype size = qMin(a.size(), b.size());
+    qsizetype i = 0;
+    while (i + Chunk <= size && std::memcmp(a.data() + i, b.data() + i, Chunk) == 0)
+        i += Chunk;
+    while (i < size && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+// Length of the common end of a and b, within their last limit bytes
+static qsizetype commonSuffix(QByteArrayView a, QByteArrayView b, qsizetype limit)
+{
+    qsizetype i = 0;
+    while (i < limit && a[a.size() - 1 - i] == b[b.size() - 1 - i])
+        ++i;
+    return i;
+}
+
+JsonIncrementalIndexer::JsonIncrementalIndexer(bool requireContainer)
+    : m_requireContainer(requireContainer)
+{
+}
+
+void JsonIncrementalIndexer::reset()
+{
+    m_hasResult = false;
+    m_input = QByteArray();
+    m_result = JsonIndexer::Result();
+    m_checkpoints.clear();
+    m_scannedBytes = 0;
+}
+
+JsonIndexer::Result JsonIncrementalIndexer::validate(const QByteArray& utf8)
+{
+    if (m_hasResult && utf8 == m_input) {
+        m_scannedBytes = 0;
+        return m_result;
+    }
+
+    // The edit replaced [prefix, size - suffix) of the previous input
+    qsizetype prefix = 0;
+    qsizetype suffix = 0;
+    if (m_hasResult) {
+        prefix = commonPrefix(m_input, utf8);
+        suffix = commonSuffix(m_input, utf8, qMin(m_input.size(), utf8.size()) - prefix);
+    }
+    const qsizetype shift = utf8.size() - m_input.size();
+    const qsizetype editEnd = utf8.size() - suffix;
+
+    // Resume at the last checkpoint whose state depends only on the
+    // shared start
+    int from = -1;
+    for (int i = 0; m_hasResult && i < m_checkpoints.size() && m_checkpoints[i].offset <= prefix; ++i) {
+        if (m_checkpoints[i].horizon <= prefix)
+            from = i;
+    }
+
+    QList<JsonIndexer::Checkpoint> checkpoints = m_checkpoints.mid(0, from + 1);
+    Validator validator(utf8, m_requireContainer, nullptr);
+    validator.record(&checkpoints);
+    qsizetype start = 0;
+    if (from >= 0) {
+        validator.restore(checkpoints.last());
+        start = checkpoints.last().offset;
+    }
+
+    // Old checkpoints in the shared end, where the scans can meet again
+    int firstTarget = m_checkpoints.size();
+    for (int i = from + 1; m_hasResult && i < m_checkpoints.size(); ++i) {
+        const qsizetype offset = m_checkpoints[i].offset + shift;
+        if (offset >= editEnd && offset > start) {
+            firstTarget = i;
+            break;
+        }
+    }
+
+    const int matched = validator.scan(start, m_checkpoints.constData() + firstTarget,
+                                       int(m_checkpoints.size()) - firstTarget, shift);
+    JsonIndexer::Result result = validator.result();
+    m_scannedBytes = validator.scannedBytes();
+
+    if (matched >= 0) {
+        // The rest scans as before: take the old result and checkpoints,
+        // shifted by the edit
+        const int meet = firstTarget + matched;
+        const JsonIndexer::Stats now = result.stats;
+        const JsonIndexer::Stats then = m_checkpoints[meet].stats;
+        const int lineShift = validator.line() - m_checkpoints[meet].line;
+        const auto shiftCounts = [&now, &then](JsonIndexer::Stats& stats) {
+            stats.objects += now.objects - then.objects;
+            stats.arrays += now.arrays - then.arrays;
+            stats.strings += now.strings - then.strings;
+            stats.numbers += now.numbers - then.numbers;
+            stats.booleans += now.booleans - then.booleans;
+            stats.nulls += now.nulls - then.nulls;
+            stats.keys += now.keys - then.keys;
+        };
+
+        int maxDepth = now.maxDepth;
+        for (int i = meet; i < m_checkpoints.size(); ++i) {
+            JsonIndexer::Checkpoint checkpoint = m_checkpoints[i];
+            checkpoint.offset += shift;
+            checkpoint.horizon += shift;
+            checkpoint.line += lineShift;
+            shiftCounts(checkpoint.stats);
+            checkpoint.stats.maxDepth = maxDepth;
+            maxDepth = qMax(maxDepth, checkpoint.segmentMaxDepth);
+            checkpoints.append(checkpoint);
+        }
+
+        result = m_result;
+        shiftCounts(result.stats);
+        result.stats.maxDepth = maxDepth;
+        if (!result.valid) {
+            // The error lies past the meeting point; its line may have
+            // started inside the edit
+            result.errorOffset += shift;
+            result.errorLine += lineShift;
+            result.errorColumn = columnAt(reinterpret_cast<const uchar*>(utf8.constData()), utf8.size(),
+                                          result.errorOffset);
+        }
+    }
+
+    // A scan that failed before the end has no checkpoints past the error.
+    // While typing that is usually a passing state, so the previous input
+    // stays the reference unless this scan got as far.
+    const qsizetype reached = checkpoints.isEmpty() ? 0 : checkpoints.last().offset;
+    const bool stopsEarly = !result.valid && matched < 0 && m_hasResult && !m_checkpoints.isEmpty()
+        && reached < m_checkpoints.last().offset + shift;
+    if (!stopsEarly) {
+        m_hasResult = true;
+        m_input = utf8;
+        m_result = result;
+        m_checkpoints = std::move(checkpoints);
+    }
+    return result;
+}
+
+const char* JsonIndexer::kernel()
+{
+#if defined(AIRGAP_INDEXER_AVX2)
+    return "avx2";
+#elif defined(AIRGAP_INDEXER_SSE2)
+    return "sse2";
+#elif defined(AIRGAP_INDEXER_NEON)
+    return "neon";
+#elif defined(AIRGAP_INDEXER_SIMD128)
+    return "simd128";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,117 @@
+#ifndef JSONINDEXER_H
+#define JSONINDEXER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QString>
+
+// Validates UTF-8 JSON and counts its values without building a document.
+//
+// Stage 1 classifies the input in 64-byte blocks with vector compares
+// (AVX2 or SSE2, NEON, wasm simd128, or a portable loop) into bitmasks of
+// quotes, backslashes, structural characters, whitespace and newlines.
+// Escaped quotes and string interiors are then resolved with carry-
+// propagating bit arithmetic, as in simdjson, so string contents are
+// never walked byte by byte. Stage 2 visits only the structural positions
+// of each block to check the grammar and count values; numbers and
+// literals are checked where they start. Newlines are counted per block,
+// which gives the line of an error without rescanning the input.
+//
+// The grammar is RFC 8259: stricter than QJsonDocument about numbers
+// such as "1." and, like it, limited to MaxDepth nested containers.
+class JsonIndexer
+{
+public:
+    static constexpr int BlockSize = 64;
+    static constexpr int MaxDepth = 1024;
+
+    // Same meaning as the keys of the validation stats map
+    struct Stats {
+        int objects = 0;
+        int arrays = 0;
+        int strings = 0;        // String values, not keys
+        int numbers = 0;
+        int booleans = 0;
+        int nulls = 0;
+        int keys = 0;
+        int maxDepth = 0;       // A top-level container is depth 1
+    };
+
+    struct Result {
+        bool valid = false;
+        QString error;
+        qsizetype errorOffset = -1;     // Byte offset of the error
+        int errorLine = 0;              // 1-based
+        int errorColumn = 0;            // 1-based, in code points
+        Stats stats;
+    };
+
+    // requireContainer rejects a top-level scalar, as QJsonDocument does
+    static Result validate(QByteArrayView utf8, bool requireContainer = false);
+
+    // Also collects the offsets of the commas between the members of the
+    // top-level container, where it can be split into independent slices;
+    // left empty unless the input is valid
+    static Result validate(QByteArrayView utf8, bool requireContainer, QList<qsizetype>* separators);
+
+    // Stage-1 kernel compiled in: "avx2", "sse2", "neon", "simd128" or "scalar"
+    static const char* kernel();
+
+    // Scanner state before a block, recorded by JsonIncrementalIndexer
+    struct Checkpoint {
+        qsizetype offset = 0;
+        qsizetype horizon = 0;      // End of the bytes the state depends on
+        int line = 1;
+        Stats stats;
+        int segmentMaxDepth = 0;    // Deepest value begun before the next checkpoint
+
+        quint64 prevEscaped = 0;
+        quint64 inString = 0;
+        quint64 prevScalar = 0;
+        int utf8Pending = 0;
+        uchar utf8Low = 0x80;
+        uchar utf8High = 0xBF;
+
+        int state = 0;
+        QByteArray stack;
+    };
+};
+
+// Re-validates edited input without scanning all of it again.
+//
+// Each scan records a checkpoint of the scanner state every
+// CheckpointInterval bytes. For the next input, the bytes it shares with
+// the previous one at the start and at the end are found first. Scanning
+// resumes at the last checkpoint that depends only on the shared start,
+// and stops at the first checkpoint inside the shared end whose recorded
+// state matches: the old scan of the rest is reused, with offsets, lines
+// and counts shifted by the edit. Results are those of
+// JsonIndexer::validate() on the whole input. Input that fails before the
+// end does not replace the previous input as the reference for the next
+// edit, so the states passed through while typing stay cheap.
+//
+// Not thread-safe; one instance follows one stream of edits.
+class JsonIncrementalIndexer
+{
+public:
+    static constexpr qsizetype CheckpointInterval = 16 * 1024;
+
+    explicit JsonIncrementalIndexer(bool requireContainer = false);
+
+    JsonIndexer::Result validate(const QByteArray& utf8);
+    void reset();
+
+    // Bytes scanned by the last validate()
+    qsizetype scannedBytes() const { return m_scannedBytes; }
+
+private:
+    bool m_requireContainer;
+    bool m_hasResult = false;
+    QByteArray m_input;
+    JsonIndexer::Result m_result;
+    QList<JsonIndexer::Checkpoint> m_checkpoints;
+    qsizetype m_scannedBytes = 0;
+};
+
+#endif // JSONINDEXER_H
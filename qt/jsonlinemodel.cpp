@@ -0,0 +1,149 @@
+#include "jsonlinemodel.h"
+#include <utility>
+
+JsonLineModel::JsonLineModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int JsonLineModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_segments.size();
+}
+
+QVariant JsonLineModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_segments.size())
+        return QVariant();
+
+    const Segment& segment = m_segments.at(index.row());
+    const QStringView line = QStringView(m_text).mid(segment.start, segment.length);
+
+    switch (role) {
+        case LineNumberRole:
+            return segment.lineNumber;
+        case Qt::DisplayRole:
+        case LineTextRole:
+            return line.toString();
+        case HighlightedTextRole: {
+            QString markup;
+            markup.reserve(segment.length * 3);
+            JsonHighlighter::State state = segment.state;
+            JsonHighlighter::highlight(line, JsonHighlighter::Markup::StyledText, state, markup,
+                                       QStringView(m_text).mid(segment.start + segment.length));
+            return markup;
+        }
+        case IsContinuationRole:
+            return segment.continuation;
+        default:
+            return QVariant();
+    }
+}
+
+QHash<int, QByteArray> JsonLineModel::roleNames() const
+{
+    return {
+        {LineNumberRole, "lineNumber"},
+        {LineTextRole, "lineText"},
+        {HighlightedTextRole, "highlightedText"},
+        {IsContinuationRole, "isContinuation"}
+    };
+}
+
+void JsonLineModel::setText(const QString& text)
+{
+    setIndexedText(text, indexText(text));
+}
+
+void JsonLineModel::setIndexedText(const QString& text, Index&& index)
+{
+    beginResetModel();
+
+    m_text = text;
+    m_segments = std::move(index.segments);
+    m_lineCount = index.lineCount;
+
+    endResetModel();
+    emit textChanged();
+}
+
+JsonLineModel::Index JsonLineModel::indexText(const QString& text)
+{
+    Index index;
+    if (text.isEmpty())
+        return index;
+
+    const QStringView view(text);
+    qsizetype start = 0;
+    while (true) {
+        const qsizetype newline = view.indexOf(u'\n', start);
+        const qsizetype lineEnd = newline < 0 ? view.size() : newline;
+        qsizetype length = lineEnd - start;
+        if (length > 0 && view.at(lineEnd - 1) == u'\r')
+            --length;
+
+        indexLine(view, start, length, ++index.lineCount, index.segments);
+
+        if (newline < 0)
+            break;
+        start = newline + 1;
+    }
+    return index;
+}
+
+void JsonLineModel::clear()
+{
+    setText(QString());
+}
+
+QString JsonLineModel::textForRows(int firstRow, int lastRow) const
+{
+    if (firstRow > lastRow)
+        std::swap(firstRow, lastRow);
+    firstRow = qMax(firstRow, 0);
+    lastRow = qMin(lastRow, int(m_segments.size()) - 1);
+    if (firstRow > lastRow)
+        return QString();
+
+    // Rows are contiguous in m_text, so the range keeps its line breaks
+    const qsizetype start = m_segments.at(firstRow).start;
+    const Segment& last = m_segments.at(lastRow);
+    return m_text.mid(start, last.start + last.length - start);
+}
+
+void JsonLineModel::indexLine(QStringView text, qsizetype start, qsizetype length, int lineNumber,
+                              QVector<Segment>& segments)
+{
+    Segment segment;
+    segment.start = start;
+    segment.lineNumber = lineNumber;
+
+    if (length <= MaxSegmentLength) {
+        // Formatted JSON never continues a string across lines
+        segment.length = int(length);
+        segments.append(segment);
+        return;
+    }
+
+    // Long lines: record the lexer state at each segment boundary so a
+    // segment can be highlighted on its own
+    const qsizetype lineEnd = start + length;
+    JsonHighlighter::State state;
+    while (segment.start < lineEnd) {
+        qsizetype segmentEnd = qMin(segment.start + MaxSegmentLength, lineEnd);
+        // Never split a surrogate pair
+        if (segmentEnd < lineEnd && text.at(segmentEnd - 1).isHighSurrogate())
+            --segmentEnd;
+
+        segment.length = int(segmentEnd - segment.start);
+        segment.state = state;
+        segments.append(segment);
+
+        JsonHighlighter::advance(text.mid(segment.start, segment.length), state,
+                                 text.mid(segmentEnd, lineEnd - segmentEnd));
+        segment.start = segmentEnd;
+        segment.continuation = true;
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef JSONLINEMODEL_H
+#define JSONLINEMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QVector>
+#include "jsonhighlighter.h"
+
+// Line-indexed view of the formatted output.
+//
+// setText() only records where each line starts; highlighting is done per
+// row in data(), so a ListView styles just the delegates it creates and the
+// cost follows the viewport rather than the document size. Lines longer
+// than MaxSegmentLength (typically minified output) are split into
+// segments, each carrying the lexer state at its start.
+class JsonLineModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int lineCount READ lineCount NOTIFY textChanged)
+    Q_PROPERTY(QString text READ text NOTIFY textChanged)
+
+public:
+    enum Roles {
+        LineNumberRole = Qt::UserRole + 1,
+        LineTextRole,
+        HighlightedTextRole,
+        IsContinuationRole
+    };
+    Q_ENUM(Roles)
+
+    static constexpr int MaxSegmentLength = 2000;
+
+    struct Segment {
+        qsizetype start = 0;
+        int length = 0;
+        int lineNumber = 0;                 // 1-based source line
+        JsonHighlighter::State state;       // Lexer state at segment start
+        bool continuation = false;          // Not the first segment of its line
+    };
+
+    // Line starts of a text. Built by indexText() on any thread, then
+    // swapped in by setIndexedText() with the same text.
+    struct Index {
+        QVector<Segment> segments;
+        int lineCount = 0;
+    };
+    static Index indexText(const QString& text);
+
+    explicit JsonLineModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    Q_INVOKABLE void setText(const QString& text);
+    void setIndexedText(const QString& text, Index&& index);
+    Q_INVOKABLE void clear();
+    // Source text of rows firstRow..lastRow (either order), with the line
+    // breaks between them; used to copy a selection of rows
+    Q_INVOKABLE QString textForRows(int firstRow, int lastRow) const;
+    QString text() const { return m_text; }
+    int lineCount() const { return m_lineCount; }
+
+signals:
+    void textChanged();
+
+private:
+    static void indexLine(QStringView text, qsizetype start, qsizetype length, int lineNumber,
+                          QVector<Segment>& segments);
+
+    QString m_text;
+    QVector<Segment> m_segments;
+    int m_lineCount = 0;
+};
+
+#endif // JSONLINEMODEL_H
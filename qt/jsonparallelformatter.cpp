@@ -0,0 +1,131 @@
+#include "jsonparallelformatter.h"
+#include "jsonindexer.h"
+#include <QJsonDocument>
+
+#if defined(AIRGAP_HAS_CONCURRENT) && QT_CONFIG(thread)
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+#define AIRGAP_PARALLEL_SLICES 1
+#endif
+
+namespace {
+
+bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Parses a run of elements as an array and serializes it without its
+// brackets: "[e1,e2]" becomes "e1,e2" and "[\n    e1,\n    e2\n]"
+// becomes "\n    e1,\n    e2". Null if the slice does not parse.
+QByteArray formatSlice(QByteArrayView elements, const JsonWriter::Indent& indent)
+{
+    QByteArray wrapped;
+    wrapped.reserve(elements.size() + 2);
+    wrapped.append('[');
+    wrapped.append(elements);
+    wrapped.append(']');
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(wrapped, &error);
+    if (error.error != QJsonParseError::NoError)
+        return QByteArray();
+    wrapped = QByteArray();
+
+    const QByteArray output = JsonWriter::toJson(doc, indent, elements.size() * (indent.compact ? 1 : 2));
+    const qsizetype closing = indent.compact ? 1 : 2;
+    return output.sliced(1, output.size() - 1 - closing);
+}
+
+} // namespace
+
+int JsonParallelFormatter::sliceConcurrency()
+{
+#ifdef AIRGAP_PARALLEL_SLICES
+    return qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+#else
+    return 1;
+#endif
+}
+
+QList<qsizetype> JsonParallelFormatter::sliceBoundaries(QByteArrayView utf8, const QList<qsizetype>& separators,
+                                                        int maxSlices)
+{
+    qsizetype open = 0;
+    while (open < utf8.size() && isWhitespace(utf8[open]))
+        ++open;
+    qsizetype close = utf8.size() - 1;
+    while (close > open && isWhitespace(utf8[close]))
+        --close;
+
+    // Slice k ends at the first separator past k / slices of the span
+    const qsizetype span = close - open;
+    const int slices = int(qBound<qsizetype>(1, span / MinSliceSize, qMax(1, maxSlices)));
+
+    QList<qsizetype> boundaries{open};
+    int next = 1;
+    for (const qsizetype separator : separators) {
+        if (next >= slices)
+            break;
+        if (separator < open + span * next / slices)
+            continue;
+        boundaries.append(separator);
+        while (next < slices && separator >= open + span * next / slices)
+            ++next;
+    }
+    boundaries.append(close);
+    return boundaries;
+}
+
+QByteArray JsonParallelFormatter::format(QByteArrayView utf8, const JsonWriter::Indent& indent, int maxSlices)
+{
+    // A single element leaves nothing to split
+    QList<qsizetype> separators;
+    if (!JsonIndexer::validate(utf8, true, &separators).valid || separators.isEmpty())
+        return QByteArray();
+
+    const QList<qsizetype> boundaries =
+        sliceBoundaries(utf8, separators, maxSlices > 0 ? maxSlices : sliceConcurrency());
+    if (utf8[boundaries.first()] != '[')
+        return QByteArray();
+    separators.clear();
+
+    QList<QByteArrayView> slices;
+    slices.reserve(boundaries.size() - 1);
+    for (qsizetype i = 0; i + 1 < boundaries.size(); ++i)
+        slices.append(utf8.sliced(boundaries[i] + 1, boundaries[i + 1] - boundaries[i] - 1));
+
+    const auto formatOne = [indent](QByteArrayView slice) {
+        return formatSlice(slice, indent);
+    };
+#ifdef AIRGAP_PARALLEL_SLICES
+    const QList<QByteArray> outputs =
+        QtConcurrent::blockingMapped<QList<QByteArray>>(QThreadPool::globalInstance(), slices, formatOne);
+#else
+    QList<QByteArray> outputs;
+    outputs.reserve(slices.size());
+    for (const QByteArrayView slice : slices)
+        outputs.append(formatOne(slice));
+#endif
+
+    qsizetype total = 3;
+    for (const QByteArray& output : outputs) {
+        // The indexer accepted it, but QJsonDocument has its own limits
+        if (output.isNull())
+            return QByteArray();
+        total += output.size() + 1;
+    }
+
+    QByteArray result;
+    result.reserve(total);
+    result.append('[');
+    for (qsizetype i = 0; i < outputs.size(); ++i) {
+        if (i > 0)
+            result.append(',');
+        result.append(outputs[i]);
+    }
+    if (!indent.compact)
+        result.append('\n');
+    result.append(']');
+    return result;
+}
@@ -0,0 +1,45 @@
+#ifndef JSONPARALLELFORMATTER_H
+#define JSONPARALLELFORMATTER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include "jsonwriter.h"
+
+// Formats a large top-level array on several cores.
+//
+// JsonIndexer validates the input and returns the commas between the
+// array's elements. The elements are grouped into slices of about equal
+// size, and each slice is parsed and serialized as an array of its own on
+// the thread pool. With the brackets stripped, the slices concatenate to
+// exactly what JsonWriter::toJson() writes for the whole document, so
+// output does not depend on the number of slices.
+//
+// Top-level objects are not split: QJsonObject orders keys, and that
+// order spans the whole object. Without thread support the slices are
+// formatted one after another.
+class JsonParallelFormatter
+{
+public:
+    // Below this size one QJsonDocument round trip is as fast
+    static constexpr qsizetype MinParallelSize = 1024 * 1024;
+    static constexpr qsizetype MinSliceSize = 256 * 1024;
+
+    // Same output as JsonWriter::toJson() of the parsed input, or a null
+    // QByteArray unless the input is a valid top-level array of two or
+    // more elements; the caller then falls back to one round trip.
+    // maxSlices defaults to sliceConcurrency().
+    static QByteArray format(QByteArrayView utf8, const JsonWriter::Indent& indent, int maxSlices = 0);
+
+    // Split points for at most maxSlices slices: each slice runs from one
+    // boundary to the next, where a boundary is the opening bracket, a
+    // separator or the closing bracket. Returned boundaries include both
+    // brackets.
+    static QList<qsizetype> sliceBoundaries(QByteArrayView utf8, const QList<qsizetype>& separators,
+                                            int maxSlices);
+
+    // Slices the thread pool can format at once
+    static int sliceConcurrency();
+};
+
+#endif // JSONPARALLELFORMATTER_H
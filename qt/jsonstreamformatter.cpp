@@ -0,0 +1,416 @@
+#include "jsonstreamformatter.h"
+#include <QFile>
+#include <QSaveFile>
+
+static bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static bool isHexDigit(char c)
+{
+    return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+JsonStreamFormatter::JsonStreamFormatter(QIODevice* output, const JsonWriter::Indent& indent)
+    : m_output(output)
+    , m_indent(indent)
+{
+    m_buffer.reserve(OutputBufferSize);
+}
+
+bool JsonStreamFormatter::fail(const QString& message, qint64 offset)
+{
+    if (m_errorOffset < 0) {
+        m_errorOffset = offset;
+        m_error = QStringLiteral("%1 at byte %2").arg(message).arg(offset);
+    }
+    return false;
+}
+
+bool JsonStreamFormatter::feed(QByteArrayView chunk)
+{
+    if (m_errorOffset >= 0)
+        return false;
+
+    const char* data = chunk.data();
+    const qsizetype size = chunk.size();
+    qsizetype i = 0;
+
+    while (i < size) {
+        const char c = data[i];
+
+        switch (m_state) {
+            case State::String: {
+                // Copy the run up to the next quote, backslash or control
+                // character in one go
+                qsizetype end = i;
+                while (end < size) {
+                    const unsigned char b = static_cast<unsigned char>(data[end]);
+                    if (b == '"' || b == '\\' || b < 0x20)
+                        break;
+                    ++end;
+                }
+                write(data + i, end - i);
+                i = end;
+                if (i == size)
+                    break;
+
+                const char special = data[i];
+                if (static_cast<unsigned char>(special) < 0x20)
+                    return fail(QStringLiteral("Control character in string"), m_offset + i);
+                write(special);
+                if (special == '\\')
+                    m_state = State::StringEscape;
+                else if (m_stringIsKey)
+                    m_state = State::Colon;
+                else
+                    endValue();
+                ++i;
+                break;
+            }
+            case State::StringEscape:
+                if (c == 'u') {
+                    m_hexRemaining = 4;
+                    m_state = State::StringUnicode;
+                } else if (c == '"' || c == '\\' || c == '/' || c == 'b' || c == 'f'
+                           || c == 'n' || c == 'r' || c == 't') {
+                    m_state = State::String;
+                } else {
+                    return fail(QStringLiteral("Invalid escape sequence"), m_offset + i);
+                }
+                write(c);
+                ++i;
+                break;
+            case State::StringUnicode:
+                if (!isHexDigit(c))
+                    return fail(QStringLiteral("Invalid \\u escape"), m_offset + i);
+                write(c);
+                if (--m_hexRemaining == 0)
+                    m_state = State::String;
+                ++i;
+                break;
+            case State::Number:
+                if (continueNumber(c)) {
+                    write(c);
+                    ++i;
+                } else if (!numberComplete()) {
+                    return fail(QStringLiteral("Invalid number"), m_offset + i);
+                } else {
+                    // The byte ending the number is handled in the next state
+                    endValue();
+                }
+                break;
+            case State::Literal:
+                if (c != m_literal[m_literalPos])
+                    return fail(QStringLiteral("Invalid literal"), m_offset + i);
+                write(c);
+                ++i;
+                if (m_literal[++m_literalPos] == '\0')
+                    endValue();
+                break;
+            default:
+                if (!processStructural(c, m_offset + i))
+                    return false;
+                ++i;
+                break;
+        }
+    }
+
+    m_offset += size;
+    return flush();
+}
+
+bool JsonStreamFormatter::processStructural(char c, qint64 offset)
+{
+    if (isWhitespace(c))
+        return true;
+
+    switch (m_state) {
+        case State::Value:
+            return beginValue(c, offset);
+        case State::FirstValueOrEnd:
+            if (c == ']') {
+                m_stack.chop(1);
+                write(']');
+                endValue();
+                return true;
+            }
+            writeNewline();
+            return beginValue(c, offset);
+        case State::KeyOrEnd:
+            if (c == '}') {
+                m_stack.chop(1);
+                write('}');
+                endValue();
+                return true;
+            }
+            writeNewline();
+            Q_FALLTHROUGH();
+        case State::Key:
+            if (c != '"')
+                return fail(QStringLiteral("Expected string key"), offset);
+            write('"');
+            m_stringIsKey = true;
+            m_state = State::String;
+            return true;
+        case State::Colon:
+            if (c != ':')
+                return fail(QStringLiteral("Expected ':'"), offset);
+            if (m_indent.compact)
+                write(':');
+            else
+                write(": ", 2);
+            m_state = State::Value;
+            return true;
+        case State::CommaOrEnd: {
+            const char open = m_stack.back();
+            if (c == ',') {
+                write(',');
+                writeNewline();
+                m_state = (open == '{') ? State::Key : State::Value;
+                return true;
+            }
+            if ((c == '}' && open == '{') || (c == ']' && open == '[')) {
+                m_stack.chop(1);
+                writeNewline();
+                write(c);
+                endValue();
+                return true;
+            }
+            return fail(open == '{' ? QStringLiteral("Expected ',' or '}'")
+                                    : QStringLiteral("Expected ',' or ']'"), offset);
+        }
+        case State::Done:
+            return fail(QStringLiteral("Unexpected data after document"), offset);
+        default:
+            return fail(QStringLiteral("Unexpected character"), offset);
+    }
+}
+
+bool JsonStreamFormatter::beginValue(char c, qint64 offset)
+{
+    switch (c) {
+        case '{':
+            write('{');
+            m_stack.append('{');
+            m_state = State::KeyOrEnd;
+            return true;
+        case '[':
+            write('[');
+            m_stack.append('[');
+            m_state = State::FirstValueOrEnd;
+            return true;
+        case '"':
+            write('"');
+            m_stringIsKey = false;
+            m_state = State::String;
+            return true;
+        case 't':
+            m_literal = "true";
+            break;
+        case 'f':
+            m_literal = "false";
+            break;
+        case 'n':
+            m_literal = "null";
+            break;
+        default:
+            if (c == '-' || isDigit(c)) {
+                m_numberState = (c == '-') ? NumberState::Minus
+                              : (c == '0') ? NumberState::Zero : NumberState::Int;
+                m_state = State::Number;
+                write(c);
+                return true;
+            }
+            return fail(QStringLiteral("Unexpected character"), offset);
+    }
+
+    write(c);
+    m_literalPos = 1;
+    m_state = State::Literal;
+    return true;
+}
+
+bool JsonStreamFormatter::continueNumber(char c)
+{
+    const bool digit = isDigit(c);
+    switch (m_numberState) {
+        case NumberState::Minus:
+            if (!digit)
+                return false;
+            m_numberState = (c == '0') ? NumberState::Zero : NumberState::Int;
+            return true;
+        case NumberState::Zero:
+        case NumberState::Int:
+        case NumberState::Frac:
+            if (digit && m_numberState != NumberState::Zero)
+                return true;
+            if (c == '.' && m_numberState != NumberState::Frac) {
+                m_numberState = NumberState::Dot;
+                return true;
+            }
+            if (c == 'e' || c == 'E') {
+                m_numberState = NumberState::ExpMark;
+                return true;
+            }
+            return false;
+        case NumberState::Dot:
+            if (!digit)
+                return false;
+            m_numberState = NumberState::Frac;
+            return true;
+        case NumberState::ExpMark:
+            if (c == '+' || c == '-') {
+                m_numberState = NumberState::ExpSign;
+                return true;
+            }
+            Q_FALLTHROUGH();
+        case NumberState::ExpSign:
+        case NumberState::Exp:
+            if (!digit)
+                return false;
+            m_numberState = NumberState::Exp;
+            return true;
+    }
+    return false;
+}
+
+bool JsonStreamFormatter::numberComplete() const
+{
+    return m_numberState == NumberState::Zero || m_numberState == NumberState::Int
+        || m_numberState == NumberState::Frac || m_numberState == NumberState::Exp;
+}
+
+void JsonStreamFormatter::endValue()
+{
+    m_state = m_stack.isEmpty() ? State::Done : State::CommaOrEnd;
+}
+
+bool JsonStreamFormatter::finish()
+{
+    if (m_errorOffset >= 0)
+        return false;
+
+    if (m_state == State::Number) {
+        if (!numberComplete())
+            return fail(QStringLiteral("Invalid number"), m_offset);
+        endValue();
+    }
+    if (m_state != State::Done)
+        return fail(QStringLiteral("Unexpected end of input"), m_offset);
+
+    return flush();
+}
+
+void JsonStreamFormatter::write(char c)
+{
+    m_buffer.append(c);
+    if (m_buffer.size() >= OutputBufferSize)
+        flush();
+}
+
+void JsonStreamFormatter::write(const char* data, qsizetype size)
+{
+    m_buffer.append(data, size);
+    if (m_buffer.size() >= OutputBufferSize)
+        flush();
+}
+
+void JsonStreamFormatter::writeNewline()
+{
+    if (m_indent.compact)
+        return;
+    m_buffer.append('\n');
+    if (m_indent.width > 0)
+        m_buffer.append(qsizetype(m_stack.size()) * m_indent.width, m_indent.character);
+    if (m_buffer.size() >= OutputBufferSize)
+        flush();
+}
+
+bool JsonStreamFormatter::flush()
+{
+    if (m_buffer.isEmpty())
+        return m_errorOffset < 0;
+
+    const qint64 written = m_output->write(m_buffer);
+    if (written != m_buffer.size()) {
+        m_buffer.clear();
+        return fail(QStringLiteral("Write failed: %1").arg(m_output->errorString()), m_offset);
+    }
+    m_bytesWritten += written;
+    m_buffer.clear();
+    return m_errorOffset < 0;
+}
+
+JsonStreamFormatter::FileResult JsonStreamFormatter::formatFile(const QString& inputPath,
+                                                                const QString& outputPath,
+                                                                const JsonWriter::Indent& indent,
+                                                                const ProgressCallback& progress)
+{
+    FileResult result;
+
+    QFile input(inputPath);
+    if (!input.open(QIODevice::ReadOnly)) {
+        result.error = QStringLiteral("Cannot open %1: %2").arg(inputPath, input.errorString());
+        return result;
+    }
+
+    QSaveFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly)) {
+        result.error = QStringLiteral("Cannot write %1: %2").arg(outputPath, output.errorString());
+        return result;
+    }
+
+    JsonStreamFormatter formatter(&output, indent);
+    const qint64 total = input.size();
+    QByteArray chunk(ChunkSize, Qt::Uninitialized);
+    int lastPercent = -1;
+
+    while (true) {
+        const qint64 read = input.read(chunk.data(), chunk.size());
+        if (read < 0) {
+            result.error = QStringLiteral("Read failed: %1").arg(input.errorString());
+            break;
+        }
+        if (read == 0) {
+            if (!formatter.finish())
+                result.error = formatter.errorString();
+            break;
+        }
+        if (!formatter.feed(QByteArrayView(chunk.constData(), read))) {
+            result.error = formatter.errorString();
+            break;
+        }
+
+        const int percent = total > 0 ? int(formatter.bytesRead() * 100 / total) : 100;
+        if (progress && percent != lastPercent) {
+            lastPercent = percent;
+            if (!progress(percent)) {
+                result.canceled = true;
+                result.error = QStringLiteral("Canceled");
+                break;
+            }
+        }
+    }
+
+    result.bytesRead = formatter.bytesRead();
+    result.bytesWritten = formatter.bytesWritten();
+
+    if (!result.error.isEmpty()) {
+        output.cancelWriting();
+        return result;
+    }
+    if (!output.commit()) {
+        result.error = QStringLiteral("Cannot write %1: %2").arg(outputPath, output.errorString());
+        return result;
+    }
+
+    result.success = true;
+    return result;
+}
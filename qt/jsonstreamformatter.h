@@ -0,0 +1,109 @@
+#ifndef JSONSTREAMFORMATTER_H
+#define JSONSTREAMFORMATTER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <functional>
+#include "jsonwriter.h"
+
+class QIODevice;
+
+// Token-level JSON reformatter for inputs too large to hold in memory.
+//
+// Input is pushed in chunks of UTF-8 and re-emitted with new whitespace
+// as it is read; no document is built. Strings, numbers and literals are
+// copied verbatim, so escapes and number spellings are preserved. The
+// input is validated along the way (structure, strings, escapes, number
+// and literal syntax) and the first error stops processing with its byte
+// offset. Memory use is the output buffer plus one byte per nesting level.
+class JsonStreamFormatter
+{
+public:
+    static constexpr qsizetype ChunkSize = 1 << 20;
+    static constexpr qsizetype OutputBufferSize = 1 << 16;
+
+    // Writes to output, which must already be open
+    JsonStreamFormatter(QIODevice* output, const JsonWriter::Indent& indent);
+
+    // Processes the next chunk; returns false once an error is found
+    bool feed(QByteArrayView chunk);
+    // Checks that the document is complete and flushes the output
+    bool finish();
+
+    QString errorString() const { return m_error; }
+    // Byte offset of the error in the input, -1 if none
+    qint64 errorOffset() const { return m_errorOffset; }
+    qint64 bytesRead() const { return m_offset; }
+    qint64 bytesWritten() const { return m_bytesWritten; }
+
+    struct FileResult {
+        bool success = false;
+        bool canceled = false;
+        QString error;
+        qint64 bytesRead = 0;
+        qint64 bytesWritten = 0;
+    };
+
+    // Progress callback returns false when formatting should stop
+    using ProgressCallback = std::function<bool(int percent)>;
+
+    // Reformats inputPath into outputPath in ChunkSize reads. The output
+    // is written through QSaveFile, so it only replaces outputPath once
+    // the whole input was formatted successfully.
+    static FileResult formatFile(const QString& inputPath, const QString& outputPath,
+                                 const JsonWriter::Indent& indent,
+                                 const ProgressCallback& progress = nullptr);
+
+private:
+    enum class State {
+        Value,          // Expecting a value
+        FirstValueOrEnd,// After '[': a value or ']'
+        KeyOrEnd,       // After '{': a key or '}'
+        Key,            // After ',' in an object
+        Colon,
+        CommaOrEnd,     // After a value inside a container
+        Done,           // Top-level value complete
+        String,
+        StringEscape,
+        StringUnicode,
+        Number,
+        Literal
+    };
+
+    enum class NumberState { Minus, Zero, Int, Dot, Frac, ExpMark, ExpSign, Exp };
+
+    bool fail(const QString& message, qint64 offset);
+    // Handles one byte outside strings; false on error
+    bool processStructural(char c, qint64 offset);
+    bool beginValue(char c, qint64 offset);
+    // Advances the number grammar; returns false at the first byte that
+    // is not part of the number
+    bool continueNumber(char c);
+    bool numberComplete() const;
+    void endValue();
+
+    void write(char c);
+    void write(const char* data, qsizetype size);
+    void writeNewline();
+    bool flush();
+
+    QIODevice* m_output;
+    JsonWriter::Indent m_indent;
+    QByteArray m_buffer;
+    QByteArray m_stack;     // '{' or '[' per open container
+
+    State m_state = State::Value;
+    NumberState m_numberState = NumberState::Int;
+    const char* m_literal = nullptr;
+    int m_literalPos = 0;
+    int m_hexRemaining = 0;
+    bool m_stringIsKey = false;
+
+    qint64 m_offset = 0;
+    qint64 m_bytesWritten = 0;
+    qint64 m_errorOffset = -1;
+    QString m_error;
+};
+
+#endif // JSONSTREAMFORMATTER_H
@@ -0,0 +1,235 @@
+#include "jsonwriter.h"
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QLocale>
+#include <cmath>
+
+namespace {
+
+// Escape for each ASCII character: 0 copies it as is, 'u' writes \u00XX,
+// anything else is the character following the backslash
+constexpr char EscapeTable[128] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 't', 'n', 'u', 'u', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 'u'
+};
+
+constexpr char HexDigits[] = "0123456789abcdef";
+
+// Bounds the scratch space reserved per step; the worst case is six
+// output bytes per UTF-16 unit
+constexpr qsizetype EscapeChunk = 4096;
+constexpr qsizetype MaxBytesPerUnit = 6;
+
+inline char* writeUnicodeEscape(char* out, char16_t c)
+{
+    *out++ = '\\';
+    *out++ = 'u';
+    *out++ = '0';
+    *out++ = '0';
+    *out++ = HexDigits[(c >> 4) & 0xF];
+    *out++ = HexDigits[c & 0xF];
+    return out;
+}
+
+} // namespace
+
+JsonWriter::Indent JsonWriter::Indent::fromString(const QString& indentType)
+{
+    Indent indent;
+    if (indentType == QLatin1String("tabs")) {
+        indent.character = '\t';
+        indent.width = 1;
+    } else if (indentType.startsWith(QLatin1String("spaces:"))) {
+        bool ok = false;
+        const int width = indentType.mid(7).toInt(&ok);
+        if (ok && width >= 0)
+            indent.width = width;
+    }
+    return indent;
+}
+
+JsonWriter::Indent JsonWriter::Indent::minified()
+{
+    Indent indent;
+    indent.compact = true;
+    return indent;
+}
+
+JsonWriter::JsonWriter(const Indent& indent)
+    : m_indent(indent)
+{
+}
+
+void JsonWriter::writeNewline(int level)
+{
+    m_buffer.append('\n');
+    if (level > 0 && m_indent.width > 0)
+        m_buffer.append(qsizetype(level) * m_indent.width, m_indent.character);
+}
+
+void JsonWriter::writeValue(const QJsonValue& value, int level)
+{
+    switch (value.type()) {
+        case QJsonValue::Object: {
+            const QJsonObject object = value.toObject();
+            if (object.isEmpty()) {
+                m_buffer.append("{}", 2);
+                return;
+            }
+            m_buffer.append('{');
+            bool first = true;
+            for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+                if (!first)
+                    m_buffer.append(',');
+                first = false;
+                if (!m_indent.compact)
+                    writeNewline(level + 1);
+                writeString(it.key());
+                if (m_indent.compact)
+                    m_buffer.append(':');
+                else
+                    m_buffer.append(": ", 2);
+                writeValue(it.value(), level + 1);
+            }
+            if (!m_indent.compact)
+                writeNewline(level);
+            m_buffer.append('}');
+            return;
+        }
+        case QJsonValue::Array: {
+            const QJsonArray array = value.toArray();
+            if (array.isEmpty()) {
+                m_buffer.append("[]", 2);
+                return;
+            }
+            m_buffer.append('[');
+            bool first = true;
+            for (const QJsonValue& element : array) {
+                if (!first)
+                    m_buffer.append(',');
+                first = false;
+                if (!m_indent.compact)
+                    writeNewline(level + 1);
+                writeValue(element, level + 1);
+            }
+            if (!m_indent.compact)
+                writeNewline(level);
+            m_buffer.append(']');
+            return;
+        }
+        case QJsonValue::String:
+            writeString(value.toString());
+            return;
+        case QJsonValue::Double:
+            writeNumber(value.toDouble());
+            return;
+        case QJsonValue::Bool:
+            writeBool(value.toBool());
+            return;
+        case QJsonValue::Null:
+        case QJsonValue::Undefined:
+            writeNull();
+            return;
+    }
+}
+
+void JsonWriter::writeString(QStringView text)
+{
+    m_buffer.append('"');
+
+    const char16_t* p = text.utf16();
+    const char16_t* const end = p + text.size();
+    while (p < end) {
+        // Grow once per chunk and write through a raw pointer; the unused
+        // tail is cut off afterwards
+        const char16_t* const chunkEnd = p + qMin(EscapeChunk, qsizetype(end - p));
+        const qsizetype start = m_buffer.size();
+        m_buffer.resize(start + (chunkEnd - p) * MaxBytesPerUnit);
+        char* out = m_buffer.data() + start;
+
+        while (p < chunkEnd) {
+            const char16_t c = *p++;
+            if (c < 0x80) {
+                const char escape = EscapeTable[c];
+                if (!escape) {
+                    *out++ = char(c);
+                } else if (escape == 'u') {
+                    out = writeUnicodeEscape(out, c);
+                } else {
+                    *out++ = '\\';
+                    *out++ = escape;
+                }
+            } else if (c < 0x800) {
+                if (c < 0xA0) {
+                    // C1 control characters
+                    out = writeUnicodeEscape(out, c);
+                } else {
+                    *out++ = char(0xC0 | (c >> 6));
+                    *out++ = char(0x80 | (c & 0x3F));
+                }
+            } else if (QChar::isHighSurrogate(c) && p < end && QChar::isLowSurrogate(*p)) {
+                // A pair may straddle the chunk end; four bytes fit in the
+                // six reserved for its first unit
+                const char32_t codePoint = QChar::surrogateToUcs4(c, *p++);
+                *out++ = char(0xF0 | (codePoint >> 18));
+                *out++ = char(0x80 | ((codePoint >> 12) & 0x3F));
+                *out++ = char(0x80 | ((codePoint >> 6) & 0x3F));
+                *out++ = char(0x80 | (codePoint & 0x3F));
+            } else {
+                // Lone surrogates become U+FFFD, as in QString::toUtf8()
+                const char16_t unit = QChar::isSurrogate(c) ? char16_t(0xFFFD) : c;
+                *out++ = char(0xE0 | (unit >> 12));
+                *out++ = char(0x80 | ((unit >> 6) & 0x3F));
+                *out++ = char(0x80 | (unit & 0x3F));
+            }
+        }
+        m_buffer.resize(out - m_buffer.constData());
+    }
+
+    m_buffer.append('"');
+}
+
+void JsonWriter::writeNumber(double value)
+{
+    if (!std::isfinite(value)) {
+        writeNull();
+    } else if (value >= -9007199254740992.0 && value <= 9007199254740992.0 && value == double(qint64(value))) {
+        m_buffer.append(QByteArray::number(qint64(value)));
+    } else {
+        m_buffer.append(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+    }
+}
+
+void JsonWriter::writeBool(bool value)
+{
+    if (value)
+        m_buffer.append("true", 4);
+    else
+        m_buffer.append("false", 5);
+}
+
+void JsonWriter::writeNull()
+{
+    m_buffer.append("null", 4);
+}
+
+QByteArray JsonWriter::toJson(const QJsonDocument& doc, const Indent& indent, qsizetype sizeHint)
+{
+    JsonWriter writer(indent);
+    if (sizeHint > 0)
+        writer.reserve(sizeHint);
+
+    if (doc.isObject())
+        writer.writeValue(doc.object());
+    else if (doc.isArray())
+        writer.writeValue(doc.array());
+    else
+        writer.writeNull();
+    return writer.take();
+}
@@ -0,0 +1,60 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QString>
+#include <QStringView>
+#include <utility>
+
+// Native JSON serializer writing UTF-8 straight into one buffer.
+//
+// Values are written recursively into a single QByteArray, with no
+// intermediate string per node, and strings are escaped in one pass over
+// their UTF-16 data using a lookup table for ASCII. Output follows the
+// Rust formatter: the configured indent per level, "key": value pairs,
+// "[]" and "{}" for empty containers, no trailing newline, control
+// characters as \u escapes. Object keys are written in QJsonObject order.
+class JsonWriter
+{
+public:
+    struct Indent {
+        char character = ' ';
+        int width = 4;          // Characters per level
+        bool compact = false;   // No whitespace at all
+
+        // Parses "spaces:N" or "tabs"; anything else is four spaces
+        static Indent fromString(const QString& indentType);
+        static Indent minified();
+    };
+
+    explicit JsonWriter(const Indent& indent = Indent());
+
+    void reserve(qsizetype bytes) { m_buffer.reserve(bytes); }
+
+    // Writes value as if nested level levels deep; the first line is not
+    // indented, so the result can follow a key or an opening bracket
+    void writeValue(const QJsonValue& value, int level = 0);
+    // Writes a quoted, escaped string
+    void writeString(QStringView text);
+    // Integral values within +/-2^53 are written without a fraction;
+    // non-finite values are written as null
+    void writeNumber(double value);
+    void writeBool(bool value);
+    void writeNull();
+
+    const QByteArray& buffer() const { return m_buffer; }
+    QByteArray take() { return std::exchange(m_buffer, QByteArray()); }
+
+    // Serializes a whole document; sizeHint pre-reserves the buffer
+    static QByteArray toJson(const QJsonDocument& doc, const Indent& indent, qsizetype sizeHint = 0);
+
+private:
+    void writeNewline(int level);
+
+    QByteArray m_buffer;
+    Indent m_indent;
+};
+
+#endif // JSONWRITER_H
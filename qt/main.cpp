@@ -3,6 +3,7 @@
 #include <QQmlContext>
 #include <QQuickStyle>
 #include "jsonbridge.h"
+#include "asyncserialiser.h"
 
 int main(int argc, char *argv[])
 {
@@ -33,5 +34,14 @@ int main(int argc, char *argv[])
 
     engine.load(url);
 
+    // AIRGAP_TRACE_FILE=<path> writes the session's task trace, with trace
+    // zones in AIRGAP_TRACING builds, on exit
+    const QString traceFile = qEnvironmentVariable("AIRGAP_TRACE_FILE");
+    if (!traceFile.isEmpty()) {
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, [traceFile]() {
+            AsyncSerialiser::instance().exportChromeTrace(traceFile);
+        });
+    }
+
     return app.exec();
 }
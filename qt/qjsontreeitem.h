@@ -3,51 +3,39 @@
 
 #include <QString>
 #include <QVariant>
-#include <QVector>
 #include <QJsonValue>
 #include <QJsonObject>
 #include <QJsonArray>
 
-class QJsonTreeItem
+// Flat node record. Nodes live contiguously in a QJsonTreeStore and refer
+// to each other by index; the children of a node occupy the contiguous
+// range [firstChild, firstChild + childCount).
+//
+// The value is kept as the QJsonValue taken from the parsed document: a
+// tagged value holding numbers and booleans inline, and strings and
+// containers as a reference into the document's storage. Nothing is
+// copied at load; strings are decoded when asked for.
+struct QJsonTreeItem
 {
-public:
     enum class Type { Object, Array, String, Number, Boolean, Null };
 
-    explicit QJsonTreeItem(QJsonTreeItem* parent = nullptr);
-    ~QJsonTreeItem();
+    int parent = -1;        // Index of parent node, -1 for the virtual root
+    int row = 0;            // Position within parent
+    int firstChild = -1;    // Index of first child, -1 until fetched
+    int childCount = 0;     // Logical count, known before children exist
+    int keyId = -1;         // Interned object key, -1 for array elements
+    int preorder = -1;      // Position of the value in document order, -1 for the virtual root
+    Type type = Type::Null;
+    QJsonValue source;      // The value; containers also fetch and serialize children from it
 
-    void appendChild(QJsonTreeItem* child);
-    QJsonTreeItem* child(int row) const;
-    int childCount() const;
-    int row() const;
-    QJsonTreeItem* parentItem() const;
-
-    // Data accessors
-    QString key() const;
-    void setKey(const QString& key);
-
-    QVariant value() const;
-    void setValue(const QVariant& value);
-
-    Type type() const;
-    void setType(Type type);
-
-    QString typeName() const;
-    QString jsonPath() const;
+    bool childrenFetched() const { return childCount == 0 || firstChild >= 0; }
     bool isExpandable() const;
 
-    // Serialization for copy functionality
-    QString toJsonString(int indentLevel = 0) const;
-
-    // Factory method to build tree from JSON
-    static QJsonTreeItem* load(const QJsonValue& value, QJsonTreeItem* parent = nullptr);
+    static QString typeName(Type type);
+    static Type typeOf(const QJsonValue& value);
 
-private:
-    QVector<QJsonTreeItem*> m_children;
-    QJsonTreeItem* m_parent;
-    QString m_key;
-    QVariant m_value;
-    Type m_type;
+    // Value helper shared by the store and serialization
+    static QVariant scalarValue(const QJsonValue& value);
 };
 
 #endif // QJSONTREEITEM_H
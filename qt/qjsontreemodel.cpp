@@ -1,18 +1,26 @@
 #include "qjsontreemodel.h"
+#include "airgaptrace.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDebug>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <utility>
+
+#if defined(AIRGAP_HAS_CONCURRENT) && QT_CONFIG(thread)
+#include <QtConcurrent/QtConcurrentRun>
+#define AIRGAP_TREE_BUILD_THREADED 1
+#endif
 
 QJsonTreeModel::QJsonTreeModel(QObject* parent)
     : QAbstractItemModel(parent)
-    , m_rootItem(nullptr)
 {
 }
 
 QJsonTreeModel::~QJsonTreeModel()
 {
-    delete m_rootItem;
+    cancelLoad();
 }
 
 QModelIndex QJsonTreeModel::index(int row, int column, const QModelIndex& parent) const
@@ -20,19 +28,14 @@ QModelIndex QJsonTreeModel::index(int row, int column, const QModelIndex& parent
     if (!hasIndex(row, column, parent))
         return QModelIndex();
 
-    QJsonTreeItem* parentItem;
-    if (!parent.isValid()) {
-        parentItem = m_rootItem;
-    } else {
-        parentItem = static_cast<QJsonTreeItem*>(parent.internalPointer());
-    }
-
-    if (!parentItem)
+    const int parentId = idForIndex(parent);
+    if (parentId < 0)
         return QModelIndex();
 
-    QJsonTreeItem* childItem = parentItem->child(row);
-    if (childItem)
-        return createIndex(row, column, childItem);
+    // First access to a row under this parent materializes its children
+    const int childId = m_store.childId(parentId, row);
+    if (childId >= 0)
+        return createIndex(row, column, quintptr(childId));
 
     return QModelIndex();
 }
@@ -42,16 +45,16 @@ QModelIndex QJsonTreeModel::parent(const QModelIndex& index) const
     if (!index.isValid())
         return QModelIndex();
 
-    QJsonTreeItem* childItem = static_cast<QJsonTreeItem*>(index.internalPointer());
-    if (!childItem)
+    const int childId = idForIndex(index);
+    if (childId < 0)
         return QModelIndex();
 
-    QJsonTreeItem* parentItem = childItem->parentItem();
-
-    if (!parentItem || parentItem == m_rootItem)
+    // Parent id and row are stored inline: O(1), no sibling scan
+    const int parentId = m_store.node(childId).parent;
+    if (parentId <= QJsonTreeStore::RootId)
         return QModelIndex();
 
-    return createIndex(parentItem->row(), 0, parentItem);
+    return createIndex(m_store.node(parentId).row, 0, quintptr(parentId));
 }
 
 int QJsonTreeModel::rowCount(const QModelIndex& parent) const
@@ -59,17 +62,12 @@ int QJsonTreeModel::rowCount(const QModelIndex& parent) const
     if (parent.column() > 0)
         return 0;
 
-    QJsonTreeItem* parentItem;
-    if (!parent.isValid()) {
-        parentItem = m_rootItem;
-    } else {
-        parentItem = static_cast<QJsonTreeItem*>(parent.internalPointer());
-    }
-
-    if (!parentItem)
+    const int parentId = idForIndex(parent);
+    if (parentId < 0)
         return 0;
 
-    return parentItem->childCount();
+    // Logical count from the source value; does not create child items
+    return m_store.node(parentId).childCount;
 }
 
 int QJsonTreeModel::columnCount(const QModelIndex& parent) const
@@ -78,46 +76,68 @@ int QJsonTreeModel::columnCount(const QModelIndex& parent) const
     return 1;
 }
 
+// Scalars are decoded from the document when a delegate asks. Long strings
+// are cut for display; serializeNode() copies them whole.
+static QVariant displayValue(const QJsonTreeItem& item)
+{
+    if (item.type != QJsonTreeItem::Type::String)
+        return QJsonTreeItem::scalarValue(item.source);
+
+    const QString text = item.source.toString();
+    if (text.size() <= QJsonTreeModel::MaxDisplayLength)
+        return text;
+
+    // Never split a surrogate pair
+    qsizetype cut = QJsonTreeModel::MaxDisplayLength;
+    if (text.at(cut - 1).isHighSurrogate())
+        --cut;
+    return QString(text.first(cut) + QChar(0x2026));
+}
+
 QVariant QJsonTreeModel::data(const QModelIndex& index, int role) const
 {
     if (!index.isValid())
         return QVariant();
 
-    QJsonTreeItem* item = static_cast<QJsonTreeItem*>(index.internalPointer());
-    if (!item)
+    const int id = idForIndex(index);
+    if (id < 0)
         return QVariant();
 
+    const QJsonTreeItem& item = m_store.node(id);
+
     switch (role) {
         case KeyRole:
-            return item->key();
+            return m_store.key(id);
         case ValueRole:
-            return item->value();
+            return displayValue(item);
         case ValueTypeRole:
-            return item->typeName();
+            return QJsonTreeItem::typeName(item.type);
         case JsonPathRole:
-            return item->jsonPath();
+            return cachedJsonPath(id);
         case ChildCountRole:
-            return item->childCount();
+            return item.childCount;
         case IsExpandableRole:
-            return item->isExpandable();
+            return item.isExpandable();
         case IsLastChildRole: {
-            QJsonTreeItem* parent = item->parentItem();
-            if (!parent)
+            if (item.parent < 0)
                 return false;
-            return (parent->childCount() - 1) == index.row();
+            return (m_store.node(item.parent).childCount - 1) == index.row();
         }
         case ParentValueTypeRole: {
-            QJsonTreeItem* parent = item->parentItem();
-            if (!parent)
+            if (item.parent < 0)
                 return QString();
-            return parent->typeName();
+            return QJsonTreeItem::typeName(m_store.node(item.parent).type);
         }
-        case Qt::DisplayRole:
+        case DescendantCountRole:
+            return m_store.descendantCount(id);
+        case Qt::DisplayRole: {
             // For display, combine key and value
-            if (item->key().isEmpty()) {
-                return item->value();
+            const QString key = m_store.key(id);
+            if (key.isEmpty()) {
+                return displayValue(item);
             }
-            return item->key() + ": " + item->value().toString();
+            return key + ": " + displayValue(item).toString();
+        }
         default:
             return QVariant();
     }
@@ -133,69 +153,238 @@ QHash<int, QByteArray> QJsonTreeModel::roleNames() const
         {ChildCountRole, "childCount"},
         {IsExpandableRole, "isExpandable"},
         {IsLastChildRole, "isLastChild"},
-        {ParentValueTypeRole, "parentValueType"}
+        {ParentValueTypeRole, "parentValueType"},
+        {DescendantCountRole, "descendantCount"}
     };
 }
 
-bool QJsonTreeModel::loadJson(const QString& jsonString)
+bool QJsonTreeModel::canFetchMore(const QModelIndex& parent) const
 {
-    beginResetModel();
+    const int id = idForIndex(parent);
+    return id >= 0 && !m_store.node(id).childrenFetched();
+}
 
-    delete m_rootItem;
-    m_rootItem = nullptr;
+void QJsonTreeModel::fetchMore(const QModelIndex& parent)
+{
+    AIRGAP_TRACE_ZONE("QJsonTreeModel::fetchMore");
+    // rowCount() already reports the logical child count, so fetching only
+    // creates the backing items; no rows are inserted
+    const int id = idForIndex(parent);
+    if (id >= 0)
+        m_store.fetchChildren(id);
+}
 
-    if (jsonString.trimmed().isEmpty()) {
-        endResetModel();
+QJsonTreeModel::BuildResult QJsonTreeModel::buildStore(const QString& jsonString,
+                                                       const ProgressCallback& progress,
+                                                       const DocumentSource& source)
+{
+    AIRGAP_TRACE_ZONE("QJsonTreeModel::buildStore");
+    BuildResult result;
+    int reported = -1;
+    auto report = [&](int percent) {
+        if (percent == reported)
+            return true;
+        reported = percent;
+        if (progress && !progress(percent)) {
+            result.canceled = true;
+            return false;
+        }
         return true;
+    };
+
+    if (jsonString.trimmed().isEmpty()) {
+        result.success = true;
+        report(100);
+        return result;
     }
 
+    if (!report(0))
+        return result;
+
+    const QByteArray utf8 = jsonString.toUtf8();
+    if (!report(10))
+        return result;
+
     QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(jsonString.toUtf8(), &error);
+    QJsonDocument doc;
+    {
+        AIRGAP_TRACE_ZONE("QJsonTreeModel::buildStore parse");
+        doc = source ? source(utf8, &error) : QJsonDocument::fromJson(utf8, &error);
+    }
 
     if (error.error != QJsonParseError::NoError) {
-        emit loadError(error.errorString());
-        endResetModel();
-        return false;
+        result.error = error.errorString();
+        return result;
     }
+    if (!report(WalkStartPercent))
+        return result;
+
+    // The walk over every value is the longest step; it reports how far it
+    // got and stops as soon as the build is canceled
+    const bool loaded = loadStore(result.store, doc, [&report](double fraction) {
+        return report(WalkStartPercent + int(fraction * (100 - WalkStartPercent)));
+    });
+    if (!loaded)
+        return result;
+
+    result.success = true;
+    report(100);
+    return result;
+}
+
+bool QJsonTreeModel::loadStore(QJsonTreeStore& store, const QJsonDocument& doc,
+                               const QJsonTreeStore::LoadProgress& progress)
+{
+    AIRGAP_TRACE_ZONE("QJsonTreeModel::loadStore");
+    // The store creates a virtual root to hold the actual JSON root
+    if (doc.isObject())
+        return store.load(doc.object(), progress);
+    if (doc.isArray())
+        return store.load(doc.array(), progress);
+    // Handle root-level primitives (less common but valid)
+    return store.load(QJsonValue(), progress);
+}
 
-    // Create a virtual root to hold the actual JSON root
-    m_rootItem = new QJsonTreeItem();
-    m_rootItem->setType(QJsonTreeItem::Type::Object);
+QJsonTreeModel::BuildResult QJsonTreeModel::buildStore(const QJsonDocument& doc)
+{
+    AIRGAP_TRACE_ZONE("QJsonTreeModel::buildStore document");
+    BuildResult result;
+    loadStore(result.store, doc);
+    result.success = true;
+    return result;
+}
 
-    QJsonTreeItem* jsonRoot;
-    if (doc.isObject()) {
-        jsonRoot = QJsonTreeItem::load(doc.object(), m_rootItem);
-    } else if (doc.isArray()) {
-        jsonRoot = QJsonTreeItem::load(doc.array(), m_rootItem);
+bool QJsonTreeModel::applyBuildResult(BuildResult&& result)
+{
+    AIRGAP_TRACE_ZONE("QJsonTreeModel::applyBuildResult");
+    // A store built elsewhere supersedes any background load
+    cancelLoad();
+    // The finished store replaces the old one within a single reset, so
+    // views never observe a partially built tree
+    beginResetModel();
+    if (result.success) {
+        m_store = std::move(result.store);
     } else {
-        // Handle root-level primitives (less common but valid)
-        jsonRoot = QJsonTreeItem::load(QJsonValue(), m_rootItem);
+        m_store.clear();
+    }
+    m_pathCache.clear();
+    {
+        // Attached views rebuild their delegates here
+        AIRGAP_TRACE_ZONE("QJsonTreeModel::endResetModel");
+        endResetModel();
     }
 
-    m_rootItem->appendChild(jsonRoot);
+    if (!result.success)
+        emit loadError(result.error);
 
-    endResetModel();
-    return true;
+    return result.success;
+}
+
+bool QJsonTreeModel::loadJson(const QString& jsonString)
+{
+    AIRGAP_TRACE_ZONE("QJsonTreeModel::loadJson");
+    return applyBuildResult(buildStore(jsonString, nullptr));
+}
+
+bool QJsonTreeModel::loadDocument(const QJsonDocument& doc)
+{
+    AIRGAP_TRACE_ZONE("QJsonTreeModel::loadDocument");
+    return applyBuildResult(buildStore(doc));
+}
+
+void QJsonTreeModel::loadJsonAsync(const QString& jsonString)
+{
+    loadJsonAsync(jsonString, nullptr);
+}
+
+void QJsonTreeModel::loadJsonAsync(const QString& jsonString, DocumentSource source)
+{
+    cancelLoad();
+    const quint64 generation = ++m_loadGeneration;
+
+#ifdef AIRGAP_TREE_BUILD_THREADED
+    m_loadWatcher = new QFutureWatcher<BuildResult>(this);
+    QFutureWatcher<BuildResult>* watcher = m_loadWatcher;
+
+    connect(watcher, &QFutureWatcherBase::progressValueChanged,
+            this, [this, generation](int percent) {
+        if (generation == m_loadGeneration)
+            emit loadProgress(percent);
+    });
+    connect(watcher, &QFutureWatcherBase::finished,
+            this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation != m_loadGeneration || watcher->isCanceled())
+            return;
+
+        m_loadWatcher = nullptr;
+        BuildResult result = watcher->future().takeResult();
+        if (result.canceled)
+            return;
+
+        emit loadFinished(applyBuildResult(std::move(result)));
+    });
+
+    watcher->setFuture(QtConcurrent::run([source](QPromise<BuildResult>& promise, const QString& json) {
+        promise.setProgressRange(0, 100);
+        BuildResult result = buildStore(json, [&promise](int percent) {
+            promise.setProgressValue(percent);
+            return !promise.isCanceled();
+        }, source);
+        if (!result.canceled)
+            promise.addResult(std::move(result));
+    }, jsonString));
+#else
+    // Single-threaded builds (e.g. Qt for WebAssembly without pthreads):
+    // build on the next event loop turn so the caller still returns first
+    // and a newer load queued before then supersedes this one
+    QTimer::singleShot(0, this, [this, generation, jsonString, source]() {
+        if (generation != m_loadGeneration)
+            return;
+        BuildResult result = buildStore(jsonString, [this, generation](int percent) {
+            emit loadProgress(percent);
+            return generation == m_loadGeneration;
+        }, source);
+        if (result.canceled)
+            return;
+        emit loadFinished(applyBuildResult(std::move(result)));
+    });
+#endif
+}
+
+void QJsonTreeModel::cancelLoad()
+{
+    // Bumping the generation invalidates any pending completion
+    ++m_loadGeneration;
+
+    if (m_loadWatcher) {
+        m_loadWatcher->disconnect(this);
+        m_loadWatcher->cancel();
+        m_loadWatcher->deleteLater();
+        m_loadWatcher = nullptr;
+    }
 }
 
 void QJsonTreeModel::clear()
 {
+    cancelLoad();
     beginResetModel();
-    delete m_rootItem;
-    m_rootItem = nullptr;
+    m_store.clear();
+    m_pathCache.clear();
     endResetModel();
 }
 
-QString QJsonTreeModel::serializeNode(const QModelIndex& index) const
+QString QJsonTreeModel::serializeNode(const QModelIndex& index, const QString& indentType) const
 {
+    AIRGAP_TRACE_ZONE("QJsonTreeModel::serializeNode");
     if (!index.isValid())
         return QString();
 
-    QJsonTreeItem* item = static_cast<QJsonTreeItem*>(index.internalPointer());
-    if (!item)
+    const int id = idForIndex(index);
+    if (id < 0)
         return QString();
 
-    return item->toJsonString();
+    return QString::fromUtf8(m_store.toJson(id, JsonWriter::Indent::fromString(indentType)));
 }
 
 QString QJsonTreeModel::getJsonPath(const QModelIndex& index) const
@@ -203,29 +392,84 @@ QString QJsonTreeModel::getJsonPath(const QModelIndex& index) const
     if (!index.isValid())
         return QString();
 
-    QJsonTreeItem* item = static_cast<QJsonTreeItem*>(index.internalPointer());
-    if (!item)
+    const int id = idForIndex(index);
+    if (id < 0)
         return QString();
 
-    return item->jsonPath();
+    return cachedJsonPath(id);
+}
+
+QModelIndexList QJsonTreeModel::search(const QString& query, int flags, int limit, const QModelIndex& after) const
+{
+    AIRGAP_TRACE_ZONE("QJsonTreeModel::search");
+    QModelIndexList matches;
+    if (m_store.isEmpty() || query.isEmpty() || limit <= 0)
+        return matches;
+
+    // A path names at most one node
+    if (flags & SearchPath) {
+        const int id = m_store.idForPath(query);
+        if (id >= 0 && !after.isValid())
+            matches.append(indexForId(id));
+        return matches;
+    }
+
+    const int afterId = after.isValid() ? idForIndex(after) : -1;
+    const int afterPreorder = afterId > QJsonTreeStore::RootId ? m_store.node(afterId).preorder : -1;
+    const QVector<int> found = m_store.searchIndex().find(query, flags, afterPreorder, limit);
+    matches.reserve(found.size());
+    for (const int preorder : found)
+        matches.append(indexForId(m_store.idForPreorder(preorder)));
+    return matches;
+}
+
+int QJsonTreeModel::searchCount(const QString& query, int flags) const
+{
+    if (flags & SearchPath)
+        return search(query, flags, 1).size();
+    return m_store.searchIndex().count(query, flags);
 }
 
 int QJsonTreeModel::totalNodeCount() const
 {
-    if (!m_rootItem)
+    if (m_store.isEmpty())
         return 0;
 
-    return countNodes(m_rootItem);
+    return m_store.subtreeNodeCount(QJsonTreeStore::RootId);
 }
 
-int QJsonTreeModel::countNodes(QJsonTreeItem* item) const
+int QJsonTreeModel::maxDepth() const
 {
-    if (!item)
-        return 0;
+    return m_store.isEmpty() ? -1 : m_store.maxDepth();
+}
 
-    int count = 1;  // Count this node
-    for (int i = 0; i < item->childCount(); ++i) {
-        count += countNodes(item->child(i));
-    }
-    return count;
+int QJsonTreeModel::expandDepthForBudget(int maxVisibleNodes) const
+{
+    return m_store.isEmpty() ? -1 : m_store.expandDepthForBudget(maxVisibleNodes);
+}
+
+int QJsonTreeModel::idForIndex(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return m_store.isEmpty() ? -1 : QJsonTreeStore::RootId;
+
+    const int id = static_cast<int>(index.internalId());
+    return m_store.isValidId(id) ? id : -1;
+}
+
+QString QJsonTreeModel::cachedJsonPath(int id) const
+{
+    if (const QString* path = m_pathCache.object(id))
+        return *path;
+
+    const QString path = m_store.jsonPath(id);
+    m_pathCache.insert(id, new QString(path));
+    return path;
+}
+
+QModelIndex QJsonTreeModel::indexForId(int id) const
+{
+    if (id <= QJsonTreeStore::RootId)
+        return QModelIndex();
+    return createIndex(m_store.node(id).row, 0, quintptr(id));
 }
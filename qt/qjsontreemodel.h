@@ -2,8 +2,12 @@
 #define QJSONTREEMODEL_H
 
 #include <QAbstractItemModel>
+#include <QCache>
 #include <QJsonDocument>
-#include "qjsontreeitem.h"
+#include <functional>
+#include "qjsontreestore.h"
+
+template <typename T> class QFutureWatcher;
 
 class QJsonTreeModel : public QAbstractItemModel
 {
@@ -18,10 +22,26 @@ public:
         ChildCountRole,
         IsExpandableRole,
         IsLastChildRole,
-        ParentValueTypeRole
+        ParentValueTypeRole,
+        DescendantCountRole
     };
     Q_ENUM(Roles)
 
+    enum SearchFlag {
+        SearchKeys = QJsonTreeSearchIndex::Keys,
+        SearchValues = QJsonTreeSearchIndex::Values,
+        CaseSensitive = QJsonTreeSearchIndex::CaseSensitive,
+        WholeMatch = QJsonTreeSearchIndex::WholeMatch,
+        SearchPath = 0x10         // The query is a path as getJsonPath() returns
+    };
+    Q_ENUM(SearchFlag)
+    static constexpr int DefaultSearchLimit = 100;
+    // Paths built for JsonPathRole and getJsonPath() that are kept
+    static constexpr int PathCacheSize = 128;
+    // Longer strings are truncated with an ellipsis in ValueRole and
+    // Qt::DisplayRole
+    static constexpr int MaxDisplayLength = 1000;
+
     explicit QJsonTreeModel(QObject* parent = nullptr);
     ~QJsonTreeModel() override;
 
@@ -33,24 +53,87 @@ public:
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
 
+    // Lazy loading: child items are materialized on first access. The store
+    // still walks the whole document once at load, for counts and search.
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    struct BuildResult
+    {
+        QJsonTreeStore store;
+        QString error;
+        bool success = false;
+        bool canceled = false;
+    };
+
     // JSON loading
     Q_INVOKABLE bool loadJson(const QString& jsonString);
+    // Loads an already parsed document, skipping the parse
+    bool loadDocument(const QJsonDocument& doc);
     Q_INVOKABLE void clear();
 
+    // Builds the store for a parsed document without touching the model,
+    // so it can run on a worker thread. applyBuildResult() swaps the result
+    // in with a single model reset, superseding any background load.
+    static BuildResult buildStore(const QJsonDocument& doc);
+    bool applyBuildResult(BuildResult&& result);
+
+    // Background loading: parses and builds the node store on a worker
+    // thread, then swaps it in with a single model reset. Starting a new
+    // load cancels any build still in flight.
+    Q_INVOKABLE void loadJsonAsync(const QString& jsonString);
+    // source parses the UTF-8 input in place of QJsonDocument::fromJson,
+    // on the build thread; it may answer from a cache
+    using DocumentSource = std::function<QJsonDocument(const QByteArray& utf8, QJsonParseError* error)>;
+    void loadJsonAsync(const QString& jsonString, DocumentSource source);
+    Q_INVOKABLE void cancelLoad();
+
     // Serialization for copy functionality
-    Q_INVOKABLE QString serializeNode(const QModelIndex& index) const;
+    // indentType takes the formatter's values ("spaces:N", "tabs")
+    Q_INVOKABLE QString serializeNode(const QModelIndex& index,
+                                      const QString& indentType = QStringLiteral("spaces:2")) const;
     Q_INVOKABLE QString getJsonPath(const QModelIndex& index) const;
 
-    // Node counting for performance guard
+    // Search over the whole document, built while it loads. Returns the
+    // first limit matches in document order; passing the last one as
+    // `after` continues from there. Only the matches' ancestors are
+    // fetched.
+    Q_INVOKABLE QModelIndexList search(const QString& query, int flags = SearchKeys | SearchValues,
+                                       int limit = DefaultSearchLimit,
+                                       const QModelIndex& after = QModelIndex()) const;
+    Q_INVOKABLE int searchCount(const QString& query, int flags = SearchKeys | SearchValues) const;
+
+    // Node counting for performance guard (O(1), computed at load)
     Q_INVOKABLE int totalNodeCount() const;
+    Q_INVOKABLE int maxDepth() const;
+    Q_INVOKABLE int expandDepthForBudget(int maxVisibleNodes) const;
 
 signals:
     void loadError(const QString& error);
+    void loadProgress(int percent);
+    void loadFinished(bool success);
 
 private:
-    int countNodes(QJsonTreeItem* item) const;
+    // Progress callback returns false when the build should stop
+    using ProgressCallback = std::function<bool(int percent)>;
+    // Reported once parsing is done; the store walk fills the rest
+    static constexpr int WalkStartPercent = 40;
+    static BuildResult buildStore(const QString& jsonString, const ProgressCallback& progress,
+                                  const DocumentSource& source = nullptr);
+    static bool loadStore(QJsonTreeStore& store, const QJsonDocument& doc,
+                          const QJsonTreeStore::LoadProgress& progress = nullptr);
+
+    int idForIndex(const QModelIndex& index) const;
+    QModelIndex indexForId(int id) const;
+    QString cachedJsonPath(int id) const;
+
+    QFutureWatcher<BuildResult>* m_loadWatcher = nullptr;
+    quint64 m_loadGeneration = 0;
 
-    QJsonTreeItem* m_rootItem;
+    // Mutable: index() fetches children on first access
+    mutable QJsonTreeStore m_store;
+    // Least recently used paths by node id; node ids change on every load
+    mutable QCache<int, QString> m_pathCache {PathCacheSize};
 };
 
 #endif // QJSONTREEMODEL_H
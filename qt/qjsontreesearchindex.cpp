@@ -0,0 +1,186 @@
+#include "qjsontreesearchindex.h"
+#include "qjsontreeitem.h"
+#include <QVarLengthArray>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace {
+
+// Three UTF-16 code units packed into one key
+quint64 gramAt(const QString& text, qsizetype i)
+{
+    return (quint64(text.at(i).unicode()) << 32) | (quint64(text.at(i + 1).unicode()) << 16)
+        | quint64(text.at(i + 2).unicode());
+}
+
+QString valueText(const QJsonValue& value)
+{
+    return value.isNull() ? QStringLiteral("null") : QJsonTreeItem::scalarValue(value).toString();
+}
+
+bool matches(const QString& text, const QString& query, int flags)
+{
+    const Qt::CaseSensitivity cs = (flags & QJsonTreeSearchIndex::CaseSensitive) ? Qt::CaseSensitive
+                                                                                 : Qt::CaseInsensitive;
+    if (flags & QJsonTreeSearchIndex::WholeMatch)
+        return text.compare(query, cs) == 0;
+    return text.contains(query, cs);
+}
+
+} // namespace
+
+void QJsonTreeSearchIndex::clear()
+{
+    m_keys.clear();
+    m_keyPositions.clear();
+    m_valuePositions.clear();
+    m_valuePositions.squeeze();
+    m_values.clear();
+    m_values.squeeze();
+    m_grams.clear();
+    m_unindexed.clear();
+}
+
+void QJsonTreeSearchIndex::addKey(const QString& key)
+{
+    m_keys.append(key);
+    m_keyPositions.append(QVector<int>());
+}
+
+void QJsonTreeSearchIndex::addValue(int preorder, int keyId, const QJsonValue& value)
+{
+    if (keyId >= 0)
+        m_keyPositions[keyId].append(preorder);
+    if (value.isObject() || value.isArray())
+        return;
+
+    const int ordinal = m_values.size();
+    const QString text = valueText(value);
+    m_valuePositions.append(preorder);
+    m_values.append(value);
+
+    if (text.size() > MaxIndexedLength) {
+        m_unindexed.append(ordinal);
+        return;
+    }
+
+    // Each distinct trigram lists the value once
+    const QString folded = text.toCaseFolded();
+    QVarLengthArray<quint64, MaxIndexedLength> grams;
+    for (qsizetype i = 0; i + GramLength <= folded.size(); ++i)
+        grams.append(gramAt(folded, i));
+    std::sort(grams.begin(), grams.end());
+    const auto end = std::unique(grams.begin(), grams.end());
+    for (auto it = grams.begin(); it != end; ++it)
+        m_grams[*it].append(ordinal);
+}
+
+QVector<int> QJsonTreeSearchIndex::find(const QString& query, int flags, int after, int limit) const
+{
+    QVector<int> found;
+    if (query.isEmpty() || limit <= 0)
+        return found;
+
+    if (flags & Keys)
+        found = findKeys(query, flags, after, limit);
+    if (flags & Values) {
+        const QVector<int> values = findValues(query, flags, after, limit);
+        QVector<int> merged;
+        merged.reserve(found.size() + values.size());
+        // A scalar whose key and value both match is reported once
+        std::set_union(found.cbegin(), found.cend(), values.cbegin(), values.cend(), std::back_inserter(merged));
+        found = std::move(merged);
+    }
+
+    if (found.size() > limit)
+        found.resize(limit);
+    return found;
+}
+
+int QJsonTreeSearchIndex::count(const QString& query, int flags) const
+{
+    return int(find(query, flags, -1, std::numeric_limits<int>::max()).size());
+}
+
+QVector<int> QJsonTreeSearchIndex::findKeys(const QString& query, int flags, int after, int limit) const
+{
+    // Each matching key contributes at most limit positions; the first
+    // limit of their union are the first limit overall
+    QVector<int> found;
+    for (int keyId = 0; keyId < m_keys.size(); ++keyId) {
+        if (!matches(m_keys.at(keyId), query, flags))
+            continue;
+        const QVector<int>& positions = m_keyPositions.at(keyId);
+        auto it = std::upper_bound(positions.cbegin(), positions.cend(), after);
+        for (int taken = 0; it != positions.cend() && taken < limit; ++it, ++taken)
+            found.append(*it);
+    }
+
+    std::sort(found.begin(), found.end());
+    if (found.size() > limit)
+        found.resize(limit);
+    return found;
+}
+
+QVector<int> QJsonTreeSearchIndex::findValues(const QString& query, int flags, int after, int limit) const
+{
+    QVector<int> found;
+    const int start = int(std::upper_bound(m_valuePositions.cbegin(), m_valuePositions.cend(), after)
+                          - m_valuePositions.cbegin());
+    const auto accept = [&](int ordinal) {
+        if (matches(valueText(m_values.at(ordinal)), query, flags))
+            found.append(m_valuePositions.at(ordinal));
+        return found.size() < limit;
+    };
+
+    const QString folded = query.toCaseFolded();
+    if (folded.size() < GramLength) {
+        for (int ordinal = start; ordinal < m_values.size(); ++ordinal) {
+            if (!accept(ordinal))
+                break;
+        }
+        return found;
+    }
+
+    // Posting lists of the query's trigrams, shortest first. A trigram no
+    // value has leaves only the unindexed values as candidates.
+    QVarLengthArray<const QVector<int>*, 16> lists;
+    bool indexed = true;
+    for (qsizetype i = 0; indexed && i + GramLength <= folded.size(); ++i) {
+        const auto it = m_grams.constFind(gramAt(folded, i));
+        if (it == m_grams.constEnd())
+            indexed = false;
+        else if (!lists.contains(&it.value()))
+            lists.append(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const QVector<int>* a, const QVector<int>* b) {
+        return a->size() < b->size();
+    });
+
+    const QVector<int> none;
+    const QVector<int>& shortest = indexed ? *lists.first() : none;
+    auto candidate = std::lower_bound(shortest.cbegin(), shortest.cend(), start);
+    auto unindexed = std::lower_bound(m_unindexed.cbegin(), m_unindexed.cend(), start);
+    const auto inAllLists = [&](int ordinal) {
+        return std::all_of(lists.cbegin() + 1, lists.cend(), [ordinal](const QVector<int>* list) {
+            return std::binary_search(list->cbegin(), list->cend(), ordinal);
+        });
+    };
+
+    // Both candidate streams are ascending; verify them in ordinal order
+    for (;;) {
+        while (candidate != shortest.cend() && !inAllLists(*candidate))
+            ++candidate;
+        int ordinal;
+        if (candidate != shortest.cend() && (unindexed == m_unindexed.cend() || *candidate < *unindexed))
+            ordinal = *candidate++;
+        else if (unindexed != m_unindexed.cend())
+            ordinal = *unindexed++;
+        else
+            break;
+        if (!accept(ordinal))
+            break;
+    }
+    return found;
+}
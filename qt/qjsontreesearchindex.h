@@ -0,0 +1,55 @@
+#ifndef QJSONTREESEARCHINDEX_H
+#define QJSONTREESEARCHINDEX_H
+
+#include <QHash>
+#include <QJsonValue>
+#include <QString>
+#include <QVector>
+
+// Key and value search over a QJsonTreeStore's document.
+//
+// Built by the store while it loads, for every value in document order, so
+// it covers the whole document whether or not its nodes exist yet; matches
+// are reported as document-order (preorder) positions. Keys are matched by
+// scanning the distinct interned keys, each with the positions carrying
+// it. Scalar values are kept as the document's own QJsonValues, decoded to
+// text when verified, with an index from every case-folded trigram to the
+// values containing it: a query of GramLength or more characters only
+// verifies the values holding all of its trigrams. Shorter queries, and
+// values longer than MaxIndexedLength, are scanned.
+class QJsonTreeSearchIndex
+{
+public:
+    enum Flag {
+        Keys = 0x1,
+        Values = 0x2,
+        CaseSensitive = 0x4,
+        WholeMatch = 0x8        // The whole key or value equals the query
+    };
+
+    static constexpr int GramLength = 3;
+    static constexpr qsizetype MaxIndexedLength = 256;
+
+    void clear();
+    // Keys are added as the store interns them, so ids match its own
+    void addKey(const QString& key);
+    // keyId is -1 for array elements and the document root
+    void addValue(int preorder, int keyId, const QJsonValue& value);
+
+    // The first limit matching positions after `after`, ascending
+    QVector<int> find(const QString& query, int flags, int after, int limit) const;
+    int count(const QString& query, int flags) const;
+
+private:
+    QVector<int> findKeys(const QString& query, int flags, int after, int limit) const;
+    QVector<int> findValues(const QString& query, int flags, int after, int limit) const;
+
+    QVector<QString> m_keys;
+    QVector<QVector<int>> m_keyPositions;   // Indexed by key id
+    QVector<int> m_valuePositions;          // Indexed by value ordinal, ascending
+    QVector<QJsonValue> m_values;           // By value ordinal
+    QHash<quint64, QVector<int>> m_grams;   // Ordinals per trigram, ascending
+    QVector<int> m_unindexed;               // Ordinals longer than MaxIndexedLength
+};
+
+#endif // QJSONTREESEARCHINDEX_H
@@ -0,0 +1,340 @@
+#include "qjsontreestore.h"
+#include <QVarLengthArray>
+#include <utility>
+
+void QJsonTreeStore::clear()
+{
+    m_nodes.clear();
+    m_nodes.squeeze();
+    m_keys.clear();
+    m_keyIds.clear();
+    m_subtreeSizes.clear();
+    m_subtreeSizes.squeeze();
+    m_depthCounts.clear();
+    m_searchIndex.clear();
+}
+
+bool QJsonTreeStore::load(const QJsonValue& rootValue, const LoadProgress& progress)
+{
+    clear();
+
+    // Virtual root holding the actual JSON root as its only child
+    QJsonTreeItem root;
+    root.type = QJsonTreeItem::Type::Object;
+    root.childCount = 1;
+    root.firstChild = 1;
+    m_nodes.append(root);
+
+    LoadWalk walk;
+    walk.progress = progress ? &progress : nullptr;
+    indexSubtree(rootValue, 0, -1, 0.0, 1.0, walk);
+    if (walk.canceled) {
+        clear();
+        return false;
+    }
+    appendNode(rootValue, RootId, 0, -1, 0);
+    return true;
+}
+
+int QJsonTreeStore::childId(int parentId, int row)
+{
+    if (!isValidId(parentId))
+        return -1;
+
+    if (row < 0 || row >= m_nodes.at(parentId).childCount)
+        return -1;
+
+    fetchChildren(parentId);
+    return m_nodes.at(parentId).firstChild + row;
+}
+
+void QJsonTreeStore::fetchChildren(int id)
+{
+    if (!isValidId(id) || m_nodes.at(id).childrenFetched())
+        return;
+
+    // Copy the source: appending below may reallocate m_nodes
+    const QJsonValue source = m_nodes.at(id).source;
+    const int first = m_nodes.size();
+    m_nodes.reserve(first + m_nodes.at(id).childCount);
+
+    // Children follow their parent in document order, each one after the
+    // whole subtree of its previous sibling
+    int preorder = m_nodes.at(id).preorder + 1;
+
+    if (source.isObject()) {
+        const QJsonObject obj = source.toObject();
+        int row = 0;
+        for (auto it = obj.begin(); it != obj.end(); ++it, ++row) {
+            appendNode(it.value(), id, row, internKey(it.key()), preorder);
+            preorder += m_subtreeSizes.at(preorder);
+        }
+    } else if (source.isArray()) {
+        const QJsonArray arr = source.toArray();
+        for (int row = 0; row < arr.size(); ++row) {
+            appendNode(arr.at(row), id, row, -1, preorder);
+            preorder += m_subtreeSizes.at(preorder);
+        }
+    }
+
+    m_nodes[id].firstChild = first;
+}
+
+QString QJsonTreeStore::key(int id) const
+{
+    const QJsonTreeItem& item = m_nodes.at(id);
+    if (item.keyId >= 0)
+        return m_keys.at(item.keyId);
+
+    // Array elements are keyed by their index
+    if (item.parent >= 0 && m_nodes.at(item.parent).type == QJsonTreeItem::Type::Array)
+        return QString::number(item.row);
+
+    return QString();
+}
+
+QString QJsonTreeStore::jsonPath(int id) const
+{
+    // Every node already holds its path as a parent link plus a key id or
+    // row; the string is only built here, root first, into one buffer
+    QVarLengthArray<int, 64> chain;
+    for (int node = id; m_nodes.at(node).parent >= 0; node = m_nodes.at(node).parent)
+        chain.append(node);
+
+    QString path;
+    path.reserve(1 + chain.size() * 8);
+    path += QLatin1Char('$');
+    for (auto it = chain.crbegin(); it != chain.crend(); ++it)
+        appendPathSegment(path, *it);
+    return path;
+}
+
+void QJsonTreeStore::appendPathSegment(QString& path, int id) const
+{
+    const QJsonTreeItem& item = m_nodes.at(id);
+    if (m_nodes.at(item.parent).type == QJsonTreeItem::Type::Array) {
+        path += QLatin1Char('[');
+        path += QString::number(item.row);
+        path += QLatin1Char(']');
+        return;
+    }
+
+    // The document root, and empty keys, add nothing
+    if (item.keyId < 0 || m_keys.at(item.keyId).isEmpty())
+        return;
+
+    // Keys containing separators need bracket notation
+    const QString& itemKey = m_keys.at(item.keyId);
+    const bool needsBracket = itemKey.contains('.') || itemKey.contains(' ') ||
+                              itemKey.contains('[') || itemKey.contains(']');
+    if (needsBracket) {
+        path += QLatin1String("[\"");
+        path += itemKey;
+        path += QLatin1String("\"]");
+    } else {
+        path += QLatin1Char('.');
+        path += itemKey;
+    }
+}
+
+int QJsonTreeStore::idForPreorder(int preorder)
+{
+    if (isEmpty() || preorder < 0 || preorder >= m_subtreeSizes.size())
+        return -1;
+
+    // Descend from the document root into the child whose subtree holds
+    // preorder: the last one starting at or before it
+    int id = m_nodes.at(RootId).firstChild;
+    while (m_nodes.at(id).preorder != preorder) {
+        fetchChildren(id);
+        const QJsonTreeItem& item = m_nodes.at(id);
+        int low = 0;
+        int high = item.childCount - 1;
+        while (low < high) {
+            const int mid = (low + high + 1) / 2;
+            if (m_nodes.at(item.firstChild + mid).preorder <= preorder)
+                low = mid;
+            else
+                high = mid - 1;
+        }
+        id = item.firstChild + low;
+    }
+    return id;
+}
+
+int QJsonTreeStore::idForPath(const QString& path)
+{
+    if (isEmpty() || !path.startsWith(QLatin1Char('$')))
+        return -1;
+
+    int id = m_nodes.at(RootId).firstChild;
+    qsizetype pos = 1;
+    while (id >= 0 && pos < path.size()) {
+        if (path.at(pos) == QLatin1Char('.')) {
+            qsizetype end = pos + 1;
+            while (end < path.size() && path.at(end) != QLatin1Char('.') && path.at(end) != QLatin1Char('['))
+                ++end;
+            id = childWithKey(id, path.mid(pos + 1, end - pos - 1));
+            pos = end;
+        } else if (QStringView(path).sliced(pos).startsWith(u"[\"")) {
+            const qsizetype end = path.indexOf(QLatin1String("\"]"), pos + 2);
+            if (end < 0)
+                return -1;
+            id = childWithKey(id, path.mid(pos + 2, end - pos - 2));
+            pos = end + 2;
+        } else if (path.at(pos) == QLatin1Char('[')) {
+            const qsizetype end = path.indexOf(QLatin1Char(']'), pos);
+            bool ok = false;
+            const int row = end < 0 ? -1 : path.mid(pos + 1, end - pos - 1).toInt(&ok);
+            if (!ok || m_nodes.at(id).type != QJsonTreeItem::Type::Array)
+                return -1;
+            id = childId(id, row);
+            pos = end + 1;
+        } else {
+            return -1;
+        }
+    }
+    return id;
+}
+
+QByteArray QJsonTreeStore::toJson(int id, const JsonWriter::Indent& indent) const
+{
+    const QJsonTreeItem& item = m_nodes.at(id);
+    JsonWriter writer(indent);
+
+    switch (item.type) {
+        case QJsonTreeItem::Type::Object:
+        case QJsonTreeItem::Type::Array:
+            // Serialize straight from the source so collapsed subtrees are
+            // never materialized just to be copied
+            writer.writeValue(item.source);
+            break;
+        case QJsonTreeItem::Type::String:
+            writer.writeString(item.source.toString());
+            break;
+        case QJsonTreeItem::Type::Number:
+            writer.writeNumber(item.source.toDouble());
+            break;
+        case QJsonTreeItem::Type::Boolean:
+            writer.writeBool(item.source.toBool());
+            break;
+        case QJsonTreeItem::Type::Null:
+            writer.writeNull();
+            break;
+    }
+    return writer.take();
+}
+
+int QJsonTreeStore::subtreeNodeCount(int id) const
+{
+    const QJsonTreeItem& item = m_nodes.at(id);
+    if (id == RootId) {
+        // Virtual root + the document
+        return 1 + (m_subtreeSizes.isEmpty() ? 0 : m_subtreeSizes.at(0));
+    }
+    return m_subtreeSizes.at(item.preorder);
+}
+
+int QJsonTreeStore::nodeCountAtDepth(int depth) const
+{
+    if (depth < 0 || depth >= m_depthCounts.size())
+        return 0;
+    return m_depthCounts.at(depth);
+}
+
+int QJsonTreeStore::expandDepthForBudget(int maxVisibleNodes) const
+{
+    // Expanding to depth d shows every node at depth <= d; find the deepest
+    // level that keeps the visible node count within budget
+    int visible = 0;
+    for (int depth = 0; depth < m_depthCounts.size(); ++depth) {
+        visible += m_depthCounts.at(depth);
+        if (visible > maxVisibleNodes)
+            return depth - 1;
+    }
+    return maxDepth();
+}
+
+int QJsonTreeStore::internKey(const QString& key)
+{
+    auto it = m_keyIds.constFind(key);
+    if (it != m_keyIds.constEnd())
+        return it.value();
+
+    const int id = m_keys.size();
+    m_keys.append(key);
+    m_keyIds.insert(key, id);
+    m_searchIndex.addKey(key);
+    return id;
+}
+
+int QJsonTreeStore::childWithKey(int id, const QString& key)
+{
+    const int keyId = m_keyIds.value(key, -1);
+    if (keyId < 0 || m_nodes.at(id).type != QJsonTreeItem::Type::Object)
+        return -1;
+
+    fetchChildren(id);
+    const QJsonTreeItem& item = m_nodes.at(id);
+    for (int row = 0; row < item.childCount; ++row) {
+        if (m_nodes.at(item.firstChild + row).keyId == keyId)
+            return item.firstChild + row;
+    }
+    return -1;
+}
+
+void QJsonTreeStore::appendNode(const QJsonValue& value, int parent, int row, int keyId, int preorder)
+{
+    QJsonTreeItem item;
+    item.parent = parent;
+    item.row = row;
+    item.keyId = keyId;
+    item.preorder = preorder;
+    item.type = QJsonTreeItem::typeOf(value);
+    item.source = value;
+
+    if (item.type == QJsonTreeItem::Type::Object) {
+        item.childCount = value.toObject().size();
+    } else if (item.type == QJsonTreeItem::Type::Array) {
+        item.childCount = value.toArray().size();
+    }
+
+    m_nodes.append(std::move(item));
+}
+
+int QJsonTreeStore::indexSubtree(const QJsonValue& value, int depth, int keyId, double start, double span,
+                                 LoadWalk& walk)
+{
+    if (walk.progress && ++walk.visited % ProgressInterval == 0 && !(*walk.progress)(start))
+        walk.canceled = true;
+
+    const int preorder = m_subtreeSizes.size();
+    m_subtreeSizes.append(1);
+    m_searchIndex.addValue(preorder, keyId, value);
+
+    if (depth >= m_depthCounts.size())
+        m_depthCounts.resize(depth + 1);
+    ++m_depthCounts[depth];
+
+    // Recursion is bounded by the parser's nesting limit. A stopped walk
+    // unwinds without visiting the rest.
+    int size = 1;
+    if (value.isObject()) {
+        const QJsonObject obj = value.toObject();
+        const double childSpan = span / qMax<qsizetype>(1, obj.size());
+        double childStart = start;
+        for (auto it = obj.begin(); it != obj.end() && !walk.canceled; ++it, childStart += childSpan) {
+            size += indexSubtree(it.value(), depth + 1, internKey(it.key()), childStart, childSpan, walk);
+        }
+    } else if (value.isArray()) {
+        const QJsonArray arr = value.toArray();
+        const double childSpan = span / qMax<qsizetype>(1, arr.size());
+        double childStart = start;
+        for (auto it = arr.begin(); it != arr.end() && !walk.canceled; ++it, childStart += childSpan) {
+            size += indexSubtree(*it, depth + 1, -1, childStart, childSpan, walk);
+        }
+    }
+
+    m_subtreeSizes[preorder] = size;
+    return size;
+}
@@ -0,0 +1,96 @@
+#ifndef QJSONTREESTORE_H
+#define QJSONTREESTORE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QJsonValue>
+#include <functional>
+#include "qjsontreeitem.h"
+#include "qjsontreesearchindex.h"
+#include "jsonwriter.h"
+
+// Flat, index-based storage for the JSON tree.
+//
+// All nodes are held by value in one contiguous vector. Node 0 is the
+// virtual root; its single child is the JSON document root. Children are
+// appended as one contiguous block the first time a parent is fetched, so
+// row(), parent() and child lookups are O(1) and clear() releases the whole
+// tree in a single deallocation. Object keys are interned once per store.
+//
+// Subtree sizes are computed once at load for every value in document
+// order, so node counts and depth statistics never walk the tree again;
+// a node's document-order position is derived from its parent's when its
+// children are fetched. The search index is filled in the same pass. Only
+// item creation is lazy: that walk visits every value, so load time and
+// the per-value tables grow with the document, not with what is expanded.
+class QJsonTreeStore
+{
+public:
+    static constexpr int RootId = 0;
+    // Values walked between calls of a load's progress callback
+    static constexpr int ProgressInterval = 4096;
+
+    // Called during load with the fraction of the document walked so far,
+    // estimated from the position among siblings; returns false to stop
+    using LoadProgress = std::function<bool(double fraction)>;
+
+    void clear();
+    // Returns false, leaving the store empty, when progress stopped it
+    bool load(const QJsonValue& rootValue, const LoadProgress& progress = nullptr);
+
+    bool isEmpty() const { return m_nodes.isEmpty(); }
+    int materializedCount() const { return m_nodes.size(); }
+
+    const QJsonTreeItem& node(int id) const { return m_nodes.at(id); }
+    bool isValidId(int id) const { return id >= 0 && id < m_nodes.size(); }
+
+    // Returns the id of the child at row, fetching the parent's children
+    // on first access. Returns -1 for out-of-range rows.
+    int childId(int parentId, int row);
+    void fetchChildren(int id);
+
+    QString key(int id) const;
+    QString jsonPath(int id) const;
+    // Node of the value at a document-order position, or of a path in the
+    // form jsonPath() returns; fetches the ancestors on the way. -1 when
+    // there is no such value.
+    int idForPreorder(int preorder);
+    int idForPath(const QString& path);
+    const QJsonTreeSearchIndex& searchIndex() const { return m_searchIndex; }
+    // Serializes the subtree at id as UTF-8 with the given indent
+    QByteArray toJson(int id, const JsonWriter::Indent& indent) const;
+    // Number of nodes in the subtree rooted at id, including id itself
+    int subtreeNodeCount(int id) const;
+    int descendantCount(int id) const { return subtreeNodeCount(id) - 1; }
+
+    // Depth statistics of the document (document root at depth 0)
+    int maxDepth() const { return m_depthCounts.size() - 1; }
+    int nodeCountAtDepth(int depth) const;
+    int expandDepthForBudget(int maxVisibleNodes) const;
+
+private:
+    int internKey(const QString& key);
+    void appendNode(const QJsonValue& value, int parent, int row, int keyId, int preorder);
+    // The walk of one load(): values visited, and whether it was stopped
+    struct LoadWalk {
+        const LoadProgress* progress = nullptr;
+        qint64 visited = 0;
+        bool canceled = false;
+    };
+    // start and span are the part of the document the value covers, as
+    // fractions, for progress reports
+    int indexSubtree(const QJsonValue& value, int depth, int keyId, double start, double span,
+                     LoadWalk& walk);
+    int childWithKey(int id, const QString& key);
+    void appendPathSegment(QString& path, int id) const;
+
+    QVector<QJsonTreeItem> m_nodes;
+    QVector<QString> m_keys;
+    QHash<QString, int> m_keyIds;
+    QVector<int> m_subtreeSizes;    // Indexed by preorder position
+    QVector<int> m_depthCounts;     // Node count per depth
+    QJsonTreeSearchIndex m_searchIndex;
+};
+
+#endif // QJSONTREESTORE_H
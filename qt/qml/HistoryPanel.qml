@@ -15,21 +15,12 @@ Drawer {
 
     signal entrySelected(string content)
 
-    // History data model
-    property var historyEntries: []
+    // Paged metadata model; filtering happens in the history backend
+    readonly property var historyModel: JsonBridge.historyModel
     property string searchQuery: ""
-    property bool isLoading: false
+    property bool awaitingEntry: false
 
-    // Filtered entries based on search
-    property var filteredEntries: {
-        if (!searchQuery.trim()) {
-            return historyEntries;
-        }
-        const query = searchQuery.toLowerCase();
-        return historyEntries.filter(function(entry) {
-            return entry.preview.toLowerCase().indexOf(query) !== -1;
-        });
-    }
+    onSearchQueryChanged: historyModel.searchQuery = searchQuery.trim()
 
     background: Rectangle {
         color: Theme.background
@@ -53,21 +44,25 @@ Drawer {
     Connections {
         target: JsonBridge
 
-        function onHistoryLoaded(entries) {
-            historyDrawer.historyEntries = entries || [];
-            historyDrawer.isLoading = false;
+        function onHistoryEntryLoaded(content) {
+            if (historyDrawer.awaitingEntry) {
+                historyDrawer.awaitingEntry = false;
+                if (content) {
+                    historyDrawer.entrySelected(content);
+                }
+            }
         }
 
         function onHistoryEntryDeleted(success) {
             if (success) {
                 // Refresh the history list after delete
-                JsonBridge.loadHistory();
+                historyDrawer.historyModel.reload();
             }
         }
 
         function onHistoryCleared(success) {
             if (success) {
-                historyDrawer.historyEntries = [];
+                historyDrawer.historyModel.reload();
             }
         }
     }
@@ -79,9 +74,8 @@ Drawer {
     }
 
     function loadHistoryData() {
-        isLoading = true;
-        // Async call - result comes via onHistoryLoaded signal
-        JsonBridge.loadHistory();
+        // Requests the first page; further pages load as the list scrolls
+        historyModel.reload();
     }
 
     function deleteEntry(id) {
@@ -94,8 +88,11 @@ Drawer {
         JsonBridge.clearHistory();
     }
 
-    function selectEntry(entry) {
-        entrySelected(entry.content);
+    function selectEntry(entryId) {
+        // Listings carry metadata only; the content is loaded on demand
+        // and delivered via onHistoryEntryLoaded
+        awaitingEntry = true;
+        JsonBridge.getHistoryEntry(entryId);
         historyDrawer.close();
     }
 
@@ -149,7 +146,7 @@ Drawer {
 
                 Button {
                     text: "Clear All"
-                    visible: historyEntries.length > 0
+                    visible: historyModel.totalCount > 0 || searchQuery.length > 0
                     flat: true
                     font.pixelSize: 12
                     onClicked: confirmClearDialog.open()
@@ -229,7 +226,7 @@ Drawer {
                     }
 
                     Keys.onDownPressed: {
-                        if (filteredEntries.length > 0) {
+                        if (historyList.count > 0) {
                             historyList.forceActiveFocus();
                             historyList.currentIndex = 0;
                         }
@@ -273,7 +270,7 @@ Drawer {
             Layout.fillWidth: true
             Layout.fillHeight: true
             clip: true
-            model: filteredEntries
+            model: historyDrawer.historyModel
             spacing: 4
             focus: true
 
@@ -284,9 +281,9 @@ Drawer {
 
             // Empty state
             Text {
-                visible: filteredEntries.length === 0 && !isLoading
+                visible: historyList.count === 0 && historyModel.totalCount === 0
                 anchors.centerIn: parent
-                text: historyEntries.length === 0 ? "No history yet\nFormat some JSON to get started" : "No matching entries"
+                text: searchQuery.trim().length === 0 ? "No history yet\nFormat some JSON to get started" : "No matching entries"
                 color: Theme.textSecondary
                 font.pixelSize: 14
                 horizontalAlignment: Text.AlignHCenter
@@ -294,7 +291,7 @@ Drawer {
 
             // Loading state
             BusyIndicator {
-                visible: isLoading
+                visible: historyModel.loading && historyList.count === 0
                 anchors.centerIn: parent
                 running: visible
             }
@@ -310,15 +307,18 @@ Drawer {
                 border.color: ListView.isCurrentItem ? Theme.accent : "transparent"
                 border.width: 1
 
-                required property var modelData
+                required property string entryId
+                required property string timestamp
+                required property string preview
+                required property real size
                 required property int index
 
                 MouseArea {
                     id: mouseArea
                     anchors.fill: parent
                     hoverEnabled: true
-                    onClicked: selectEntry(modelData)
-                    onDoubleClicked: selectEntry(modelData)
+                    onClicked: selectEntry(entryId)
+                    onDoubleClicked: selectEntry(entryId)
                 }
 
                 ColumnLayout {
@@ -329,7 +329,7 @@ Drawer {
                     // Preview text
                     Text {
                         Layout.fillWidth: true
-                        text: modelData.preview || ""
+                        text: entryDelegate.preview
                         color: Theme.textPrimary
                         font.family: Theme.monoFont
                         font.pixelSize: 12
@@ -344,13 +344,13 @@ Drawer {
                         spacing: 12
 
                         Text {
-                            text: formatTimestamp(modelData.timestamp)
+                            text: formatTimestamp(entryDelegate.timestamp)
                             color: Theme.textSecondary
                             font.pixelSize: 11
                         }
 
                         Text {
-                            text: formatSize(modelData.size)
+                            text: formatSize(entryDelegate.size)
                             color: Theme.textSecondary
                             font.pixelSize: 11
                         }
@@ -366,7 +366,7 @@ Drawer {
                             visible: mouseArea.containsMouse || entryDelegate.ListView.isCurrentItem
                             implicitHeight: 24
                             onClicked: {
-                                deleteEntry(modelData.id);
+                                deleteEntry(entryId);
                             }
 
                             background: Rectangle {
@@ -385,9 +385,9 @@ Drawer {
                 }
 
                 // Keyboard navigation
-                Keys.onReturnPressed: selectEntry(modelData)
-                Keys.onEnterPressed: selectEntry(modelData)
-                Keys.onDeletePressed: deleteEntry(modelData.id)
+                Keys.onReturnPressed: selectEntry(entryId)
+                Keys.onEnterPressed: selectEntry(entryId)
+                Keys.onDeletePressed: deleteEntry(entryId)
             }
 
             // Keyboard navigation
@@ -411,11 +411,11 @@ Drawer {
             Layout.fillWidth: true
             Layout.preferredHeight: 32
             color: Theme.backgroundSecondary
-            visible: historyEntries.length > 0
+            visible: historyModel.totalCount > 0
 
             Text {
                 anchors.centerIn: parent
-                text: filteredEntries.length + " of " + historyEntries.length + " entries"
+                text: historyModel.totalCount + (searchQuery.trim().length > 0 ? " matching" : "") + " entries"
                 color: Theme.textSecondary
                 font.pixelSize: 11
             }
@@ -7,6 +7,8 @@ Rectangle {
 
     property alias model: treeView.model
     property int animationDuration: 150
+    // Indent used when copying a subtree ("spaces:N" or "tabs")
+    property string indentType: "spaces:2"
 
     // Auto-expand configuration
     property bool autoExpandOnLoad: true
@@ -38,6 +40,7 @@ Rectangle {
         if (!autoExpandOnLoad) return
         if (!treeView.model) return
 
+        // Counts are computed once at load, so these calls are O(1)
         const nodeCount = treeView.model.totalNodeCount()
         if (nodeCount <= 0) return
 
@@ -45,7 +48,10 @@ Rectangle {
             if (nodeCount <= maxAutoExpandNodes) {
                 expandAll()
             } else {
-                expandToLevel(defaultExpandDepth)
+                // Deepest level whose visible rows still fit the budget,
+                // capped at the default depth; always open the root
+                const budgetDepth = treeView.model.expandDepthForBudget(maxAutoExpandNodes)
+                expandToLevel(Math.max(1, Math.min(defaultExpandDepth, budgetDepth)))
             }
         })
     }
@@ -97,7 +103,6 @@ Rectangle {
                 required property string key
                 required property var value
                 required property string valueType
-                required property string jsonPath
                 required property int childCount
                 required property bool isExpandable
                 required property bool isLastChild
@@ -120,7 +125,6 @@ Rectangle {
                     onClicked: (mouse) => {
                         if (mouse.button === Qt.RightButton) {
                             contextMenu.targetRow = delegateRoot.row
-                            contextMenu.targetJsonPath = delegateRoot.jsonPath
                             contextMenu.targetValue = delegateRoot.value
                             contextMenu.targetValueType = delegateRoot.valueType
                             contextMenu.popup()
@@ -321,7 +325,7 @@ Rectangle {
                         }
 
                         TapHandler {
-                            onTapped: root.copyPath(delegateRoot.jsonPath)
+                            onTapped: root.copyPath(delegateRoot.row)
                         }
 
                         ToolTip {
@@ -409,7 +413,6 @@ Rectangle {
     Menu {
         id: contextMenu
         property int targetRow: -1
-        property string targetJsonPath: ""
         property var targetValue
         property string targetValueType: ""
 
@@ -420,7 +423,7 @@ Rectangle {
 
         MenuItem {
             text: "Copy Path"
-            onTriggered: root.copyPath(contextMenu.targetJsonPath)
+            onTriggered: root.copyPath(contextMenu.targetRow)
         }
 
         MenuSeparator {}
@@ -471,15 +474,19 @@ Rectangle {
     function copyValue(row) {
         const index = treeView.index(row, 0)
         if (index.valid) {
-            const serialized = JsonBridge.treeModel.serializeNode(index)
+            const serialized = JsonBridge.treeModel.serializeNode(index, root.indentType)
             JsonBridge.copyToClipboard(serialized)
             showCopyFeedback()
         }
     }
 
-    function copyPath(path) {
-        JsonBridge.copyToClipboard(path)
-        showCopyFeedback()
+    // Paths are built on copy; delegates do not request them while scrolling
+    function copyPath(row) {
+        const index = treeView.index(row, 0)
+        if (index.valid) {
+            JsonBridge.copyToClipboard(JsonBridge.treeModel.getJsonPath(index))
+            showCopyFeedback()
+        }
     }
 
     function showCopyFeedback() {
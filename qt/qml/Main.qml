@@ -1,6 +1,7 @@
 import QtQuick
 import QtQuick.Controls
 import QtQuick.Layouts
+import QtQuick.Dialogs
 import AirgapFormatter
 
 ApplicationWindow {
@@ -10,7 +11,7 @@ ApplicationWindow {
     height: 800
     minimumWidth: 1024
     minimumHeight: 600
-    title: "Airgap JSON Formatter"
+    title: openedFileName ? "Airgap JSON Formatter - " + openedFileName : "Airgap JSON Formatter"
 
     color: Theme.background
 
@@ -23,6 +24,12 @@ ApplicationWindow {
     // Store current formatted JSON for both views
     property string currentFormattedJson: ""
 
+    // Expand the tree once the background build for a format finishes
+    property bool expandOnTreeLoad: false
+
+    // Name of the file shown in the output, when opened from disk
+    property string openedFileName: ""
+
     // Track when JsonBridge becomes ready and handle async operation results
     Connections {
         target: JsonBridge
@@ -34,7 +41,8 @@ ApplicationWindow {
             if (result.success) {
                 currentFormattedJson = result.result;
                 outputPane.text = result.result;
-                // Load tree model for tree view (synchronous)
+                // Build tree model in the background (result via onTreeLoaded)
+                expandOnTreeLoad = true;
                 JsonBridge.loadTreeModel(result.result);
                 // Update status bar from format result (avoid extra async validateJson call)
                 statusBar.isValid = true;
@@ -45,8 +53,6 @@ ApplicationWindow {
                 validationTimer.stop();
                 // Save to history via AsyncSerialiser queue
                 JsonBridge.saveToHistory(result.result);
-                // Auto-expand tree view after model loads
-                autoExpandTimer.restart();
             } else {
                 currentFormattedJson = "";
                 outputPane.text = "Error: " + result.error;
@@ -57,7 +63,8 @@ ApplicationWindow {
             if (result.success) {
                 currentFormattedJson = result.result;
                 outputPane.text = result.result;
-                // Load tree model for tree view (synchronous)
+                // Build tree model in the background (result via onTreeLoaded)
+                expandOnTreeLoad = false;
                 JsonBridge.loadTreeModel(result.result);
                 // Update status bar (avoid extra async validateJson call)
                 statusBar.isValid = true;
@@ -76,32 +83,62 @@ ApplicationWindow {
             }
         }
 
-        function onValidateCompleted(result) {
-            statusBar.isValid = result.isValid;
+        function onProcessCompleted(result) {
+            const minified = result.options.minify === true;
+            showValidation(result.validation);
+            if (result.success) {
+                const output = minified ? result.minified : result.formatted;
+                currentFormattedJson = output;
+                outputPane.text = output;
+                // Desktop builds the tree from the same parse; the browser
+                // builds it afterwards and reports it through onTreeLoaded
+                expandOnTreeLoad = result.treePending === true && !minified;
+                if (result.tree && !minified) {
+                    autoExpandTimer.restart();
+                }
+                // Stop pending validation - processing already validated
+                validationTimer.stop();
+                // Save to history via AsyncSerialiser queue
+                JsonBridge.saveToHistory(output);
+                if (minified) {
+                    // Switch to text mode for minified output
+                    window.viewMode = "text";
+                }
+            } else {
+                currentFormattedJson = "";
+                outputPane.text = "Error: " + result.error;
+            }
+        }
 
-            if (result.isValid) {
-                statusBar.errorMessage = "";
-                statusBar.errorLine = 0;
-                statusBar.errorColumn = 0;
-                statusBar.objectCount = result.stats.object_count || 0;
-                statusBar.arrayCount = result.stats.array_count || 0;
-                statusBar.stringCount = result.stats.string_count || 0;
-                statusBar.numberCount = result.stats.number_count || 0;
-                statusBar.booleanCount = result.stats.boolean_count || 0;
-                statusBar.nullCount = result.stats.null_count || 0;
-                statusBar.totalKeys = result.stats.total_keys || 0;
-                statusBar.maxDepth = result.stats.max_depth || 0;
-                inputPane.errorLine = -1;
-                inputPane.errorMessage = "";
-            } else if (result.error) {
-                statusBar.errorMessage = result.error.message || "Unknown error";
-                statusBar.errorLine = result.error.line || 1;
-                statusBar.errorColumn = result.error.column || 1;
-                inputPane.errorLine = result.error.line || 1;
-                inputPane.errorMessage = result.error.message || "Unknown error";
+        function onFileOpened(result) {
+            if (result.validation) {
+                showValidation(result.validation);
+            }
+            if (result.success) {
+                openedFileName = result.fileName;
+                // Both models were filled from the file; the text never
+                // goes through outputPane.text or the input pane
+                expandOnTreeLoad = false;
+                autoExpandTimer.restart();
+                validationTimer.stop();
+            } else {
+                openedFileName = "";
+                outputPane.text = "Error: " + result.error;
             }
         }
 
+        function onTreeLoaded(success) {
+            if (success && expandOnTreeLoad) {
+                // Auto-expand tree view after model loads
+                autoExpandTimer.restart();
+            }
+            expandOnTreeLoad = false;
+        }
+
+        function onValidateCompleted(result) {
+            showValidation(result);
+        }
+
         function onHistoryLoaded(entries) {
             // History panel will receive this via its own connection
         }
@@ -135,6 +172,66 @@ ApplicationWindow {
         }
     }
 
+    // Apply a {isValid, error, stats} result to the status bar and input pane
+    function showValidation(result) {
+        statusBar.isValid = result.isValid;
+
+        if (result.isValid) {
+            statusBar.errorMessage = "";
+            statusBar.errorLine = 0;
+            statusBar.errorColumn = 0;
+            statusBar.objectCount = result.stats.object_count || 0;
+            statusBar.arrayCount = result.stats.array_count || 0;
+            statusBar.stringCount = result.stats.string_count || 0;
+            statusBar.numberCount = result.stats.number_count || 0;
+            statusBar.booleanCount = result.stats.boolean_count || 0;
+            statusBar.nullCount = result.stats.null_count || 0;
+            statusBar.totalKeys = result.stats.total_keys || 0;
+            statusBar.maxDepth = result.stats.max_depth || 0;
+            inputPane.errorLine = -1;
+            inputPane.errorMessage = "";
+        } else if (result.error) {
+            statusBar.errorMessage = result.error.message || "Unknown error";
+            statusBar.errorLine = result.error.line || 1;
+            statusBar.errorColumn = result.error.column || 1;
+            inputPane.errorLine = result.error.line || 1;
+            inputPane.errorMessage = result.error.message || "Unknown error";
+        }
+    }
+
+    // Format, validate and build the tree from a single parse
+    function formatOptions(indentType) {
+        return { format: true, stats: true, tree: true, indentType: indentType };
+    }
+
+    // Open a file straight into the tree and output models
+    function openFile() {
+        if (Qt.platform.os === "wasm") {
+            // The browser picker has to open within this user gesture
+            beginOpenFile();
+            JsonBridge.openFile("", toolbar.selectedIndent);
+        } else {
+            openFileDialog.open();
+        }
+    }
+
+    function beginOpenFile() {
+        inputPane.text = "";
+        outputPane.text = "";
+        currentFormattedJson = "";
+        expandOnTreeLoad = false;
+    }
+
+    FileDialog {
+        id: openFileDialog
+        title: "Open JSON File"
+        nameFilters: ["JSON files (*.json)", "All files (*)"]
+        onAccepted: {
+            beginOpenFile();
+            JsonBridge.openFile(selectedFile.toString(), toolbar.selectedIndent);
+        }
+    }
+
     // Handle pasted content with auto-format
     function handlePastedContent(text) {
         // Check if we should auto-format: input is empty or fully selected
@@ -142,10 +239,12 @@ ApplicationWindow {
                                  inputPane.isFullySelected();
 
         if (shouldAutoFormat) {
+            // Abort any tree still being built for the previous input
+            JsonBridge.cancelTreeLoad();
             // Try to format the pasted content
             inputPane.text = text;  // Put original in input
-            JsonBridge.formatJson(text, toolbar.selectedIndent);
-            // Result comes via onFormatCompleted signal
+            JsonBridge.processJson(text, formatOptions(toolbar.selectedIndent));
+            // Result comes via onProcessCompleted signal
         } else {
             // Has partial content - paste normally without auto-format
             inputPane.text = text;
@@ -232,22 +331,24 @@ ApplicationWindow {
                 if (!inputPane.text.trim()) {
                     return;
                 }
-                // Async call - result comes via onFormatCompleted signal
-                JsonBridge.formatJson(inputPane.text, indentType);
+                // Async call - result comes via onProcessCompleted signal
+                JsonBridge.processJson(inputPane.text, formatOptions(indentType));
             }
 
             onMinifyRequested: {
                 if (!inputPane.text.trim()) {
                     return;
                 }
-                // Async call - result comes via onMinifyCompleted signal
-                JsonBridge.minifyJson(inputPane.text);
+                // Async call - result comes via onProcessCompleted signal
+                JsonBridge.processJson(inputPane.text, { minify: true, stats: true, tree: true });
             }
 
             onCopyRequested: {
-                if (currentFormattedJson) {
+                // Opened files live only in the output model
+                const text = currentFormattedJson || JsonBridge.outputModel.text;
+                if (text) {
                     // Async call - result comes via onCopyCompleted signal
-                    JsonBridge.copyToClipboard(currentFormattedJson);
+                    JsonBridge.copyToClipboard(text);
                 }
             }
 
@@ -255,7 +356,9 @@ ApplicationWindow {
                 inputPane.text = "";
                 outputPane.text = "";
                 currentFormattedJson = "";
-                // Clear tree model
+                openedFileName = "";
+                // Clear tree model (also cancels a pending background build)
+                expandOnTreeLoad = false;
                 JsonBridge.treeModel.clear();
                 // Reset validation state
                 statusBar.isValid = true;
@@ -271,6 +374,10 @@ ApplicationWindow {
             onLoadHistoryRequested: {
                 historyPanel.open();
             }
+
+            onOpenFileRequested: {
+                window.openFile();
+            }
         }
 
         SplitView {
@@ -316,6 +423,7 @@ ApplicationWindow {
                     anchors.fill: parent
                     visible: viewMode === "tree"
                     model: JsonBridge.treeModel
+                    indentType: toolbar.selectedIndent
                 }
             }
         }
@@ -336,7 +444,7 @@ ApplicationWindow {
             validationTimer.stop();
             inputPane.text = content;
             // Direct call - AsyncSerialiser handles operation serialization
-            JsonBridge.formatJson(content, toolbar.selectedIndent);
+            JsonBridge.processJson(content, formatOptions(toolbar.selectedIndent));
         }
     }
 
@@ -398,6 +506,11 @@ ApplicationWindow {
         onActivated: viewMode = (viewMode === "tree") ? "text" : "tree"
     }
 
+    Shortcut {
+        sequence: "Ctrl+Shift+O"
+        onActivated: window.openFile()
+    }
+
     // Open history panel
     Shortcut {
         sequence: "Ctrl+O"
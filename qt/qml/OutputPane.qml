@@ -11,36 +11,147 @@ Rectangle {
     border.color: Theme.border
     border.width: 1
 
-    ScrollView {
+    // Only the delegates in view are created, and each one highlights its
+    // own line, so styling cost follows the viewport, not the document
+    ListView {
+        id: lineView
         anchors.fill: parent
         anchors.margins: 1
+        clip: true
+        model: JsonBridge.outputModel
+        boundsBehavior: Flickable.StopAtBounds
+        reuseItems: true
 
-        TextArea {
-            id: textArea
-            textFormat: TextEdit.RichText  // Enable HTML rendering
-            color: Theme.textPrimary
-            font.family: Theme.monoFont
-            font.pixelSize: Theme.monoFontSize
-            placeholderText: "Formatted output will appear here"
-            placeholderTextColor: Theme.textSecondary
-            readOnly: true
-            background: Rectangle {
-                color: "transparent"
+        // Selection is a range of rows, copied from the model's source text
+        property int selectionAnchor: -1
+        property int selectionEnd: -1
+        readonly property int selectionFirst: Math.min(selectionAnchor, selectionEnd)
+        readonly property int selectionLast: Math.max(selectionAnchor, selectionEnd)
+
+        ScrollBar.vertical: ScrollBar {}
+
+        Keys.onPressed: (event) => {
+            if (event.matches(StandardKey.Copy)) {
+                outputPane.copySelection()
+                event.accepted = true
+            } else if (event.matches(StandardKey.SelectAll)) {
+                outputPane.selectAll()
+                event.accepted = true
+            }
+        }
+
+        delegate: Item {
+            id: lineDelegate
+            required property int index
+            required property string highlightedText
+
+            readonly property bool selected: lineView.selectionFirst >= 0
+                                             && index >= lineView.selectionFirst
+                                             && index <= lineView.selectionLast
+
+            width: ListView.view.width
+            height: lineText.implicitHeight
+
+            Rectangle {
+                anchors.fill: parent
+                visible: lineDelegate.selected
+                color: Theme.accent
+                opacity: 0.25
+            }
+
+            Text {
+                id: lineText
+                width: parent.width - 12
+                x: 6
+                text: lineDelegate.highlightedText
+                textFormat: Text.StyledText
+                color: Theme.textPrimary
+                font.family: Theme.monoFont
+                font.pixelSize: Theme.monoFontSize
+                wrapMode: Text.WrapAnywhere
+            }
+
+            MouseArea {
+                anchors.fill: parent
+                acceptedButtons: Qt.LeftButton | Qt.RightButton
+                // Dragging selects rows instead of flicking; the wheel still scrolls
+                preventStealing: true
+
+                onPressed: (mouse) => {
+                    lineView.forceActiveFocus()
+                    if (mouse.button === Qt.RightButton) {
+                        if (!lineDelegate.selected)
+                            outputPane.selectRows(lineDelegate.index, lineDelegate.index)
+                        contextMenu.popup()
+                    } else if ((mouse.modifiers & Qt.ShiftModifier) && lineView.selectionAnchor >= 0) {
+                        lineView.selectionEnd = lineDelegate.index
+                    } else {
+                        outputPane.selectRows(lineDelegate.index, lineDelegate.index)
+                    }
+                }
+
+                onPositionChanged: (mouse) => {
+                    if (!(mouse.buttons & Qt.LeftButton))
+                        return
+                    const point = mapToItem(lineView.contentItem, mouse.x, mouse.y)
+                    const row = lineView.indexAt(0, Math.max(0, Math.min(point.y, lineView.contentItem.height - 1)))
+                    if (row >= 0)
+                        lineView.selectionEnd = row
+                }
             }
-            wrapMode: TextEdit.Wrap
-            selectByMouse: true
         }
     }
 
-    onTextChanged: {
-        if (text) {
-            // Get highlighted HTML from Rust via bridge
-            textArea.text = JsonBridge.highlightJson(text);
-        } else {
-            textArea.text = "";
+    Menu {
+        id: contextMenu
+
+        MenuItem {
+            text: "Copy"
+            onTriggered: outputPane.copySelection()
+        }
+
+        MenuItem {
+            text: "Select All"
+            onTriggered: outputPane.selectAll()
         }
     }
 
+    Text {
+        anchors.fill: parent
+        anchors.margins: 7
+        visible: lineView.count === 0
+        text: "Formatted output will appear here"
+        color: Theme.textSecondary
+        font.family: Theme.monoFont
+        font.pixelSize: Theme.monoFontSize
+    }
+
+    onTextChanged: {
+        // Lines are indexed here and highlighted on demand by the model
+        JsonBridge.outputModel.setText(text);
+        selectRows(-1, -1);
+    }
+
+    function selectRows(first, last) {
+        lineView.selectionAnchor = first
+        lineView.selectionEnd = last
+    }
+
+    function selectAll() {
+        if (lineView.count > 0)
+            selectRows(0, lineView.count - 1)
+    }
+
+    // Copies the selected rows, or the whole output when nothing is selected
+    function copySelection() {
+        if (lineView.count === 0)
+            return
+        if (lineView.selectionFirst >= 0)
+            JsonBridge.copyToClipboard(JsonBridge.outputModel.textForRows(lineView.selectionFirst, lineView.selectionLast))
+        else
+            JsonBridge.copyToClipboard(text)
+    }
+
     // For copy operations, return plain text
     function getPlainText() {
         return text;
@@ -16,6 +16,7 @@ Rectangle {
     signal expandAllRequested()
     signal collapseAllRequested()
     signal loadHistoryRequested()
+    signal openFileRequested()
 
     property string selectedIndent: "spaces:4"
     property alias copyButtonText: copyButton.text
@@ -58,6 +59,33 @@ Rectangle {
             ToolTip.delay: 500
         }
 
+        // Open file button
+        Button {
+            id: openButton
+            text: "Open"
+            onClicked: toolbar.openFileRequested()
+
+            contentItem: Text {
+                text: openButton.text
+                color: Theme.textPrimary
+                horizontalAlignment: Text.AlignHCenter
+                verticalAlignment: Text.AlignVCenter
+                font.pixelSize: 13
+            }
+            background: Rectangle {
+                implicitWidth: 60
+                implicitHeight: 34
+                color: openButton.hovered ? Theme.backgroundSecondary : "transparent"
+                border.color: openButton.activeFocus ? Theme.focusRing : Theme.border
+                border.width: openButton.activeFocus ? Theme.focusRingWidth : 1
+                radius: 4
+            }
+
+            ToolTip.visible: hovered
+            ToolTip.text: "Open File (Ctrl+Shift+O)"
+            ToolTip.delay: 500
+        }
+
         // Clear button
         Button {
             id: clearButton
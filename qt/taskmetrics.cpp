@@ -0,0 +1,267 @@
+#include "taskmetrics.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QtAlgorithms>
+#include <cmath>
+#include <utility>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/val.h>
+using emscripten::val;
+#endif
+
+int LatencyHistogram::bucketIndex(quint64 value)
+{
+    // Below two sub-bucket ranges every value has its own bucket
+    if (value < quint64(2 * SubBuckets))
+        return int(value);
+    const int shift = 63 - qCountLeadingZeroBits(value) - SubBucketBits;
+    return (shift + 1) * SubBuckets + int((value >> shift) - SubBuckets);
+}
+
+quint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < 2 * SubBuckets)
+        return quint64(index);
+    const int shift = index / SubBuckets - 1;
+    const quint64 lower = quint64(SubBuckets + index % SubBuckets) << shift;
+    return lower + (quint64(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 value)
+{
+    value = qMax<qint64>(0, value);
+    const int index = bucketIndex(quint64(value));
+    if (index >= m_counts.size())
+        m_counts.resize(index + 1);
+    ++m_counts[index];
+
+    m_min = m_count > 0 ? qMin(m_min, value) : value;
+    m_max = qMax(m_max, value);
+    m_sum += value;
+    ++m_count;
+}
+
+qint64 LatencyHistogram::percentile(double percentile) const
+{
+    if (m_count == 0)
+        return 0;
+
+    const qint64 target = qMax<qint64>(1, qint64(std::ceil(qBound(0.0, percentile, 100.0) / 100.0 * m_count)));
+    qint64 seen = 0;
+    for (int i = 0; i < m_counts.size(); ++i) {
+        seen += m_counts.at(i);
+        if (seen >= target)
+            return qMin(qint64(bucketUpperBound(i)), m_max);
+    }
+    return m_max;
+}
+
+TaskMetrics::TaskMetrics(int watchdogMs)
+    : m_watchdogUs(qint64(watchdogMs) * 1000)
+{
+#ifdef __EMSCRIPTEN__
+    m_performanceOrigin = val::global("performance").call<double>("now") - now() / 1e6;
+#endif
+}
+
+void TaskMetrics::recordFinished(const Task& task, bool succeeded, bool timedOut)
+{
+    Counters& counters = m_counters[task.name];
+    const qint64 runUs = (task.finishedNs - task.startedNs) / 1000;
+    counters.wait.record((task.startedNs - task.enqueuedNs) / 1000);
+    counters.run.record(runUs);
+    ++(succeeded ? counters.succeeded : counters.failed);
+    if (timedOut)
+        ++counters.timedOut;
+    if (runUs >= m_watchdogUs * NearTimeoutFraction)
+        ++counters.nearTimeout;
+    counters.payloadBytes += task.payloadBytes;
+
+    addTraceEvent({timedOut ? QStringLiteral("timeout") : QStringLiteral("task"), task, succeeded});
+
+#ifdef __EMSCRIPTEN__
+    // Shown as a measure in the browser profiler's timings track
+    val detail = val::object();
+    detail.set("waitMs", (task.startedNs - task.enqueuedNs) / 1e6);
+    detail.set("payloadBytes", double(task.payloadBytes));
+    detail.set("succeeded", succeeded);
+    val options = val::object();
+    options.set("start", m_performanceOrigin + task.startedNs / 1e6);
+    options.set("end", m_performanceOrigin + task.finishedNs / 1e6);
+    options.set("detail", detail);
+    PerformanceEntry entry {true, performanceEntryName(task.name)};
+    val::global("performance").call<val>("measure", entry.name, options);
+    addPerformanceEntry(std::move(entry));
+#endif
+}
+
+void TaskMetrics::recordRejected(const QString& name)
+{
+    ++m_counters[name].rejected;
+    Task task;
+    task.name = name;
+    task.enqueuedNs = task.startedNs = task.finishedNs = now();
+    addTraceEvent({QStringLiteral("rejected"), task, false});
+#ifdef __EMSCRIPTEN__
+    PerformanceEntry entry {false, performanceEntryName("rejected:" + name)};
+    val::global("performance").call<val>("mark", entry.name);
+    addPerformanceEntry(std::move(entry));
+#endif
+}
+
+void TaskMetrics::recordSuperseded(const QString& name)
+{
+    ++m_counters[name].superseded;
+    Task task;
+    task.name = name;
+    task.enqueuedNs = task.startedNs = task.finishedNs = now();
+    addTraceEvent({QStringLiteral("superseded"), task, false});
+#ifdef __EMSCRIPTEN__
+    PerformanceEntry entry {false, performanceEntryName("superseded:" + name)};
+    val::global("performance").call<val>("mark", entry.name);
+    addPerformanceEntry(std::move(entry));
+#endif
+}
+
+void TaskMetrics::recordQueueLength(int length)
+{
+    m_peakQueueLength = qMax(m_peakQueueLength, length);
+}
+
+void TaskMetrics::reset()
+{
+    m_counters.clear();
+    m_peakQueueLength = 0;
+    m_trace.clear();
+    m_traceStart = 0;
+#ifdef __EMSCRIPTEN__
+    for (const PerformanceEntry& entry : std::as_const(m_performanceEntries))
+        clearPerformanceEntry(entry);
+    m_performanceEntries.clear();
+#endif
+}
+
+#ifdef __EMSCRIPTEN__
+std::string TaskMetrics::performanceEntryName(const QString& name)
+{
+    return QStringLiteral("airgap:%1 #%2").arg(name, QString::number(++m_performanceSequence)).toStdString();
+}
+
+void TaskMetrics::addPerformanceEntry(PerformanceEntry entry)
+{
+    m_performanceEntries.enqueue(std::move(entry));
+    if (m_performanceEntries.size() > MaxTraceEvents)
+        clearPerformanceEntry(m_performanceEntries.dequeue());
+}
+
+void TaskMetrics::clearPerformanceEntry(const PerformanceEntry& entry)
+{
+    val::global("performance").call<void>(entry.measure ? "clearMeasures" : "clearMarks", entry.name);
+}
+#endif
+
+void TaskMetrics::addTraceEvent(TraceEvent event)
+{
+    if (m_trace.size() < MaxTraceEvents) {
+        m_trace.append(std::move(event));
+        return;
+    }
+    m_trace[m_traceStart] = std::move(event);
+    m_traceStart = (m_traceStart + 1) % MaxTraceEvents;
+}
+
+QVariantMap TaskMetrics::histogramMap(const LatencyHistogram& histogram)
+{
+    // Recorded in microseconds, reported in milliseconds
+    QVariantMap map;
+    map["count"] = histogram.count();
+    map["min"] = histogram.min() / 1000.0;
+    map["mean"] = histogram.mean() / 1000.0;
+    map["p50"] = histogram.percentile(50) / 1000.0;
+    map["p90"] = histogram.percentile(90) / 1000.0;
+    map["p99"] = histogram.percentile(99) / 1000.0;
+    map["p999"] = histogram.percentile(99.9) / 1000.0;
+    map["max"] = histogram.max() / 1000.0;
+    return map;
+}
+
+QVariantMap TaskMetrics::snapshot() const
+{
+    QVariantMap tasks;
+    for (auto it = m_counters.cbegin(); it != m_counters.cend(); ++it) {
+        const Counters& counters = it.value();
+        QVariantMap task;
+        task["count"] = counters.succeeded + counters.failed;
+        task["succeeded"] = counters.succeeded;
+        task["failed"] = counters.failed;
+        task["rejected"] = counters.rejected;
+        task["timedOut"] = counters.timedOut;
+        task["superseded"] = counters.superseded;
+        task["nearTimeout"] = counters.nearTimeout;
+        task["payloadBytes"] = counters.payloadBytes;
+        task["waitMs"] = histogramMap(counters.wait);
+        task["runMs"] = histogramMap(counters.run);
+        tasks[it.key()] = task;
+    }
+
+    QVariantMap snapshot;
+    snapshot["watchdogMs"] = m_watchdogUs / 1000;
+    snapshot["peakQueueLength"] = m_peakQueueLength;
+    snapshot["tasks"] = tasks;
+    return snapshot;
+}
+
+QByteArray TaskMetrics::chromeTrace() const
+{
+    // Queue waits are async spans on one row; runs are complete events on
+    // a row per concurrently running task
+    const auto micros = [](qint64 ns) { return ns / 1000.0; };
+    QJsonArray events;
+    QSet<int> tracks;
+
+    for (int i = 0; i < m_trace.size(); ++i) {
+        const TraceEvent& event = m_trace.at((m_traceStart + i) % m_trace.size());
+        const Task& task = event.task;
+
+        if (event.kind == QLatin1String("rejected") || event.kind == QLatin1String("superseded")) {
+            events.append(QJsonObject{{"name", task.name}, {"cat", event.kind}, {"ph", "i"}, {"s", "g"},
+                                      {"ts", micros(task.startedNs)}, {"pid", 1}, {"tid", 0}});
+            continue;
+        }
+
+        const QJsonObject wait{{"name", task.name}, {"cat", "queue"}, {"id", double(task.id)},
+                               {"pid", 1}, {"tid", 0}};
+        QJsonObject begin = wait;
+        begin["ph"] = "b";
+        begin["ts"] = micros(task.enqueuedNs);
+        QJsonObject end = wait;
+        end["ph"] = "e";
+        end["ts"] = micros(task.startedNs);
+        events.append(begin);
+        events.append(end);
+
+        const QJsonObject args{{"lane", task.lane}, {"succeeded", event.succeeded},
+                               {"timedOut", event.kind == QLatin1String("timeout")},
+                               {"payloadBytes", double(task.payloadBytes)},
+                               {"waitMs", (task.startedNs - task.enqueuedNs) / 1e6}};
+        events.append(QJsonObject{{"name", task.name}, {"cat", "task"}, {"ph", "X"},
+                                  {"ts", micros(task.startedNs)}, {"dur", micros(task.finishedNs - task.startedNs)},
+                                  {"pid", 1}, {"tid", task.track}, {"args", args}});
+        tracks.insert(task.track);
+    }
+
+    events.append(QJsonObject{{"name", "process_name"}, {"ph", "M"}, {"pid", 1},
+                              {"args", QJsonObject{{"name", "AsyncSerialiser"}}}});
+    events.append(QJsonObject{{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", 0},
+                              {"args", QJsonObject{{"name", "queue"}}}});
+    for (const int track : std::as_const(tracks)) {
+        events.append(QJsonObject{{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", track},
+                                  {"args", QJsonObject{{"name", QString("task %1").arg(track)}}}});
+    }
+
+    return QJsonDocument(QJsonObject{{"traceEvents", events}, {"displayTimeUnit", "ms"}})
+        .toJson(QJsonDocument::Compact);
+}
@@ -0,0 +1,139 @@
+#ifndef TASKMETRICS_H
+#define TASKMETRICS_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QString>
+#include <QVariantMap>
+#include <string>
+#include "airgaptrace.h"
+
+// Latency histogram with bounded relative error, after HdrHistogram.
+//
+// Values are bucketed by their top SubBucketBits + 1 significant bits:
+// every power-of-two range is split into SubBuckets equal buckets, so a
+// reported percentile is within 1 / SubBuckets of the recorded value. Small
+// values are exact. Memory grows with the logarithm of the largest value.
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 4;
+    static constexpr int SubBuckets = 1 << SubBucketBits;
+
+    void record(qint64 value);
+
+    qint64 count() const { return m_count; }
+    qint64 min() const { return m_count > 0 ? m_min : 0; }
+    qint64 max() const { return m_max; }
+    double mean() const { return m_count > 0 ? double(m_sum) / m_count : 0.0; }
+    // Highest value equivalent to the one at percentile (0-100), capped at
+    // max(); 0 when empty
+    qint64 percentile(double percentile) const;
+
+    static int bucketIndex(quint64 value);
+    static quint64 bucketUpperBound(int index);
+
+private:
+    QList<qint64> m_counts;
+    qint64 m_count = 0;
+    qint64 m_sum = 0;
+    qint64 m_min = 0;
+    qint64 m_max = 0;
+};
+
+// Per-task-name timings and counters for AsyncSerialiser.
+//
+// For every finished task the time from enqueue to start (wait) and from
+// start to finish (run) goes into microsecond histograms for its name,
+// together with rejection, timeout and supersede counts and the payload
+// size the task reported. snapshot() returns all of it as a QVariantMap
+// for QML; chromeTrace() returns the most recent MaxTraceEvents events in
+// Chrome trace-event format, for chrome://tracing or Perfetto. On
+// WebAssembly every finished task is also added to the page's User Timing
+// entries with performance.measure(), so it shows in the browser
+// profiler; like the trace, only the most recent MaxTraceEvents entries
+// are kept. Used from the main thread only.
+class TaskMetrics
+{
+public:
+    static constexpr int MaxTraceEvents = 10000;
+    // Runs taking at least this fraction of the watchdog are counted as
+    // near timeout
+    static constexpr double NearTimeoutFraction = 0.5;
+
+    struct Task {
+        quint64 id = 0;
+        QString name;
+        int lane = 0;
+        int track = 0;              // Trace row; tasks running at once differ
+        qint64 enqueuedNs = 0;      // Times from now()
+        qint64 startedNs = 0;
+        qint64 finishedNs = 0;
+        qint64 payloadBytes = 0;
+    };
+
+    explicit TaskMetrics(int watchdogMs);
+    void setWatchdogMs(int watchdogMs) { m_watchdogUs = qint64(watchdogMs) * 1000; }
+
+    // Nanoseconds on the trace clock
+    static qint64 now() { return AirgapTrace::nowNs(); }
+
+    // A task that ran to completion, failed or timed out
+    void recordFinished(const Task& task, bool succeeded, bool timedOut);
+    void recordRejected(const QString& name);
+    void recordSuperseded(const QString& name);
+    void recordQueueLength(int length);
+
+    void reset();
+
+    QVariantMap snapshot() const;
+    QByteArray chromeTrace() const;
+
+private:
+    struct Counters {
+        LatencyHistogram wait;
+        LatencyHistogram run;
+        qint64 succeeded = 0;
+        qint64 failed = 0;
+        qint64 rejected = 0;
+        qint64 timedOut = 0;
+        qint64 superseded = 0;
+        qint64 nearTimeout = 0;
+        qint64 payloadBytes = 0;
+    };
+
+    // A finished task, or an instant event when kind is not "task"
+    struct TraceEvent {
+        QString kind;
+        Task task;
+        bool succeeded = false;
+    };
+
+    void addTraceEvent(TraceEvent event);
+    static QVariantMap histogramMap(const LatencyHistogram& histogram);
+
+    qint64 m_watchdogUs;
+    QHash<QString, Counters> m_counters;
+    int m_peakQueueLength = 0;
+    // Ring buffer; m_traceStart is the oldest event once it is full
+    QList<TraceEvent> m_trace;
+    int m_traceStart = 0;
+#ifdef __EMSCRIPTEN__
+    // A User Timing entry; names are unique so the oldest can be cleared
+    struct PerformanceEntry {
+        bool measure = false;
+        std::string name;
+    };
+    std::string performanceEntryName(const QString& name);
+    void addPerformanceEntry(PerformanceEntry entry);
+    void clearPerformanceEntry(const PerformanceEntry& entry);
+
+    double m_performanceOrigin = 0;  // performance.now() at trace time 0
+    quint64 m_performanceSequence = 0;
+    QQueue<PerformanceEntry> m_performanceEntries;  // Oldest first
+#endif
+};
+
+#endif // TASKMETRICS_H
@@ -0,0 +1,108 @@
+/**
+ * @file tst_airgaptrace.cpp
+ * @brief Unit tests for the AIRGAP_TRACE_ZONE trace zones
+ *
+ * Tests verify:
+ * - A zone records its duration and the operator new calls inside it
+ * - Nested zones fall within their parent
+ * - Every thread gets its own row
+ * - Each thread keeps its most recent MaxEventsPerThread zones, and clear() drops them
+ */
+#include <QtTest/QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../airgaptrace.h"
+
+class tst_AirgapTrace : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Zone events named name, from a trace with nothing else in it
+    static QList<QJsonObject> zones(const QString& name)
+    {
+        const QByteArray trace = AirgapTrace::appendTo(QByteArray("{\"traceEvents\":[]}"));
+        QList<QJsonObject> found;
+        for (const QJsonValue& value : QJsonDocument::fromJson(trace).object()["traceEvents"].toArray()) {
+            const QJsonObject event = value.toObject();
+            if (event["ph"].toString() == "X" && event["name"].toString() == name)
+                found.append(event);
+        }
+        return found;
+    }
+
+    // Kept by the test object, so the compiler cannot elide the allocation
+    std::unique_ptr<std::vector<int>> m_kept;
+
+private slots:
+    void init()
+    {
+        AirgapTrace::clear();
+    }
+
+    void testZoneCountsOperatorNew()
+    {
+        {
+            AIRGAP_TRACE_ZONE("outer");
+            m_kept = std::make_unique<std::vector<int>>(256);
+            {
+                AIRGAP_TRACE_ZONE("inner");
+            }
+        }
+        m_kept.reset();
+
+        const QList<QJsonObject> outer = zones("outer");
+        const QList<QJsonObject> inner = zones("inner");
+        QCOMPARE(outer.size(), 1);
+        QCOMPARE(inner.size(), 1);
+
+        const QJsonObject outerArgs = outer.first()["args"].toObject();
+        QCOMPARE(outerArgs["operatorNewCalls"].toInt(), 2);
+        QVERIFY(outerArgs["operatorNewBytes"].toDouble() >= 256 * sizeof(int));
+        QCOMPARE(inner.first()["args"].toObject()["operatorNewCalls"].toInt(), 0);
+
+        QCOMPARE(inner.first()["tid"].toInt(), outer.first()["tid"].toInt());
+        QVERIFY(inner.first()["ts"].toDouble() >= outer.first()["ts"].toDouble());
+        QVERIFY(inner.first()["ts"].toDouble() + inner.first()["dur"].toDouble()
+                <= outer.first()["ts"].toDouble() + outer.first()["dur"].toDouble());
+    }
+
+    void testThreadsHaveOwnRows()
+    {
+        {
+            AIRGAP_TRACE_ZONE("thread");
+        }
+        std::thread other([]() {
+            AIRGAP_TRACE_ZONE("thread");
+        });
+        other.join();
+
+        // The other thread's zones stay after it exits
+        const QList<QJsonObject> events = zones("thread");
+        QCOMPARE(events.size(), 2);
+        QVERIFY(events.at(0)["tid"].toInt() != events.at(1)["tid"].toInt());
+    }
+
+    void testKeepsRecentZones()
+    {
+        const int extra = 5;
+        for (int i = 0; i < AirgapTrace::MaxEventsPerThread + extra; ++i) {
+            AIRGAP_TRACE_ZONE("ring");
+        }
+        const QList<QJsonObject> events = zones("ring");
+        QCOMPARE(events.size(), AirgapTrace::MaxEventsPerThread);
+        // Oldest first
+        for (int i = 1; i < events.size(); ++i)
+            QVERIFY(events.at(i)["ts"].toDouble() >= events.at(i - 1)["ts"].toDouble());
+
+        AirgapTrace::clear();
+        QVERIFY(zones("ring").isEmpty());
+    }
+};
+
+QTEST_MAIN(tst_AirgapTrace)
+#include "tst_airgaptrace.moc"
@@ -7,10 +7,20 @@
  * - AC13: FIFO ordering
  * - AC14: Watchdog timeout behavior
  * - Error isolation (AC8)
+ * - Coalescing: same-key tasks replace pending ones and mark running ones stale
+ * - Priority lanes with starvation protection
+ * - Worker tasks overlap, deliver in start order and hold back main-thread tasks
+ * - Worker tasks are not cut off by the watchdog
+ * - Per-task metrics and the Chrome trace export
  */
 #include <QtTest/QtTest>
 #include <QSignalSpy>
 #include <QPromise>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <atomic>
 #include "../asyncserialiser.h"
 
 class tst_AsyncSerialiser : public QObject
@@ -194,21 +204,52 @@ private slots:
     // Note: This test uses a modified timeout for faster testing
     void testWatchdogTimeout()
     {
-        // Skip this test in normal runs as it would take 30 seconds
-        // In real deployment, this would be tested with a shorter timeout or mocked timer
-        QSKIP("Watchdog test requires 30s timeout - skipped for fast test runs");
+        AsyncSerialiser& serialiser = AsyncSerialiser::instance();
+        const int previousTimeout = serialiser.watchdogTimeout();
+        const auto restore = qScopeGuard([&serialiser, previousTimeout]() {
+            serialiser.setWatchdogTimeout(previousTimeout);
+        });
+        serialiser.setWatchdogTimeout(200);
 
-        QSignalSpy timedOutSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskTimedOut);
-        QSignalSpy completedSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskCompleted);
+        QSignalSpy timedOutSpy(&serialiser, &AsyncSerialiser::taskTimedOut);
+        QSignalSpy completedSpy(&serialiser, &AsyncSerialiser::taskCompleted);
 
-        AsyncSerialiser::instance().enqueue("hangingTask", createHangingTask());
+        serialiser.enqueue("hangingTask", createHangingTask());
 
-        // Wait for watchdog (30 seconds + margin)
-        QTRY_COMPARE_WITH_TIMEOUT(timedOutSpy.count(), 1, 35000);
+        QTRY_COMPARE_WITH_TIMEOUT(timedOutSpy.count(), 1, 5000);
         QCOMPARE(completedSpy.count(), 1);
         QCOMPARE(completedSpy.at(0).at(1).toBool(), false); // success = false
     }
 
+    // A worker job running past the watchdog still delivers its result
+    void testWorkerOutlivesWatchdog()
+    {
+        AsyncSerialiser& serialiser = AsyncSerialiser::instance();
+        const int previousTimeout = serialiser.watchdogTimeout();
+        const auto restore = qScopeGuard([&serialiser, previousTimeout]() {
+            serialiser.setWatchdogTimeout(previousTimeout);
+        });
+        serialiser.setWatchdogTimeout(50);
+
+        QSignalSpy timedOutSpy(&serialiser, &AsyncSerialiser::taskTimedOut);
+        QSignalSpy completedSpy(&serialiser, &AsyncSerialiser::taskCompleted);
+        QVariant delivered;
+
+        serialiser.enqueueWorker("formatJson", []() {
+            return AsyncSerialiser::runOnWorker([]() -> QVariant {
+                QThread::msleep(300);
+                return QStringLiteral("formatted");
+            });
+        }, [&delivered](const QVariant& result) {
+            delivered = result;
+        });
+
+        QTRY_COMPARE_WITH_TIMEOUT(completedSpy.count(), 1, 5000);
+        QVERIFY(completedSpy.at(0).at(1).toBool());
+        QCOMPARE(delivered.toString(), QString("formatted"));
+        QCOMPARE(timedOutSpy.count(), 0);
+    }
+
     // 5.1-UNIT-015/016: clearQueue() empties queue and resets state
     void testClearQueue()
     {
@@ -449,6 +490,318 @@ private slots:
         QCOMPARE(completedSpy.at(0).at(0).toString(), taskName);
         QCOMPARE(completedSpy.at(0).at(1).toBool(), true);
     }
+
+    // Pending task with the same coalescing key is replaced, not appended
+    void testCoalescingReplacesPendingTask()
+    {
+        QSignalSpy startedSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskStarted);
+        QSignalSpy completedSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskCompleted);
+        QSignalSpy supersededSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskSuperseded);
+
+        AsyncSerialiser::instance().enqueue("blocker", createDelayedTask(50));
+        AsyncSerialiser::instance().enqueue("validate1", "validate", createFastTask(1));
+        AsyncSerialiser::instance().enqueue("validate2", "validate", createFastTask(2));
+        AsyncSerialiser::instance().enqueue("validate3", "validate", createFastTask(3));
+
+        QCOMPARE(AsyncSerialiser::instance().queueLength(), 2);
+        QCOMPARE(supersededSpy.count(), 2);
+        QCOMPARE(supersededSpy.at(0).at(0).toString(), QString("validate1"));
+        QCOMPARE(supersededSpy.at(1).at(0).toString(), QString("validate2"));
+
+        QTRY_COMPARE(completedSpy.count(), 2);
+        QCOMPARE(startedSpy.at(1).at(0).toString(), QString("validate3"));
+    }
+
+    // Tasks without a key are never coalesced
+    void testEmptyKeyDoesNotCoalesce()
+    {
+        QSignalSpy completedSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskCompleted);
+
+        AsyncSerialiser::instance().enqueue("plain1", QString(), createFastTask());
+        AsyncSerialiser::instance().enqueue("plain2", QString(), createFastTask());
+
+        QTRY_COMPARE(completedSpy.count(), 2);
+    }
+
+    // Running task is marked superseded by a newer task with the same key
+    void testRunningTaskMarkedSuperseded()
+    {
+        bool supersededAtCompletion = false;
+        auto staleAware = [&supersededAtCompletion]() -> QFuture<QVariant> {
+            QPromise<QVariant> promise;
+            auto future = promise.future();
+            promise.start();
+
+            QTimer::singleShot(50, [&supersededAtCompletion, promise = std::move(promise)]() mutable {
+                supersededAtCompletion = AsyncSerialiser::instance().isCurrentTaskSuperseded();
+                promise.addResult(QVariant());
+                promise.finish();
+            });
+
+            return future;
+        };
+
+        QSignalSpy startedSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskStarted);
+        QSignalSpy completedSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskCompleted);
+        QSignalSpy supersededSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskSuperseded);
+
+        AsyncSerialiser::instance().enqueue("first", "validate", staleAware);
+        QTRY_COMPARE(startedSpy.count(), 1);
+
+        AsyncSerialiser::instance().enqueue("second", "validate", createFastTask());
+        QCOMPARE(supersededSpy.count(), 1);
+        QCOMPARE(supersededSpy.at(0).at(0).toString(), QString("first"));
+
+        QTRY_COMPARE(completedSpy.count(), 2);
+        QVERIFY(supersededAtCompletion);
+        QVERIFY(!AsyncSerialiser::instance().isCurrentTaskSuperseded());
+    }
+
+    // Highest-priority lane runs first; each lane stays FIFO
+    void testPriorityLanesOrder()
+    {
+        QStringList order;
+        auto recorder = [&order](const QString& name) -> AsyncSerialiser::AsyncTask {
+            return [&order, name]() -> QFuture<QVariant> {
+                order << name;
+                QPromise<QVariant> promise;
+                promise.start();
+                promise.addResult(QVariant());
+                promise.finish();
+                return promise.future();
+            };
+        };
+
+        QSignalSpy completedSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskCompleted);
+        using Priority = AsyncSerialiser::Priority;
+
+        AsyncSerialiser::instance().enqueue("blocker", createDelayedTask(50));
+        QTRY_COMPARE(AsyncSerialiser::instance().queueLength(), 0);
+
+        AsyncSerialiser::instance().enqueue("history", Priority::Background, recorder("history"));
+        AsyncSerialiser::instance().enqueue("format1", Priority::Normal, recorder("format1"));
+        AsyncSerialiser::instance().enqueue("format2", Priority::Normal, recorder("format2"));
+        AsyncSerialiser::instance().enqueue("copy", Priority::Interactive, recorder("copy"));
+
+        QCOMPARE(AsyncSerialiser::instance().interactiveQueueLength(), 1);
+        QCOMPARE(AsyncSerialiser::instance().normalQueueLength(), 2);
+        QCOMPARE(AsyncSerialiser::instance().backgroundQueueLength(), 1);
+        QCOMPARE(AsyncSerialiser::instance().queueLength(), 4);
+
+        QTRY_COMPARE(completedSpy.count(), 5);
+        QCOMPARE(order, QStringList({"copy", "format1", "format2", "history"}));
+    }
+
+    // A background task is not starved by a steady stream of normal work
+    void testStarvationProtection()
+    {
+        QStringList order;
+        auto recorder = [&order](const QString& name) -> AsyncSerialiser::AsyncTask {
+            return [&order, name]() -> QFuture<QVariant> {
+                order << name;
+                QPromise<QVariant> promise;
+                promise.start();
+                promise.addResult(QVariant());
+                promise.finish();
+                return promise.future();
+            };
+        };
+
+        QSignalSpy completedSpy(&AsyncSerialiser::instance(), &AsyncSerialiser::taskCompleted);
+        using Priority = AsyncSerialiser::Priority;
+
+        AsyncSerialiser::instance().enqueue("blocker", createDelayedTask(50));
+        QTRY_COMPARE(AsyncSerialiser::instance().queueLength(), 0);
+
+        AsyncSerialiser::instance().enqueue("background", Priority::Background, recorder("background"));
+        for (int i = 0; i < 8; ++i) {
+            AsyncSerialiser::instance().enqueue(QString("normal%1").arg(i), Priority::Normal,
+                                                recorder(QString("normal%1").arg(i)));
+        }
+
+        QTRY_COMPARE(completedSpy.count(), 10);
+        // Passed over four times, then served ahead of the remaining normal tasks
+        QCOMPARE(order.indexOf("background"), 4);
+    }
+
+    // Without a JSPI build the concurrency limit is ignored and tasks stay
+    // single-flight even when they are independent
+    void testConcurrencyLimitFallsBackToFifo()
+    {
+        AsyncSerialiser& serialiser = AsyncSerialiser::instance();
+#ifndef ENABLE_JSPI_BUILD
+        QVERIFY(!serialiser.isConcurrentMode());
+#endif
+        if (serialiser.isConcurrentMode())
+            QSKIP("JSPI concurrent mode is active");
+
+        QSignalSpy limitSpy(&serialiser, &AsyncSerialiser::maxConcurrentTasksChanged);
+        const int previousLimit = serialiser.maxConcurrentTasks();
+        serialiser.setMaxConcurrentTasks(4);
+        serialiser.setMaxConcurrentTasks(0);
+        QCOMPARE(serialiser.maxConcurrentTasks(), 1);
+        serialiser.setMaxConcurrentTasks(4);
+        QCOMPARE(serialiser.effectiveConcurrency(), 1);
+        QVERIFY(limitSpy.count() >= 2);
+
+        int maxRunning = 0;
+        connect(&serialiser, &AsyncSerialiser::taskStarted, this, [&serialiser, &maxRunning]() {
+            maxRunning = qMax(maxRunning, serialiser.runningTaskCount());
+        });
+
+        QSignalSpy completedSpy(&serialiser, &AsyncSerialiser::taskCompleted);
+        serialiser.enqueue("formatJson", createDelayedTask(30));
+        serialiser.enqueue("saveToHistory", AsyncSerialiser::Priority::Background, createDelayedTask(30));
+        serialiser.enqueue("copyToClipboard", AsyncSerialiser::Priority::Interactive, createDelayedTask(30));
+
+        QTRY_COMPARE(completedSpy.count(), 3);
+        QCOMPARE(maxRunning, 1);
+        QCOMPARE(serialiser.runningTaskCount(), 0);
+
+        disconnect(&serialiser, &AsyncSerialiser::taskStarted, this, nullptr);
+        serialiser.setMaxConcurrentTasks(previousLimit);
+    }
+    // Worker jobs finishing in reverse order still deliver in start order
+    void testWorkerResultsDeliveredInStartOrder()
+    {
+        AsyncSerialiser& serialiser = AsyncSerialiser::instance();
+        QSignalSpy completedSpy(&serialiser, &AsyncSerialiser::taskCompleted);
+
+        std::atomic<int> active {0};
+        std::atomic<int> maxActive {0};
+        QList<int> delivered;
+
+        for (int i = 0; i < 3; ++i) {
+            serialiser.enqueueWorker(QString("job%1").arg(i), [i, &active, &maxActive]() {
+                return AsyncSerialiser::runOnWorker([i, &active, &maxActive]() -> QVariant {
+                    const int now = ++active;
+                    int seen = maxActive.load();
+                    while (now > seen && !maxActive.compare_exchange_weak(seen, now)) {
+                    }
+                    QThread::msleep((3 - i) * 30);
+                    --active;
+                    return i;
+                });
+            }, [&delivered](const QVariant& result) {
+                delivered.append(result.toInt());
+            });
+        }
+
+        QTRY_COMPARE(completedSpy.count(), 3);
+        QCOMPARE(delivered, QList<int>({0, 1, 2}));
+        for (const QList<QVariant>& args : completedSpy)
+            QVERIFY(args.at(1).toBool());
+        if (AsyncSerialiser::workerConcurrency() > 1)
+            QVERIFY(maxActive.load() >= 2);
+        QCOMPARE(serialiser.runningTaskCount(), 0);
+    }
+
+    // Main-thread tasks never overlap worker tasks
+    void testMainThreadTaskWaitsForWorkers()
+    {
+        AsyncSerialiser& serialiser = AsyncSerialiser::instance();
+        QSignalSpy completedSpy(&serialiser, &AsyncSerialiser::taskCompleted);
+
+        bool delivered = false;
+        bool startedAfterDelivery = false;
+        serialiser.enqueueWorker("formatJson", []() {
+            return AsyncSerialiser::runOnWorker([]() -> QVariant {
+                QThread::msleep(50);
+                return QVariant();
+            });
+        }, [&delivered](const QVariant&) {
+            delivered = true;
+        });
+        serialiser.enqueue("copyToClipboard", [this, &delivered, &startedAfterDelivery]() {
+            startedAfterDelivery = delivered;
+            return createFastTask()();
+        });
+
+        QTRY_COMPARE(completedSpy.count(), 2);
+        QVERIFY(startedAfterDelivery);
+        QCOMPARE(completedSpy.at(0).at(0).toString(), QString("formatJson"));
+    }
+
+    // Wait and run times, outcomes and payloads are recorded per task name
+    void testMetricsRecordTimings()
+    {
+        AsyncSerialiser& serialiser = AsyncSerialiser::instance();
+        serialiser.resetMetrics();
+        QSignalSpy completedSpy(&serialiser, &AsyncSerialiser::taskCompleted);
+
+        serialiser.enqueue("measured", [this]() {
+            AsyncSerialiser::instance().setCurrentTaskPayload(100);
+            return createDelayedTask(50)();
+        });
+        serialiser.enqueue("measured", [this]() {
+            AsyncSerialiser::instance().setCurrentTaskPayload(23);
+            return createDelayedTask(50)();
+        });
+        serialiser.enqueue("measured", createFailingTask());
+        QTRY_COMPARE(completedSpy.count(), 3);
+
+        const QVariantMap task = serialiser.metrics()["tasks"].toMap()["measured"].toMap();
+        QCOMPARE(task["count"].toLongLong(), 3);
+        QCOMPARE(task["succeeded"].toLongLong(), 2);
+        QCOMPARE(task["failed"].toLongLong(), 1);
+        QCOMPARE(task["payloadBytes"].toLongLong(), 123);
+        QCOMPARE(task["nearTimeout"].toLongLong(), 0);
+
+        // The second task waited for the first; the third for both
+        const QVariantMap run = task["runMs"].toMap();
+        const QVariantMap wait = task["waitMs"].toMap();
+        QCOMPARE(run["count"].toLongLong(), 3);
+        QVERIFY(run["max"].toDouble() >= 40);
+        QVERIFY(run["p50"].toDouble() >= 40);
+        QVERIFY(wait["max"].toDouble() >= 80);
+        QVERIFY(wait["min"].toDouble() <= wait["p50"].toDouble());
+        QVERIFY(wait["p50"].toDouble() <= wait["max"].toDouble());
+    }
+
+    void testMetricsCountRejectionsAndSupersedes()
+    {
+        AsyncSerialiser& serialiser = AsyncSerialiser::instance();
+        serialiser.resetMetrics();
+
+        serialiser.enqueue("stale", "key", createFastTask());
+        serialiser.enqueue("fresh", "key", createFastTask());
+        for (int i = 0; i < 100; i++)
+            serialiser.enqueue("fill", createDelayedTask(1000));
+
+        const QVariantMap metrics = serialiser.metrics();
+        const QVariantMap tasks = metrics["tasks"].toMap();
+        QCOMPARE(tasks["stale"].toMap()["superseded"].toLongLong(), 1);
+        QCOMPARE(tasks["fill"].toMap()["rejected"].toLongLong(), 1);
+        QCOMPARE(metrics["peakQueueLength"].toInt(), 100);
+        QCOMPARE(metrics["watchdogMs"].toInt(), 30000);
+
+        serialiser.clearQueue();
+    }
+
+    // Runs are complete events and queue waits are async spans
+    void testChromeTraceExport()
+    {
+        AsyncSerialiser& serialiser = AsyncSerialiser::instance();
+        serialiser.resetMetrics();
+        QSignalSpy completedSpy(&serialiser, &AsyncSerialiser::taskCompleted);
+
+        serialiser.enqueue("traced", createDelayedTask(20));
+        QTRY_COMPARE(completedSpy.count(), 1);
+
+        const QJsonArray events = QJsonDocument::fromJson(serialiser.chromeTrace()).object()["traceEvents"].toArray();
+        QStringList phases;
+        for (const QJsonValue& value : events) {
+            const QJsonObject event = value.toObject();
+            if (event["name"].toString() != "traced")
+                continue;
+            phases.append(event["ph"].toString());
+            if (event["ph"].toString() == "X") {
+                QVERIFY(event["dur"].toDouble() >= 15000);
+                QVERIFY(event["args"].toObject()["succeeded"].toBool());
+            }
+        }
+        QCOMPARE(phases, QStringList({"b", "e", "X"}));
+    }
 };
 
 QTEST_MAIN(tst_AsyncSerialiser)
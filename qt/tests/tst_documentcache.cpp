@@ -0,0 +1,131 @@
+/**
+ * @file tst_documentcache.cpp
+ * @brief Unit tests for DocumentCache
+ *
+ * Tests verify:
+ * - Keys depend on the input bytes and length
+ * - Derived keys depend on the source key and the output name
+ * - Lookups count hits and misses per named value
+ * - Least recently used entries are evicted past the budget
+ * - Values larger than the budget are not cached
+ * - Lookups and inserts from different threads are safe
+ */
+#include <QtTest/QtTest>
+#include <QJsonDocument>
+#include "../documentcache.h"
+
+class tst_DocumentCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testKeyForInput()
+    {
+        const QByteArray input = "{\"a\": 1}";
+        QCOMPARE(DocumentCache::keyFor(input), DocumentCache::keyFor(QByteArray(input)));
+        QCOMPARE(DocumentCache::keyFor(input).length, input.size());
+        QVERIFY(!(DocumentCache::keyFor(input) == DocumentCache::keyFor("{\"a\": 2}")));
+    }
+
+    // A derived key differs per output name and from its source key
+    void testDerivedKey()
+    {
+        const DocumentCache::Key source = DocumentCache::keyFor("{\"a\": 1}");
+        const DocumentCache::Key minified = DocumentCache::derivedKey(source, DocumentCache::Minified);
+        QCOMPARE(minified, DocumentCache::derivedKey(source, DocumentCache::Minified));
+        QVERIFY(!(minified == source));
+        QVERIFY(!(minified == DocumentCache::derivedKey(source, DocumentCache::formattedName("spaces:2"))));
+        QVERIFY(!(minified == DocumentCache::derivedKey(DocumentCache::keyFor("[]"), DocumentCache::Minified)));
+    }
+
+    // Values of one entry are found by name; absent names count as misses
+    void testHitsAndMisses()
+    {
+        DocumentCache cache;
+        const DocumentCache::Key key = DocumentCache::keyFor("[1, 2]");
+
+        QVERIFY(!cache.value(key, DocumentCache::Document).isValid());
+        QCOMPARE(cache.misses(), quint64(1));
+
+        const QJsonDocument doc = QJsonDocument::fromJson("[1, 2]");
+        cache.insert(key, DocumentCache::Document, QVariant::fromValue(doc), 12);
+        cache.insert(key, DocumentCache::Minified, QStringLiteral("[1,2]"), 10);
+        QCOMPARE(cache.count(), qsizetype(1));
+
+        QCOMPARE(cache.value(key, DocumentCache::Document).value<QJsonDocument>(), doc);
+        QCOMPARE(cache.value(key, DocumentCache::Minified).toString(), QString("[1,2]"));
+        QVERIFY(!cache.value(key, DocumentCache::formattedName("spaces:2")).isValid());
+        QCOMPARE(cache.hits(), quint64(2));
+        QCOMPARE(cache.misses(), quint64(2));
+
+        // Replacing a value charges the new cost only
+        const qsizetype before = cache.totalCost();
+        cache.insert(key, DocumentCache::Minified, QStringLiteral("[1,2]"), 20);
+        QCOMPARE(cache.totalCost(), before + 10);
+
+        cache.resetCounters();
+        QCOMPARE(cache.hits(), quint64(0));
+        QCOMPARE(cache.misses(), quint64(0));
+    }
+
+    // Looking an entry up keeps it; the least recently used one goes
+    void testLeastRecentlyUsedEviction()
+    {
+        const qsizetype valueCost = 4096;
+        DocumentCache cache(3 * valueCost);
+        const DocumentCache::Key first = DocumentCache::keyFor("1");
+        const DocumentCache::Key second = DocumentCache::keyFor("2");
+        const DocumentCache::Key third = DocumentCache::keyFor("3");
+
+        cache.insert(first, DocumentCache::Minified, QStringLiteral("1"), valueCost);
+        cache.insert(second, DocumentCache::Minified, QStringLiteral("2"), valueCost);
+        QVERIFY(cache.value(first, DocumentCache::Minified).isValid());
+
+        cache.insert(third, DocumentCache::Minified, QStringLiteral("3"), valueCost);
+        QCOMPARE(cache.count(), qsizetype(2));
+        QVERIFY(cache.value(first, DocumentCache::Minified).isValid());
+        QVERIFY(!cache.value(second, DocumentCache::Minified).isValid());
+        QVERIFY(cache.totalCost() <= cache.budget());
+
+        cache.setBudget(0);
+        QCOMPARE(cache.count(), qsizetype(0));
+    }
+
+    // A value over budget is skipped without evicting its entry
+    void testOversizedValueSkipped()
+    {
+        DocumentCache cache(8192);
+        const DocumentCache::Key key = DocumentCache::keyFor("{}");
+
+        cache.insert(key, DocumentCache::Minified, QStringLiteral("{}"), 4);
+        cache.insert(key, DocumentCache::Document, QVariant::fromValue(QJsonDocument::fromJson("{}")), 1 << 20);
+
+        QVERIFY(cache.value(key, DocumentCache::Minified).isValid());
+        QVERIFY(!cache.value(key, DocumentCache::Document).isValid());
+    }
+
+    // Worker jobs look values up while the main thread inserts
+    void testConcurrentLookups()
+    {
+        DocumentCache cache;
+        constexpr int Rounds = 2000;
+        const DocumentCache::Key key = DocumentCache::keyFor("[1]");
+        cache.insert(key, DocumentCache::Minified, QStringLiteral("[1]"), 6);
+
+        QScopedPointer<QThread> reader(QThread::create([&cache, key]() {
+            for (int i = 0; i < Rounds; ++i)
+                cache.value(key, DocumentCache::Minified);
+        }));
+        reader->start();
+        for (int i = 0; i < Rounds; ++i)
+            cache.insert(DocumentCache::keyFor(QByteArray::number(i)), DocumentCache::Minified,
+                         QString::number(i), 64);
+        QVERIFY(reader->wait(5000));
+
+        QCOMPARE(cache.hits() + cache.misses(), quint64(Rounds));
+        QVERIFY(cache.totalCost() <= cache.budget());
+    }
+};
+
+QTEST_MAIN(tst_DocumentCache)
+#include "tst_documentcache.moc"
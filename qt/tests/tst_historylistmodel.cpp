@@ -0,0 +1,103 @@
+/**
+ * @file tst_historylistmodel.cpp
+ * @brief Unit tests for HistoryListModel
+ *
+ * Tests verify:
+ * - fetchMore requests one page at a time from the current offset
+ * - Pages for a stale query or offset are ignored
+ * - Paging stops once every matching entry is loaded
+ */
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include "../historylistmodel.h"
+
+class tst_HistoryListModel : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QVariantList makePage(int first, int count)
+    {
+        QVariantList page;
+        for (int i = first; i < first + count; ++i) {
+            QVariantMap entry;
+            entry["id"] = QString("id%1").arg(i);
+            entry["timestamp"] = "2026-01-01T00:00:00";
+            entry["preview"] = QString("{\"n\": %1}").arg(i);
+            entry["size"] = 8;
+            page.append(entry);
+        }
+        return page;
+    }
+
+private slots:
+    // Each fetch asks for the next page; rows accumulate
+    void testPagesAppend()
+    {
+        HistoryListModel model;
+        QSignalSpy requestSpy(&model, &HistoryListModel::pageRequested);
+
+        QVERIFY(model.canFetchMore());
+        model.fetchMore();
+        QCOMPARE(requestSpy.count(), 1);
+        QCOMPARE(requestSpy.at(0).at(1).toInt(), 0);
+        QCOMPARE(requestSpy.at(0).at(2).toInt(), int(HistoryListModel::PageSize));
+        QVERIFY(model.isLoading());
+        QVERIFY(!model.canFetchMore());
+
+        const int total = HistoryListModel::PageSize + 5;
+        model.appendPage(QString(), 0, makePage(0, HistoryListModel::PageSize), total);
+        QCOMPARE(model.rowCount(), int(HistoryListModel::PageSize));
+        QCOMPARE(model.totalCount(), total);
+        QVERIFY(model.canFetchMore());
+
+        model.fetchMore();
+        QCOMPARE(requestSpy.at(1).at(1).toInt(), int(HistoryListModel::PageSize));
+        model.appendPage(QString(), HistoryListModel::PageSize, makePage(HistoryListModel::PageSize, 5), total);
+        QCOMPARE(model.rowCount(), total);
+        QVERIFY(!model.canFetchMore());
+
+        const QModelIndex last = model.index(total - 1);
+        QCOMPARE(model.data(last, HistoryListModel::EntryIdRole).toString(), QString("id%1").arg(total - 1));
+        QCOMPARE(model.data(last, HistoryListModel::SizeRole).toLongLong(), qint64(8));
+    }
+
+    // Changing the query restarts paging; pages for the old query are dropped
+    void testStalePagesIgnored()
+    {
+        HistoryListModel model;
+        QSignalSpy requestSpy(&model, &HistoryListModel::pageRequested);
+
+        model.fetchMore();
+        model.setSearchQuery("n");
+        QCOMPARE(requestSpy.count(), 2);
+        QCOMPARE(requestSpy.at(1).at(0).toString(), QString("n"));
+
+        model.appendPage(QString(), 0, makePage(0, 3), 3);
+        QCOMPARE(model.rowCount(), 0);
+        QVERIFY(model.isLoading());
+
+        model.appendPage("n", 5, makePage(5, 1), 6);
+        QCOMPARE(model.rowCount(), 0);
+
+        model.appendPage("n", 0, makePage(0, 2), 2);
+        QCOMPARE(model.rowCount(), 2);
+        QCOMPARE(model.totalCount(), 2);
+    }
+
+    // An empty store reports zero entries and stops paging
+    void testEmptyResult()
+    {
+        HistoryListModel model;
+        model.reload();
+        model.appendPage(QString(), 0, QVariantList(), 0);
+
+        QCOMPARE(model.rowCount(), 0);
+        QCOMPARE(model.totalCount(), 0);
+        QVERIFY(!model.isLoading());
+        QVERIFY(!model.canFetchMore());
+    }
+};
+
+QTEST_MAIN(tst_HistoryListModel)
+#include "tst_historylistmodel.moc"
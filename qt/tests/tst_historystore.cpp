@@ -0,0 +1,172 @@
+/**
+ * @file tst_historystore.cpp
+ * @brief Unit tests for HistoryStore
+ *
+ * Tests verify:
+ * - Entries are listed from the index alone; content lives in blobs
+ * - Identical content is stored once, compressed
+ * - Deletes append tombstones that survive reopening the store
+ * - Compaction drops dead index records and unreferenced blobs
+ * - The legacy single-file history.json is migrated
+ */
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "../historystore.h"
+
+class tst_HistoryStore : public QObject
+{
+    Q_OBJECT
+
+private:
+    static int indexLineCount(const QString& directory)
+    {
+        QFile file(directory + "/index.jsonl");
+        if (!file.open(QIODevice::ReadOnly))
+            return 0;
+        return file.readAll().count('\n');
+    }
+
+    static int blobCount(const QString& directory)
+    {
+        return QDir(directory + "/blobs").entryList(QDir::Files).size();
+    }
+
+private slots:
+    // Most recent first; content is read back by id
+    void testAddListAndLookup()
+    {
+        QTemporaryDir dir;
+        HistoryStore store(dir.path());
+
+        const QString first = store.add(QStringLiteral("{\"a\": 1}"));
+        const QString second = store.add(QStringLiteral("[1, 2, 3]"));
+        QVERIFY(!first.isEmpty());
+        QVERIFY(!second.isEmpty());
+
+        const QVector<HistoryStore::Entry> entries = store.entries();
+        QCOMPARE(entries.size(), 2);
+        QCOMPARE(entries.at(0).id, second);
+        QCOMPARE(entries.at(0).preview, QString("[1, 2, 3]"));
+        QCOMPARE(entries.at(0).size, qint64(9));
+        QCOMPARE(store.content(first), QString("{\"a\": 1}"));
+        QCOMPARE(blobCount(dir.path()), 2);
+        QCOMPARE(indexLineCount(dir.path()), 2);
+    }
+
+    // Re-saving stored content refreshes its entry and reuses the blob
+    void testDuplicateContentStoredOnce()
+    {
+        QTemporaryDir dir;
+        HistoryStore store(dir.path());
+
+        const QString payload = "[" + QString("{\"key\": \"value\"}, ").repeated(1000) + "null]";
+        const QString first = store.add(payload);
+        const QString other = store.add(QStringLiteral("{}"));
+        const QString again = store.add(payload);
+
+        QCOMPARE(again, first);
+        QCOMPARE(store.count(), 2);
+        QCOMPARE(store.entries().at(0).id, first);
+        QCOMPARE(store.entries().at(1).id, other);
+        QCOMPARE(blobCount(dir.path()), 2);
+        QCOMPARE(store.content(first), payload);
+
+        const QString blob = dir.filePath("blobs/" + store.entries().at(0).hash + ".z");
+        QVERIFY(QFileInfo(blob).size() < payload.size() / 10);
+    }
+
+    // A reopened store replays the index, tombstones included
+    void testRemovePersistsAsTombstone()
+    {
+        QTemporaryDir dir;
+        QString kept;
+        {
+            HistoryStore store(dir.path());
+            const QString removed = store.add(QStringLiteral("1"));
+            kept = store.add(QStringLiteral("2"));
+            QVERIFY(store.remove(removed));
+            QVERIFY(!store.remove(removed));
+            QVERIFY(store.content(removed).isEmpty());
+        }
+
+        QCOMPARE(indexLineCount(dir.path()), 3);
+
+        HistoryStore reopened(dir.path());
+        QCOMPARE(reopened.count(), 1);
+        QCOMPARE(reopened.entries().at(0).id, kept);
+        QCOMPARE(reopened.content(kept), QString("2"));
+    }
+
+    // Old entries beyond the limit are tombstoned; compaction rewrites
+    // the index and removes their blobs
+    void testTrimAndCompact()
+    {
+        QTemporaryDir dir;
+        HistoryStore store(dir.path());
+
+        const int total = HistoryStore::MaxEntries + HistoryStore::CompactionThreshold;
+        for (int i = 0; i < total; ++i)
+            QVERIFY(!store.add(QString::number(i)).isEmpty());
+
+        QCOMPARE(store.count(), HistoryStore::MaxEntries);
+        QVERIFY(store.needsCompaction());
+        QCOMPARE(blobCount(dir.path()), total);
+
+        QVERIFY(store.compact());
+        QVERIFY(!store.needsCompaction());
+        QCOMPARE(indexLineCount(dir.path()), HistoryStore::MaxEntries);
+        QCOMPARE(blobCount(dir.path()), HistoryStore::MaxEntries);
+        QCOMPARE(store.content(store.entries().first().id), QString::number(total - 1));
+    }
+
+    // Entries from the former history.json keep their ids and order
+    void testImportLegacyFile()
+    {
+        QTemporaryDir dir;
+        const QString legacyPath = dir.filePath("history.json");
+
+        QJsonArray legacy;
+        for (const QString& id : {QStringLiteral("newer"), QStringLiteral("older")}) {
+            QJsonObject entry;
+            entry["id"] = id;
+            entry["content"] = "{\"id\": \"" + id + "\"}";
+            entry["timestamp"] = "2026-01-01T00:00:00";
+            entry["preview"] = id;
+            entry["size"] = 0;
+            legacy.append(entry);
+        }
+        QFile file(legacyPath);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QJsonDocument(legacy).toJson());
+        file.close();
+
+        HistoryStore store(dir.filePath("history"));
+        QVERIFY(store.importLegacyFile(legacyPath));
+        QVERIFY(!QFile::exists(legacyPath));
+
+        const QVector<HistoryStore::Entry> entries = store.entries();
+        QCOMPARE(entries.size(), 2);
+        QCOMPARE(entries.at(0).id, QString("newer"));
+        QCOMPARE(store.content("older"), QString("{\"id\": \"older\"}"));
+        QCOMPARE(entries.at(1).size, qint64(15));
+    }
+
+    // Clearing removes the index and every blob
+    void testClear()
+    {
+        QTemporaryDir dir;
+        HistoryStore store(dir.path());
+        store.add(QStringLiteral("[]"));
+
+        QVERIFY(store.clear());
+        QCOMPARE(store.count(), 0);
+        QCOMPARE(blobCount(dir.path()), 0);
+        QVERIFY(!QFile::exists(dir.filePath("index.jsonl")));
+    }
+};
+
+QTEST_MAIN(tst_HistoryStore)
+#include "tst_historystore.moc"
@@ -10,8 +10,10 @@
  */
 #include <QtTest/QtTest>
 #include <QSignalSpy>
+#include <QTemporaryDir>
 #include "../jsonbridge.h"
 #include "../asyncserialiser.h"
+#include "../qjsontreemodel.h"
 
 class tst_JsonBridgeAsync : public QObject
 {
@@ -144,6 +146,204 @@ private slots:
         QVERIFY(!error["message"].toString().isEmpty());
     }
 
+    // processJson answers format, minify, stats and tree from one request
+    void testProcessJsonSingleParse()
+    {
+        QSignalSpy processCompletedSpy(m_bridge, &JsonBridge::processCompleted);
+
+        QVariantMap options;
+        options["format"] = true;
+        options["minify"] = true;
+        options["stats"] = true;
+        options["tree"] = true;
+        options["indentType"] = "spaces:2";
+        m_bridge->processJson("{\"obj\": {\"n\": 1}, \"arr\": [true]}", options);
+
+        QTRY_COMPARE(processCompletedSpy.count(), 1);
+        QVariantMap result = processCompletedSpy.at(0).at(0).toMap();
+
+        QVERIFY(result["success"].toBool());
+        QVERIFY(result["formatted"].toString().contains('\n'));
+        QCOMPARE(result["minified"].toString(), QString("{\"arr\":[true],\"obj\":{\"n\":1}}"));
+        QVariantMap validation = result["validation"].toMap();
+        QVERIFY(validation["isValid"].toBool());
+        QVERIFY(validation["stats"].toMap()["object_count"].toInt() >= 2);
+        QVERIFY(result["tree"].toBool());
+        QVERIFY(m_bridge->treeModel()->totalNodeCount() > 0);
+    }
+
+    // processJson reports the parse error and produces no outputs
+    void testProcessJsonInvalidInput()
+    {
+        QSignalSpy processCompletedSpy(m_bridge, &JsonBridge::processCompleted);
+
+        QVariantMap options;
+        options["format"] = true;
+        options["tree"] = true;
+        m_bridge->processJson("{invalid}", options);
+
+        QTRY_COMPARE(processCompletedSpy.count(), 1);
+        QVariantMap result = processCompletedSpy.at(0).at(0).toMap();
+
+        QVERIFY(!result["success"].toBool());
+        QVERIFY(!result["error"].toString().isEmpty());
+        QVERIFY(!result.contains("formatted"));
+        QVERIFY(!result["tree"].toBool());
+        QCOMPARE(result["validation"].toMap()["error"].toMap()["line"].toInt(), 1);
+    }
+
+    // processJson and validateJson place an error after non-ASCII text the
+    // same way, counting columns in code points
+    void testProcessJsonErrorMatchesValidation()
+    {
+        QSignalSpy processCompletedSpy(m_bridge, &JsonBridge::processCompleted);
+        QSignalSpy validateCompletedSpy(m_bridge, &JsonBridge::validateCompleted);
+        const QString input = QString::fromUtf8("{\"caf\u00e9\": \"\u00fc\u00fc\",\n \"\u00e9\": x}");
+
+        QVariantMap options;
+        options["format"] = true;
+        m_bridge->processJson(input, options);
+        m_bridge->validateJson(input);
+
+        QTRY_COMPARE(processCompletedSpy.count(), 1);
+        QTRY_COMPARE(validateCompletedSpy.count(), 1);
+        const QVariantMap processError = processCompletedSpy.at(0).at(0).toMap()["validation"]
+                                             .toMap()["error"].toMap();
+        const QVariantMap validateError = validateCompletedSpy.at(0).at(0).toMap()["error"].toMap();
+
+        QCOMPARE(processError["line"].toInt(), 2);
+        QCOMPARE(processError["column"].toInt(), 7);
+        QCOMPARE(processError, validateError);
+    }
+
+    // Re-formatting unchanged input is answered from the document cache
+    void testFormatUsesDocumentCache()
+    {
+        QSignalSpy formatCompletedSpy(m_bridge, &JsonBridge::formatCompleted);
+        const QString input = "{\"cached\": [1, 2, 3]}";
+
+        m_bridge->formatJson(input, "spaces:4");
+        QTRY_COMPARE(formatCompletedSpy.count(), 1);
+        const quint64 hitsAfterFirst = m_bridge->cacheStats()["hits"].toULongLong();
+
+        m_bridge->formatJson(input, "spaces:4");
+        QTRY_COMPARE(formatCompletedSpy.count(), 2);
+        QCOMPARE(formatCompletedSpy.at(1).at(0).toMap()["result"],
+                 formatCompletedSpy.at(0).at(0).toMap()["result"]);
+        QVERIFY(m_bridge->cacheStats()["hits"].toULongLong() > hitsAfterFirst);
+
+        // A zero budget disables caching
+        m_bridge->setCacheBudget(0);
+        QCOMPARE(m_bridge->cacheStats()["entries"].toLongLong(), qint64(0));
+        m_bridge->formatJson(input, "spaces:4");
+        QTRY_COMPARE(formatCompletedSpy.count(), 3);
+        QVERIFY(formatCompletedSpy.at(2).at(0).toMap()["success"].toBool());
+        QCOMPARE(m_bridge->cacheStats()["entries"].toLongLong(), qint64(0));
+    }
+
+    // The tree built from a format result reuses the parsed document
+    // through the output's derived key
+    void testTreeFromOutputUsesDerivedKey()
+    {
+        QSignalSpy formatCompletedSpy(m_bridge, &JsonBridge::formatCompleted);
+        QSignalSpy loadFinishedSpy(m_bridge->treeModel(), &QJsonTreeModel::loadFinished);
+
+        m_bridge->formatJson("{\"derived\": [1, 2]}", "spaces:2");
+        QTRY_COMPARE(formatCompletedSpy.count(), 1);
+        const QString output = formatCompletedSpy.at(0).at(0).toMap()["result"].toString();
+        const quint64 hits = m_bridge->cacheStats()["hits"].toULongLong();
+        const quint64 misses = m_bridge->cacheStats()["misses"].toULongLong();
+
+        m_bridge->loadTreeModel(output);
+        QTRY_COMPARE(loadFinishedSpy.count(), 1);
+        QVERIFY(loadFinishedSpy.at(0).at(0).toBool());
+        QCOMPARE(m_bridge->cacheStats()["hits"].toULongLong(), hits + 1);
+        QCOMPARE(m_bridge->cacheStats()["misses"].toULongLong(), misses);
+    }
+
+    // formatFile streams file to file off the serialiser queue
+    void testFormatFileCompletes()
+    {
+        QTemporaryDir dir;
+        const QString inputPath = dir.filePath("in.json");
+        const QString outputPath = dir.filePath("out.json");
+        {
+            QFile file(inputPath);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write("{\"a\":[1,2]}");
+        }
+
+        QSignalSpy completedSpy(m_bridge, &JsonBridge::fileFormatCompleted);
+        m_bridge->formatFile(QUrl::fromLocalFile(inputPath).toString(), outputPath, "spaces:2");
+
+        QTRY_COMPARE(completedSpy.count(), 1);
+        QVariantMap result = completedSpy.at(0).at(0).toMap();
+        QVERIFY(result["success"].toBool());
+
+        QFile output(outputPath);
+        QVERIFY(output.open(QIODevice::ReadOnly));
+        QCOMPARE(output.readAll(), QByteArray("{\n  \"a\": [\n    1,\n    2\n  ]\n}"));
+    }
+
+    void testOpenFileLoadsModels()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("open.json");
+        {
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write("{\"a\": [1, 2], \"b\": {\"c\": null}}");
+        }
+
+        QSignalSpy openedSpy(m_bridge, &JsonBridge::fileOpened);
+        m_bridge->openFile(QUrl::fromLocalFile(path).toString(), "spaces:2");
+
+        QTRY_COMPARE(openedSpy.count(), 1);
+        QVariantMap result = openedSpy.at(0).at(0).toMap();
+        QVERIFY(result["success"].toBool());
+        QCOMPARE(result["fileName"].toString(), QString("open.json"));
+        QVERIFY(result["validation"].toMap()["isValid"].toBool());
+        QVERIFY(m_bridge->treeModel()->totalNodeCount() > 0);
+        QCOMPARE(m_bridge->outputModel()->lineCount(), result["lineCount"].toInt());
+        QVERIFY(m_bridge->outputModel()->text().startsWith("{\n  \"a\": ["));
+    }
+
+    // A file that cannot be read still reports back
+    void testOpenFileReportsErrors()
+    {
+        QTemporaryDir dir;
+        QSignalSpy openedSpy(m_bridge, &JsonBridge::fileOpened);
+
+        m_bridge->openFile(QUrl::fromLocalFile(dir.filePath("missing.json")).toString(), "spaces:2");
+
+        QTRY_COMPARE(openedSpy.count(), 1);
+        const QVariantMap result = openedSpy.at(0).at(0).toMap();
+        QVERIFY(!result["success"].toBool());
+        QVERIFY(result["error"].toString().startsWith("Cannot open"));
+    }
+
+    // Only the newest of several openFile() calls is shown
+    void testNewerOpenFileSupersedes()
+    {
+        QTemporaryDir dir;
+        const QString first = dir.filePath("first.json");
+        const QString second = dir.filePath("second.json");
+        for (const QString &path : {first, second}) {
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write("[1, 2, 3]");
+        }
+
+        QSignalSpy openedSpy(m_bridge, &JsonBridge::fileOpened);
+        m_bridge->openFile(QUrl::fromLocalFile(first).toString(), "spaces:2");
+        m_bridge->openFile(QUrl::fromLocalFile(second).toString(), "spaces:2");
+
+        QTRY_COMPARE(openedSpy.count(), 1);
+        QTest::qWait(100);
+        QCOMPARE(openedSpy.count(), 1);
+        QCOMPARE(openedSpy.at(0).at(0).toMap()["fileName"].toString(), QString("second.json"));
+    }
+
     // 5.2-UNIT-008: saveToHistory enqueues task to AsyncSerialiser
     void testSaveToHistoryUsesAsyncSerialiser()
     {
@@ -172,6 +372,26 @@ private slots:
         QTRY_COMPARE(historyLoadedSpy.count(), 1);
     }
 
+    // History pages carry metadata only and feed the history model
+    void testLoadHistoryPageFillsModel()
+    {
+        QSignalSpy historySavedSpy(m_bridge, &JsonBridge::historySaved);
+        m_bridge->saveToHistory("{\"page\": \"test\"}");
+        QTRY_COMPARE(historySavedSpy.count(), 1);
+
+        QSignalSpy pageSpy(m_bridge, &JsonBridge::historyPageLoaded);
+        HistoryListModel* model = m_bridge->historyModel();
+        model->reload();
+
+        QTRY_COMPARE(pageSpy.count(), 1);
+        const QVariantList entries = pageSpy.at(0).at(2).toList();
+        QVERIFY(!entries.isEmpty());
+        QVERIFY(entries.size() <= HistoryListModel::PageSize);
+        QVERIFY(!entries.at(0).toMap().contains("content"));
+        QVERIFY(pageSpy.at(0).at(3).toInt() >= entries.size());
+        QCOMPARE(model->rowCount(), entries.size());
+    }
+
     // 5.2-UNIT-010: copyToClipboard enqueues task to AsyncSerialiser
     void testCopyToClipboardUsesAsyncSerialiser()
     {
@@ -377,6 +597,41 @@ private slots:
 
         QTRY_COMPARE(historyEntryLoadedSpy.count(), 1);
     }
+
+    // Highlighter: keys are recognised from the following colon without
+    // look-ahead, and string contents are HTML-escaped
+    void testHighlightJsonKeysAndEscaping()
+    {
+        const QString html = m_bridge->highlightJson(
+            QStringLiteral("{\n  \"a<b\" : \"x&\\\"y\",\n  \"n\": [1, -2.5e3, true, null]\n}"));
+
+        QVERIFY(html.startsWith("<pre"));
+        QVERIFY(html.endsWith("</pre>"));
+        QVERIFY(html.contains("<span style=\"color:#8fa1b3;\">\"a&lt;b\"</span>"));
+        QVERIFY(html.contains("<span style=\"color:#a3be8c;\">\"x&amp;\\\"y\"</span>"));
+        QVERIFY(html.contains("<span style=\"color:#8fa1b3;\">\"n\"</span>"));
+        QVERIFY(html.contains("<span style=\"color:#d08770;\">-2.5e3</span>"));
+        QVERIFY(html.contains("<span style=\"color:#b48ead;\">true</span>"));
+        QVERIFY(html.contains("<span style=\"color:#bf616a;\">null</span>"));
+    }
+
+    // Rapid validations while typing coalesce into the latest input
+    void testRapidValidateCallsCoalesce()
+    {
+        QSignalSpy validateCompletedSpy(m_bridge, &JsonBridge::validateCompleted);
+
+        m_bridge->validateJson("{\"a\": 1}");
+        m_bridge->validateJson("{\"a\": 1, \"b\"");
+        m_bridge->validateJson("{\"a\": [1, 2], \"b\": {}}");
+
+        QTRY_COMPARE(validateCompletedSpy.count(), 1);
+        QTest::qWait(50);
+        QCOMPARE(validateCompletedSpy.count(), 1);
+
+        QVariantMap result = validateCompletedSpy.at(0).at(0).toMap();
+        QVERIFY(result["isValid"].toBool());
+        QCOMPARE(result["stats"].toMap()["array_count"].toInt(), 1);
+    }
 };
 
 QTEST_MAIN(tst_JsonBridgeAsync)
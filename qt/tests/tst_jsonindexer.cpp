@@ -0,0 +1,247 @@
+/**
+ * @file tst_jsonindexer.cpp
+ * @brief Unit tests for JsonIndexer
+ *
+ * Tests verify:
+ * - Value counts and depth match the validation stats of a parsed document
+ * - Backslash runs and strings spanning 64-byte blocks are resolved
+ * - Invalid input is rejected with the byte offset, line and column
+ * - Top-level scalars are only rejected when a container is required
+ * - Incremental re-validation matches a full scan and rescans only the edit
+ */
+#include <QtTest/QtTest>
+#include <functional>
+#include "../jsonindexer.h"
+
+class tst_JsonIndexer : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Records over many checkpoint intervals, one per line
+    static QByteArray records(int count)
+    {
+        QByteArray input = "[\n";
+        for (int i = 0; i < count; ++i)
+            input += "  {\"id\": " + QByteArray::number(i) + ", \"name\": \"it\\\"em \xc3\xa9\", \"tags\": [true, null],"
+                     " \"o\": {\"d\": [[]]}},\n";
+        input += "  []\n]\n";
+        return input;
+    }
+
+    static bool sameResult(const JsonIndexer::Result& a, const JsonIndexer::Result& b)
+    {
+        return a.valid == b.valid && a.error == b.error && a.errorOffset == b.errorOffset
+               && a.errorLine == b.errorLine && a.errorColumn == b.errorColumn
+               && a.stats.objects == b.stats.objects && a.stats.arrays == b.stats.arrays
+               && a.stats.strings == b.stats.strings && a.stats.numbers == b.stats.numbers
+               && a.stats.booleans == b.stats.booleans && a.stats.nulls == b.stats.nulls
+               && a.stats.keys == b.stats.keys && a.stats.maxDepth == b.stats.maxDepth;
+    }
+
+private slots:
+    void testStats()
+    {
+        const QByteArray input = "{\"a\": [1, 2.5, -3e2], \"b\": {\"c\": null, \"d\": true, \"e\": false}, \"s\": \"x\"}";
+        const JsonIndexer::Result result = JsonIndexer::validate(input);
+
+        QVERIFY2(result.valid, qPrintable(result.error));
+        QCOMPARE(result.stats.objects, 2);
+        QCOMPARE(result.stats.arrays, 1);
+        QCOMPARE(result.stats.strings, 1);
+        QCOMPARE(result.stats.numbers, 3);
+        QCOMPARE(result.stats.booleans, 2);
+        QCOMPARE(result.stats.nulls, 1);
+        QCOMPARE(result.stats.keys, 6);
+        QCOMPARE(result.stats.maxDepth, 3);
+    }
+
+    // Many blocks with escapes and multi-byte characters
+    void testLargeInput()
+    {
+        QByteArray input = "[";
+        for (int i = 0; i < 1000; ++i)
+            input += "{\"id\": " + QByteArray::number(i) + ", \"name\": \"it\\\"em \xc3\xa9\\n\", \"ok\": true},";
+        input += "[]]";
+
+        const JsonIndexer::Result result = JsonIndexer::validate(input);
+        QVERIFY2(result.valid, qPrintable(result.error));
+        QCOMPARE(result.stats.objects, 1000);
+        QCOMPARE(result.stats.arrays, 2);
+        QCOMPARE(result.stats.strings, 1000);
+        QCOMPARE(result.stats.keys, 3000);
+    }
+
+    // Even runs of backslashes leave the closing quote intact, odd runs
+    // escape it, wherever the run falls relative to a block boundary
+    void testBackslashRunsAcrossBlocks()
+    {
+        for (int offset = JsonIndexer::BlockSize - 9; offset <= JsonIndexer::BlockSize + 6; ++offset) {
+            for (int pairs = 0; pairs < 4; ++pairs) {
+                const QByteArray prefix = "[\"" + QByteArray(offset, 'x');
+                const QByteArray closed = prefix + QByteArray(2 * pairs, '\\') + "\"]";
+                const QByteArray escaped = prefix + QByteArray(2 * pairs + 1, '\\') + "\"]";
+
+                const JsonIndexer::Result even = JsonIndexer::validate(closed);
+                QVERIFY2(even.valid, qPrintable(closed));
+                QCOMPARE(even.stats.strings, 1);
+
+                const JsonIndexer::Result odd = JsonIndexer::validate(escaped);
+                QVERIFY(!odd.valid);
+                QCOMPARE(odd.error, QString("Unterminated string"));
+            }
+        }
+    }
+
+    void testInvalidInput_data()
+    {
+        QTest::addColumn<QByteArray>("input");
+        QTest::addColumn<QString>("message");
+        QTest::addColumn<qsizetype>("offset");
+
+        QTest::newRow("unterminated") << QByteArray("{\"a\": [1, 2") << "Unexpected end of input" << qsizetype(11);
+        QTest::newRow("mismatched") << QByteArray("[1}") << "Expected ',' or ']'" << qsizetype(2);
+        QTest::newRow("trailing comma") << QByteArray("{\"a\": 1,}") << "Expected string key" << qsizetype(8);
+        QTest::newRow("missing colon") << QByteArray("{\"a\" 1}") << "Expected ':'" << qsizetype(5);
+        QTest::newRow("leading zero") << QByteArray("[01]") << "Invalid number" << qsizetype(2);
+        QTest::newRow("bare fraction") << QByteArray("[1.]") << "Invalid number" << qsizetype(3);
+        QTest::newRow("bad literal") << QByteArray("[nul]") << "Invalid literal" << qsizetype(4);
+        QTest::newRow("literal then string") << QByteArray("[true\"x\"]") << "Invalid literal" << qsizetype(5);
+        QTest::newRow("bad escape") << QByteArray("[\"\\x\"]") << "Invalid escape sequence" << qsizetype(3);
+        QTest::newRow("bad unicode escape") << QByteArray("[\"\\u12G4\"]") << "Invalid \\u escape" << qsizetype(6);
+        QTest::newRow("control") << QByteArray("[\"a\x01\"]") << "Control character in string" << qsizetype(3);
+        QTest::newRow("bad utf-8") << QByteArray("[\"\xff\"]") << "Invalid UTF-8" << qsizetype(2);
+        QTest::newRow("surrogate utf-8") << QByteArray("[\"\xed\xa0\x80\"]") << "Invalid UTF-8" << qsizetype(3);
+        QTest::newRow("unterminated string") << QByteArray("[\"abc") << "Unterminated string" << qsizetype(5);
+        QTest::newRow("two documents") << QByteArray("{} {}") << "Unexpected data after document" << qsizetype(3);
+        QTest::newRow("empty") << QByteArray("   ") << "Unexpected end of input" << qsizetype(3);
+    }
+
+    void testInvalidInput()
+    {
+        QFETCH(QByteArray, input);
+        QFETCH(QString, message);
+        QFETCH(qsizetype, offset);
+
+        const JsonIndexer::Result result = JsonIndexer::validate(input);
+        QVERIFY(!result.valid);
+        QCOMPARE(result.error, message);
+        QCOMPARE(result.errorOffset, offset);
+    }
+
+    void testErrorPosition()
+    {
+        // Column counts code points, so the two-byte character is one
+        JsonIndexer::Result result = JsonIndexer::validate("{\n  \"a\": 1,\n  \"\xc3\xa9\": x\n}");
+        QCOMPARE(result.error, QString("Unexpected character"));
+        QCOMPARE(result.errorLine, 3);
+        QCOMPARE(result.errorColumn, 8);
+
+        // Lines counted across blocks
+        QByteArray input = "[\n";
+        for (int i = 0; i < 100; ++i)
+            input += "1,\n";
+        input += "x]";
+        result = JsonIndexer::validate(input);
+        QCOMPARE(result.errorOffset, qsizetype(302));
+        QCOMPARE(result.errorLine, 102);
+        QCOMPARE(result.errorColumn, 1);
+    }
+
+    void testScalarRoot()
+    {
+        JsonIndexer::Result result = JsonIndexer::validate("42");
+        QVERIFY(result.valid);
+        QCOMPARE(result.stats.numbers, 1);
+        QCOMPARE(result.stats.maxDepth, 1);
+
+        result = JsonIndexer::validate("42", true);
+        QVERIFY(!result.valid);
+        QCOMPARE(result.error, QString("Expected object or array"));
+    }
+
+    void testMaxDepth()
+    {
+        const int depth = JsonIndexer::MaxDepth;
+        QVERIFY(JsonIndexer::validate(QByteArray(depth, '[') + QByteArray(depth, ']')).valid);
+
+        const JsonIndexer::Result result =
+            JsonIndexer::validate(QByteArray(depth + 1, '[') + QByteArray(depth + 1, ']'));
+        QCOMPARE(result.error, QString("Nesting too deep"));
+        QCOMPARE(result.errorOffset, qsizetype(depth));
+    }
+
+    // Each edit re-validates from the previous input, valid or not
+    void testIncrementalMatchesFullScan()
+    {
+        QByteArray input = records(2000);
+        const qsizetype middle = input.indexOf("{\"id\": 1000,");
+        const QList<std::function<void()>> edits = {
+            [&]() { input.replace(middle + 7, 4, "123456"); },
+            [&]() { input.insert(middle, "{\"new\": [1, {\"deep\": [[[[]]]]}]},\n"); },
+            [&]() { input.insert(middle, '"'); },
+            [&]() { input.remove(middle, 1); },
+            [&]() { input.insert(middle, "\\"); },
+            [&]() { input.remove(middle, 1); },
+            [&]() { input.insert(1, " "); },
+            [&]() { input.insert(input.lastIndexOf(']'), ", 7"); },
+            [&]() { input.remove(middle, 3 * JsonIncrementalIndexer::CheckpointInterval); },
+            [&]() { input = records(2000); },
+        };
+
+        JsonIncrementalIndexer indexer;
+        QVERIFY(sameResult(indexer.validate(input), JsonIndexer::validate(input)));
+        for (qsizetype i = 0; i < edits.size(); ++i) {
+            edits[i]();
+            QVERIFY2(sameResult(indexer.validate(input), JsonIndexer::validate(input)),
+                     qPrintable(QString("edit %1").arg(i)));
+        }
+    }
+
+    void testIncrementalScansEditOnly()
+    {
+        QByteArray input = records(2000);
+        JsonIncrementalIndexer indexer(true);
+        QVERIFY(indexer.validate(input).valid);
+        QCOMPARE(indexer.scannedBytes(), input.size());
+
+        // Unchanged input is not scanned again
+        QVERIFY(indexer.validate(input).valid);
+        QCOMPARE(indexer.scannedBytes(), qsizetype(0));
+
+        // A one-byte edit rescans about one checkpoint interval
+        input[input.indexOf("null") + 1] = 'x';
+        const JsonIndexer::Result broken = indexer.validate(input);
+        QCOMPARE(broken.error, QString("Invalid literal"));
+        QVERIFY(indexer.scannedBytes() <= 2 * JsonIncrementalIndexer::CheckpointInterval);
+
+        input[input.indexOf("nxll") + 1] = 'u';
+        const qsizetype middle = input.size() / 2;
+        input.insert(input.indexOf("true", middle), "false, ");
+        const JsonIndexer::Result fixed = indexer.validate(input);
+        QVERIFY(sameResult(fixed, JsonIndexer::validate(input, true)));
+        QVERIFY(indexer.scannedBytes() <= 2 * JsonIncrementalIndexer::CheckpointInterval);
+    }
+
+    // An error past the edit moves with it
+    void testIncrementalErrorAfterEdit()
+    {
+        QByteArray input = records(2000);
+        input.insert(input.lastIndexOf(']'), "x");
+        JsonIncrementalIndexer indexer;
+        const JsonIndexer::Result before = indexer.validate(input);
+        QCOMPARE(before.error, QString("Expected ',' or ']'"));
+
+        input.insert(input.indexOf('{'), "\n\n");
+        const JsonIndexer::Result after = indexer.validate(input);
+        QCOMPARE(after.error, before.error);
+        QCOMPARE(after.errorOffset, before.errorOffset + 2);
+        QCOMPARE(after.errorLine, before.errorLine + 2);
+        QCOMPARE(after.errorColumn, before.errorColumn);
+        QVERIFY(sameResult(after, JsonIndexer::validate(input)));
+        QVERIFY(indexer.scannedBytes() <= 2 * JsonIncrementalIndexer::CheckpointInterval);
+    }
+};
+
+QTEST_MAIN(tst_JsonIndexer)
+#include "tst_jsonindexer.moc"
@@ -0,0 +1,146 @@
+/**
+ * @file tst_jsonlinemodel.cpp
+ * @brief Unit tests for JsonLineModel
+ *
+ * Tests verify:
+ * - Output text is indexed by line without highlighting it up front
+ * - Each row highlights only its own line as StyledText
+ * - Long lines are split into segments that resume lexer state
+ * - Keys split from their ':' by a segment boundary keep the key colour
+ * - Row ranges copy back as source text
+ * - Line indexes built off the GUI thread are swapped in whole
+ */
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include "../jsonlinemodel.h"
+
+class tst_JsonLineModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // One row per line, CRLF endings stripped
+    void testIndexesLines()
+    {
+        JsonLineModel model;
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+        model.setText(QStringLiteral("{\r\n  \"a\": 1\r\n}"));
+
+        QCOMPARE(resetSpy.count(), 1);
+        QCOMPARE(model.rowCount(), 3);
+        QCOMPARE(model.lineCount(), 3);
+        QCOMPARE(model.data(model.index(1), JsonLineModel::LineTextRole).toString(), QString("  \"a\": 1"));
+        QCOMPARE(model.data(model.index(2), JsonLineModel::LineNumberRole).toInt(), 3);
+    }
+
+    // Rows are highlighted independently with StyledText markup
+    void testHighlightsSingleLine()
+    {
+        JsonLineModel model;
+        model.setText(QStringLiteral("{\n  \"k\": \"v<\",\n  \"n\": null\n}"));
+
+        const QString line = model.data(model.index(1), JsonLineModel::HighlightedTextRole).toString();
+        QVERIFY(line.startsWith("&nbsp;&nbsp;<font color=\"#8fa1b3\">\"k\"</font>"));
+        QVERIFY(line.contains("<font color=\"#a3be8c\">\"v&lt;\"</font>"));
+        QVERIFY(!line.contains("null"));
+    }
+
+    // Minified output is split into segments; a string crossing a segment
+    // boundary is still coloured as a string
+    void testLongLineSegments()
+    {
+        const QString longString(JsonLineModel::MaxSegmentLength, QChar('x'));
+        JsonLineModel model;
+        model.setText("[\"" + longString + "\", 1]");
+
+        QCOMPARE(model.lineCount(), 1);
+        QCOMPARE(model.rowCount(), 2);
+        QVERIFY(!model.data(model.index(0), JsonLineModel::IsContinuationRole).toBool());
+        QVERIFY(model.data(model.index(1), JsonLineModel::IsContinuationRole).toBool());
+        QCOMPARE(model.data(model.index(1), JsonLineModel::LineNumberRole).toInt(), 1);
+
+        const QString tail = model.data(model.index(1), JsonLineModel::HighlightedTextRole).toString();
+        QVERIFY(tail.startsWith("<font color=\"#a3be8c\">xx\"</font>"));
+        QVERIFY(tail.contains("<font color=\"#d08770\">1</font>"));
+    }
+
+    // A key straddling a segment boundary is coloured as a key on both sides
+    void testKeyStraddlesSegmentBoundary()
+    {
+        const QString longKey(JsonLineModel::MaxSegmentLength, QChar('k'));
+        JsonLineModel model;
+        model.setText("{\"" + longKey + "\": 1}");
+
+        QCOMPARE(model.rowCount(), 2);
+        const QString head = model.data(model.index(0), JsonLineModel::HighlightedTextRole).toString();
+        QVERIFY(head.contains("<font color=\"#8fa1b3\">\"kk"));
+        QVERIFY(!head.contains("#a3be8c"));
+
+        const QString tail = model.data(model.index(1), JsonLineModel::HighlightedTextRole).toString();
+        QVERIFY(tail.startsWith("<font color=\"#8fa1b3\">kk\"</font>"));
+        QVERIFY(tail.contains("<font color=\"#d08770\">1</font>"));
+    }
+
+    // A key closing right at a segment end finds its ':' in the next segment
+    void testKeyClosesAtSegmentBoundary()
+    {
+        const QString key(JsonLineModel::MaxSegmentLength - 3, QChar('k'));
+        JsonLineModel model;
+        model.setText("{\"" + key + "\" : \"v\"}");
+
+        QCOMPARE(model.rowCount(), 2);
+        const QString head = model.data(model.index(0), JsonLineModel::HighlightedTextRole).toString();
+        QVERIFY(head.contains("<font color=\"#8fa1b3\">\"kk"));
+        QVERIFY(head.endsWith("k\"</font>"));
+
+        const QString tail = model.data(model.index(1), JsonLineModel::HighlightedTextRole).toString();
+        QVERIFY(tail.contains("<font color=\"#a3be8c\">\"v\"</font>"));
+    }
+
+    // Selected rows copy back with their line breaks, in either order
+    void testTextForRows()
+    {
+        JsonLineModel model;
+        model.setText(QStringLiteral("{\n  \"a\": 1,\n  \"b\": 2\n}"));
+
+        QCOMPARE(model.textForRows(1, 2), QString("  \"a\": 1,\n  \"b\": 2"));
+        QCOMPARE(model.textForRows(2, 1), QString("  \"a\": 1,\n  \"b\": 2"));
+        QCOMPARE(model.textForRows(0, 99), model.text());
+        QVERIFY(model.textForRows(5, 6).isEmpty());
+    }
+
+    // An index built on another thread is swapped in with one reset
+    void testSetIndexedText()
+    {
+        const QString text = QStringLiteral("{\n  \"a\": [1, 2]\n}");
+        JsonLineModel::Index index;
+        QScopedPointer<QThread> indexer(QThread::create([&index, text]() {
+            index = JsonLineModel::indexText(text);
+        }));
+        indexer->start();
+        QVERIFY(indexer->wait(5000));
+
+        JsonLineModel model;
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+        model.setIndexedText(text, std::move(index));
+
+        QCOMPARE(resetSpy.count(), 1);
+        QCOMPARE(model.lineCount(), 3);
+        QCOMPARE(model.text(), text);
+        QCOMPARE(model.data(model.index(1), JsonLineModel::LineTextRole).toString(), QString("  \"a\": [1, 2]"));
+    }
+
+    // Clearing leaves no rows
+    void testClear()
+    {
+        JsonLineModel model;
+        model.setText(QStringLiteral("[1]"));
+        model.clear();
+        QCOMPARE(model.rowCount(), 0);
+        QCOMPARE(model.lineCount(), 0);
+    }
+};
+
+QTEST_MAIN(tst_JsonLineModel)
+#include "tst_jsonlinemodel.moc"
@@ -0,0 +1,106 @@
+/**
+ * @file tst_jsonparallelformatter.cpp
+ * @brief Unit tests for JsonParallelFormatter
+ *
+ * Tests verify:
+ * - Output matches JsonWriter for the whole document, for any slice count
+ * - Slice boundaries fall on separators and respect the minimum slice size
+ * - Objects, single elements and invalid input are left to the caller
+ */
+#include <QtTest/QtTest>
+#include <QJsonDocument>
+#include "../jsonindexer.h"
+#include "../jsonparallelformatter.h"
+
+class tst_JsonParallelFormatter : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Records with nesting, escapes and numbers, large enough for several
+    // slices
+    static const QByteArray& records()
+    {
+        static const QByteArray json = []() {
+            QByteArray input = " [\n";
+            int i = 0;
+            while (input.size() < 4 * JsonParallelFormatter::MinSliceSize) {
+                input += "{\"id\": " + QByteArray::number(i) + ", \"name\": \"it\\\"em \xc3\xa9\\u0001\","
+                         " \"tags\": [\"a\", {}], \"score\": " + QByteArray::number(i * 0.5) + ", \"ok\": null},\n";
+                ++i;
+            }
+            input += "[]\n] ";
+            return input;
+        }();
+        return json;
+    }
+
+private slots:
+    void testMatchesJsonWriter_data()
+    {
+        QTest::addColumn<QString>("indentType");
+        QTest::addColumn<bool>("minified");
+
+        QTest::newRow("spaces:2") << "spaces:2" << false;
+        QTest::newRow("tabs") << "tabs" << false;
+        QTest::newRow("minified") << QString() << true;
+    }
+
+    void testMatchesJsonWriter()
+    {
+        QFETCH(QString, indentType);
+        QFETCH(bool, minified);
+
+        const JsonWriter::Indent indent =
+            minified ? JsonWriter::Indent::minified() : JsonWriter::Indent::fromString(indentType);
+        const QByteArray expected = JsonWriter::toJson(QJsonDocument::fromJson(records()), indent);
+        QVERIFY(!expected.isEmpty());
+
+        for (int slices : {1, 2, 3, 7})
+            QCOMPARE(JsonParallelFormatter::format(records(), indent, slices), expected);
+    }
+
+    void testSliceBoundaries()
+    {
+        QList<qsizetype> separators;
+        QVERIFY(JsonIndexer::validate(records(), true, &separators).valid);
+
+        const QList<qsizetype> boundaries = JsonParallelFormatter::sliceBoundaries(records(), separators, 16);
+        QCOMPARE(records().at(boundaries.first()), '[');
+        QCOMPARE(records().at(boundaries.last()), ']');
+
+        // Never more slices than the minimum size allows
+        QVERIFY(boundaries.size() >= 3);
+        QVERIFY(boundaries.size() - 1 <= records().size() / JsonParallelFormatter::MinSliceSize);
+        for (qsizetype i = 1; i + 1 < boundaries.size(); ++i) {
+            QVERIFY(separators.contains(boundaries[i]));
+            QVERIFY(boundaries[i] > boundaries[i - 1]);
+        }
+
+        // Small input stays in one slice
+        const QByteArray small = "[1, 2, 3]";
+        QVERIFY(JsonIndexer::validate(small, true, &separators).valid);
+        QCOMPARE(separators, QList<qsizetype>({2, 5}));
+        QCOMPARE(JsonParallelFormatter::sliceBoundaries(small, separators, 4), QList<qsizetype>({0, 8}));
+    }
+
+    void testNotSplit_data()
+    {
+        QTest::addColumn<QByteArray>("input");
+
+        QTest::newRow("object") << QByteArray("{\"b\": 1, \"a\": 2}");
+        QTest::newRow("single element") << QByteArray("[{\"a\": [1, 2]}]");
+        QTest::newRow("empty") << QByteArray("[]");
+        QTest::newRow("invalid") << QByteArray("[1, 2,]");
+        QTest::newRow("scalar") << QByteArray("42");
+    }
+
+    void testNotSplit()
+    {
+        QFETCH(QByteArray, input);
+        QVERIFY(JsonParallelFormatter::format(input, JsonWriter::Indent()).isNull());
+    }
+};
+
+QTEST_MAIN(tst_JsonParallelFormatter)
+#include "tst_jsonparallelformatter.moc"
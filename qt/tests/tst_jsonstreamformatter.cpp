@@ -0,0 +1,167 @@
+/**
+ * @file tst_jsonstreamformatter.cpp
+ * @brief Unit tests for JsonStreamFormatter
+ *
+ * Tests verify:
+ * - Streamed output matches JsonWriter for the same document
+ * - Output does not depend on where the input is split into chunks
+ * - Invalid input is rejected with the byte offset of the error
+ * - formatFile() only replaces the output file on success
+ */
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include "../jsonstreamformatter.h"
+
+class tst_JsonStreamFormatter : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QByteArray format(const QByteArray& input, const JsonWriter::Indent& indent,
+                             qsizetype chunkSize = JsonStreamFormatter::ChunkSize, QString* error = nullptr)
+    {
+        QBuffer output;
+        output.open(QIODevice::WriteOnly);
+        JsonStreamFormatter formatter(&output, indent);
+
+        bool ok = true;
+        for (qsizetype i = 0; ok && i < input.size(); i += chunkSize)
+            ok = formatter.feed(QByteArrayView(input).mid(i, chunkSize));
+        ok = ok && formatter.finish();
+
+        if (error)
+            *error = formatter.errorString();
+        return ok ? output.data() : QByteArray();
+    }
+
+    static const QByteArray& sample()
+    {
+        static const QByteArray json =
+            "  {\"name\" : \"airgap\", \"tags\":[ \"a\",\"b\" ],\n"
+            "\t\"nested\": {\"empty\": {}, \"list\": [], \"n\": -12.5e3},\r\n"
+            "   \"flags\": [true, false, null, 0] }  ";
+        return json;
+    }
+
+private slots:
+    void testMatchesJsonWriter()
+    {
+        const QJsonDocument doc = QJsonDocument::fromJson(sample());
+        QVERIFY(!doc.isNull());
+
+        const JsonWriter::Indent indent = JsonWriter::Indent::fromString("spaces:2");
+        const QByteArray streamed = format(sample(), indent);
+        QCOMPARE(QJsonDocument::fromJson(streamed), doc);
+        QVERIFY(streamed.startsWith("{\n  \"name\": \"airgap\",\n  \"tags\": [\n    \"a\",\n"));
+        QVERIFY(streamed.contains("\"empty\": {},\n    \"list\": [],"));
+        QVERIFY(streamed.endsWith("\n  ]\n}"));
+
+        QCOMPARE(format(sample(), JsonWriter::Indent::minified()),
+                 QByteArray("{\"name\":\"airgap\",\"tags\":[\"a\",\"b\"],\"nested\":{\"empty\":{},"
+                            "\"list\":[],\"n\":-12.5e3},\"flags\":[true,false,null,0]}"));
+    }
+
+    // Tokens, escapes and numbers split across chunks
+    void testChunkBoundaries()
+    {
+        const QByteArray input = "{\"s\": \"x\\u00e9\\\"y\", \"n\": 123456, \"t\": true}";
+        const JsonWriter::Indent indent = JsonWriter::Indent::fromString("tabs");
+        const QByteArray whole = format(input, indent);
+        QVERIFY(!whole.isEmpty());
+
+        for (qsizetype chunk = 1; chunk <= 7; ++chunk)
+            QCOMPARE(format(input, indent, chunk), whole);
+    }
+
+    void testInvalidInput_data()
+    {
+        QTest::addColumn<QByteArray>("input");
+        QTest::addColumn<QString>("message");
+
+        QTest::newRow("unterminated") << QByteArray("{\"a\": [1, 2") << "Unexpected end of input at byte 11";
+        QTest::newRow("mismatched") << QByteArray("[1}") << "Expected ',' or ']' at byte 2";
+        QTest::newRow("trailing comma") << QByteArray("{\"a\": 1,}") << "Expected string key at byte 8";
+        QTest::newRow("leading zero") << QByteArray("[01]") << "Expected ',' or ']' at byte 2";
+        QTest::newRow("bad literal") << QByteArray("[nul]") << "Invalid literal at byte 4";
+        QTest::newRow("bad escape") << QByteArray("\"\\x\"") << "Invalid escape sequence at byte 2";
+        QTest::newRow("two documents") << QByteArray("{} {}") << "Unexpected data after document at byte 3";
+        QTest::newRow("empty") << QByteArray("   ") << "Unexpected end of input at byte 3";
+    }
+
+    void testInvalidInput()
+    {
+        QFETCH(QByteArray, input);
+        QFETCH(QString, message);
+
+        QString error;
+        QVERIFY(format(input, JsonWriter::Indent(), JsonStreamFormatter::ChunkSize, &error).isEmpty());
+        QCOMPARE(error, message);
+    }
+
+    void testFormatFile()
+    {
+        QTemporaryDir dir;
+        const QString inputPath = dir.filePath("input.json");
+        const QString outputPath = dir.filePath("output.json");
+
+        // Larger than one read so progress is reported more than once
+        QByteArray input = "[";
+        while (input.size() < JsonStreamFormatter::ChunkSize * 2)
+            input += "{\"id\": 1, \"value\": \"item\"},";
+        input += "null]";
+        {
+            QFile file(inputPath);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(input);
+        }
+
+        QList<int> progress;
+        const JsonStreamFormatter::FileResult result = JsonStreamFormatter::formatFile(
+            inputPath, outputPath, JsonWriter::Indent::fromString("spaces:4"), [&progress](int percent) {
+                progress.append(percent);
+                return true;
+            });
+
+        QVERIFY2(result.success, qPrintable(result.error));
+        QCOMPARE(result.bytesRead, qint64(input.size()));
+        QVERIFY(progress.size() >= 2);
+        QCOMPARE(progress.last(), 100);
+
+        QFile output(outputPath);
+        QVERIFY(output.open(QIODevice::ReadOnly));
+        QCOMPARE(output.size(), result.bytesWritten);
+        QCOMPARE(QJsonDocument::fromJson(output.readAll()), QJsonDocument::fromJson(input));
+    }
+
+    // Failed or canceled jobs leave an existing output untouched
+    void testFormatFileKeepsOutputOnFailure()
+    {
+        QTemporaryDir dir;
+        const QString inputPath = dir.filePath("input.json");
+        const QString outputPath = dir.filePath("output.json");
+        for (const auto& [path, content] : {std::pair{inputPath, QByteArray("{\"a\": ")},
+                                            std::pair{outputPath, QByteArray("previous")}}) {
+            QFile file(path);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(content);
+        }
+
+        JsonStreamFormatter::FileResult result =
+            JsonStreamFormatter::formatFile(inputPath, outputPath, JsonWriter::Indent());
+        QVERIFY(!result.success);
+        QVERIFY(!result.error.isEmpty());
+
+        result = JsonStreamFormatter::formatFile(inputPath, outputPath, JsonWriter::Indent(),
+                                                 [](int) { return false; });
+        QVERIFY(result.canceled);
+
+        QFile output(outputPath);
+        QVERIFY(output.open(QIODevice::ReadOnly));
+        QCOMPARE(output.readAll(), QByteArray("previous"));
+    }
+};
+
+QTEST_MAIN(tst_JsonStreamFormatter)
+#include "tst_jsonstreamformatter.moc"
@@ -0,0 +1,93 @@
+/**
+ * @file tst_jsonwriter.cpp
+ * @brief Unit tests for JsonWriter
+ *
+ * Tests verify:
+ * - The configured indent (spaces, width, tabs) is written per level
+ * - Minified output has no whitespace
+ * - Strings are escaped in one pass, including long and non-ASCII input
+ * - Output parses back to the same document
+ */
+#include <QtTest/QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "../jsonwriter.h"
+
+class tst_JsonWriter : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QByteArray write(const char* json, const QString& indentType)
+    {
+        return JsonWriter::toJson(QJsonDocument::fromJson(json), JsonWriter::Indent::fromString(indentType));
+    }
+
+private slots:
+    void testIndentStyles()
+    {
+        const char* input = "{\"a\": [1, {}], \"b\": []}";
+
+        QCOMPARE(write(input, "spaces:2"),
+                 QByteArray("{\n  \"a\": [\n    1,\n    {}\n  ],\n  \"b\": []\n}"));
+        QCOMPARE(write(input, "spaces:4"),
+                 QByteArray("{\n    \"a\": [\n        1,\n        {}\n    ],\n    \"b\": []\n}"));
+        QCOMPARE(write(input, "tabs"),
+                 QByteArray("{\n\t\"a\": [\n\t\t1,\n\t\t{}\n\t],\n\t\"b\": []\n}"));
+    }
+
+    void testMinified()
+    {
+        const QJsonDocument doc = QJsonDocument::fromJson("{ \"k\" : [ true , null , 1.5 ] }");
+        QCOMPARE(JsonWriter::toJson(doc, JsonWriter::Indent::minified()),
+                 QByteArray("{\"k\":[true,null,1.5]}"));
+    }
+
+    void testStringEscaping()
+    {
+        JsonWriter writer;
+        writer.writeString(QStringLiteral("q\"b\\n\nt\tc\x01 d\x7f é € \U0001F600"));
+        QCOMPARE(writer.buffer(),
+                 QByteArray("\"q\\\"b\\\\n\\nt\\tc\\u0001 d\\u007f \xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\""));
+    }
+
+    // Strings longer than one escape chunk, with a surrogate pair across
+    // the chunk boundary
+    void testLongString()
+    {
+        QString text(4095, QLatin1Char('x'));
+        text += QStringLiteral("\U0001F600");
+        text += QString(5000, QLatin1Char('"'));
+
+        JsonWriter writer;
+        writer.writeString(text);
+        const QByteArray expected = '"' + QByteArray(4095, 'x') + QByteArray("\xf0\x9f\x98\x80")
+                                    + QByteArray("\\\"").repeated(5000) + '"';
+        QCOMPARE(writer.buffer(), expected);
+    }
+
+    void testNumbers()
+    {
+        JsonWriter writer(JsonWriter::Indent::minified());
+        writer.writeValue(QJsonArray{42, -7, 0.1, 1e300, 9007199254740993.0});
+        QCOMPARE(writer.buffer(), QByteArray("[42,-7,0.1,1e+300,9007199254740992]"));
+    }
+
+    void testRoundTrip()
+    {
+        const QByteArray input = "{\"name\": \"caf\xc3\xa9\", \"list\": [1, 2.5, true, null, "
+                                 "{\"nested\": \"line\\nbreak\"}], \"empty\": {}}";
+        const QJsonDocument doc = QJsonDocument::fromJson(input);
+        QVERIFY(!doc.isNull());
+
+        for (const QString& indent : {QStringLiteral("spaces:2"), QStringLiteral("spaces:4"), QStringLiteral("tabs")}) {
+            const QByteArray output = JsonWriter::toJson(doc, JsonWriter::Indent::fromString(indent));
+            QCOMPARE(QJsonDocument::fromJson(output), doc);
+        }
+        QCOMPARE(QJsonDocument::fromJson(JsonWriter::toJson(doc, JsonWriter::Indent::minified())), doc);
+    }
+};
+
+QTEST_MAIN(tst_JsonWriter)
+#include "tst_jsonwriter.moc"
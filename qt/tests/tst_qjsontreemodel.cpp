@@ -0,0 +1,507 @@
+/**
+ * @file tst_qjsontreemodel.cpp
+ * @brief Unit tests for QJsonTreeModel
+ *
+ * Tests verify:
+ * - Lazy materialization: children are only created on first access
+ * - Logical row counts are reported before children exist
+ * - Serialization and node counting do not materialize subtrees
+ * - Flat node store gives index-based row/parent lookups
+ * - Background loading swaps in the finished store and can be cancelled
+ * - The store walk reports progress and stops mid-document when cancelled
+ * - Stores built off the GUI thread are swapped in with one reset
+ * - Background loads can take their document from a cache instead of parsing
+ * - Search finds keys, values and paths in document order, page by page
+ * - Values are decoded on request; long strings are truncated for display only
+ * - Truncation never splits a surrogate pair
+ */
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "../qjsontreemodel.h"
+
+class tst_QJsonTreeModel : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QString nestedDocument()
+    {
+        return QStringLiteral(R"({"users": [{"name": "a", "tags": [1, 2, 3]}, {"name": "b"}], "count": 2})");
+    }
+
+    static QStringList paths(const QJsonTreeModel& model, const QModelIndexList& indexes)
+    {
+        QStringList result;
+        for (const QModelIndex& index : indexes)
+            result.append(model.getJsonPath(index));
+        return result;
+    }
+
+private slots:
+    // Root level holds the single JSON root item
+    void testLoadReportsRootRow()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(nestedDocument()));
+        QCOMPARE(model.rowCount(), 1);
+
+        QModelIndex root = model.index(0, 0);
+        QVERIFY(root.isValid());
+        QCOMPARE(model.data(root, QJsonTreeModel::ValueTypeRole).toString(), QString("object"));
+        QCOMPARE(model.rowCount(root), 2);
+    }
+
+    // Containers report their size before any child item exists
+    void testChildrenMaterializedOnDemand()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(nestedDocument()));
+
+        QModelIndex root = model.index(0, 0);
+        QVERIFY(model.canFetchMore(root));
+        QCOMPARE(model.rowCount(root), 2);
+        QVERIFY(model.canFetchMore(root));
+
+        QModelIndex users = model.index(1, 0, root);
+        QVERIFY(!model.canFetchMore(root));
+        QCOMPARE(model.data(users, QJsonTreeModel::KeyRole).toString(), QString("users"));
+        QCOMPARE(model.data(users, QJsonTreeModel::ChildCountRole).toInt(), 2);
+        QVERIFY(model.data(users, QJsonTreeModel::IsExpandableRole).toBool());
+
+        // Sibling subtree stays untouched
+        QVERIFY(model.canFetchMore(users));
+    }
+
+    // fetchMore() materializes without changing the reported row count
+    void testFetchMoreKeepsRowCount()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(nestedDocument()));
+
+        QModelIndex root = model.index(0, 0);
+        QSignalSpy insertSpy(&model, &QAbstractItemModel::rowsInserted);
+
+        model.fetchMore(root);
+        QVERIFY(!model.canFetchMore(root));
+        QCOMPARE(model.rowCount(root), 2);
+        QCOMPARE(insertSpy.count(), 0);
+    }
+
+    // Empty containers have nothing to fetch
+    void testEmptyContainersAreNotFetchable()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(QStringLiteral(R"({"obj": {}, "arr": []})")));
+
+        QModelIndex root = model.index(0, 0);
+        QModelIndex arr = model.index(0, 0, root);
+        QCOMPARE(model.rowCount(arr), 0);
+        QVERIFY(!model.canFetchMore(arr));
+        QVERIFY(!model.data(arr, QJsonTreeModel::IsExpandableRole).toBool());
+    }
+
+    // Node count covers the whole document without materializing it
+    void testTotalNodeCountIsLazy()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(nestedDocument()));
+
+        // virtual root + object + users + 2 user objects + 2 names + tags
+        // + 3 tag numbers + count
+        QCOMPARE(model.totalNodeCount(), 12);
+        QVERIFY(model.canFetchMore(model.index(0, 0)));
+    }
+
+    // Descendant counts come from the load-time index
+    void testDescendantCountRole()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(nestedDocument()));
+
+        QModelIndex root = model.index(0, 0);
+        QModelIndex users = model.index(1, 0, root);
+        QModelIndex first = model.index(0, 0, users);
+        QModelIndex second = model.index(1, 0, users);
+        QModelIndex count = model.index(0, 0, root);
+
+        QCOMPARE(model.data(root, QJsonTreeModel::DescendantCountRole).toInt(), 10);
+        QCOMPARE(model.data(users, QJsonTreeModel::DescendantCountRole).toInt(), 8);
+        QCOMPARE(model.data(first, QJsonTreeModel::DescendantCountRole).toInt(), 5);
+        QCOMPARE(model.data(second, QJsonTreeModel::DescendantCountRole).toInt(), 1);
+        QCOMPARE(model.data(count, QJsonTreeModel::DescendantCountRole).toInt(), 0);
+    }
+
+    // Depth statistics drive the auto-expand level
+    void testExpandDepthForBudget()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(nestedDocument()));
+
+        // Depths: root(1), users+count(2), 2 user objects(2), names+tags(3), tag numbers(3)
+        QCOMPARE(model.maxDepth(), 4);
+        QCOMPARE(model.expandDepthForBudget(100), 4);
+        QCOMPARE(model.expandDepthForBudget(5), 2);
+        QCOMPARE(model.expandDepthForBudget(3), 1);
+        QCOMPARE(model.expandDepthForBudget(2), 0);
+    }
+
+    // Deep paths resolve once their parents are materialized
+    void testJsonPathAfterLazyLoad()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(nestedDocument()));
+
+        QModelIndex root = model.index(0, 0);
+        QModelIndex users = model.index(1, 0, root);
+        QModelIndex first = model.index(0, 0, users);
+        QModelIndex tags = model.index(1, 0, first);
+        QModelIndex tag = model.index(2, 0, tags);
+
+        QCOMPARE(model.getJsonPath(tag), QString("$.users[0].tags[2]"));
+        QCOMPARE(model.parent(tag), tags);
+        QCOMPARE(model.data(tag, QJsonTreeModel::ValueRole).toInt(), 3);
+    }
+
+    // Scalars keep their types; display roles cut long strings, copying does not
+    void testValuesDecodedOnRequest()
+    {
+        const QString longText(QJsonTreeModel::MaxDisplayLength + 500, 'a');
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(QStringLiteral(R"({"big": 1.5, "count": 3, "long": "%1", "ok": true})").arg(longText)));
+
+        const QModelIndex root = model.index(0, 0);
+        QCOMPARE(model.data(model.index(0, 0, root), QJsonTreeModel::ValueRole), QVariant(1.5));
+        QCOMPARE(model.data(model.index(1, 0, root), QJsonTreeModel::ValueRole), QVariant(qint64(3)));
+        QCOMPARE(model.data(model.index(3, 0, root), QJsonTreeModel::ValueRole), QVariant(true));
+
+        const QModelIndex longIndex = model.index(2, 0, root);
+        const QString shown = model.data(longIndex, QJsonTreeModel::ValueRole).toString();
+        QCOMPARE(shown.size(), QJsonTreeModel::MaxDisplayLength + 1);
+        QVERIFY(shown.endsWith(QChar(0x2026)));
+        QCOMPARE(model.serializeNode(longIndex), '"' + longText + '"');
+    }
+
+    // A surrogate pair straddling the display cut is dropped whole
+    void testDisplayCutKeepsSurrogatePairs()
+    {
+        const QString emoji = QString::fromUcs4(U"\U0001F600");
+        const QString text = QString(QJsonTreeModel::MaxDisplayLength - 1, 'a') + emoji + "tail";
+        QJsonObject object;
+        object["s"] = text;
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact))));
+
+        const QModelIndex root = model.index(0, 0);
+        const QString shown = model.data(model.index(0, 0, root), QJsonTreeModel::ValueRole).toString();
+        QCOMPARE(shown, QString(QJsonTreeModel::MaxDisplayLength - 1, 'a') + QChar(0x2026));
+        QVERIFY(!shown.at(shown.size() - 2).isHighSurrogate());
+    }
+
+    // Path segments come from the parent links; cached paths never outlive a load
+    void testJsonPathSegments()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(QStringLiteral(R"({"a.b": [[0, {"": 1, "c d": 2}]]})")));
+
+        const QModelIndex root = model.index(0, 0);
+        const QModelIndex dotted = model.index(0, 0, root);
+        const QModelIndex inner = model.index(0, 0, dotted);
+        const QModelIndex object = model.index(1, 0, inner);
+        QCOMPARE(model.getJsonPath(root), QString("$"));
+        QCOMPARE(model.getJsonPath(dotted), QString(R"($["a.b"])"));
+        QCOMPARE(model.getJsonPath(object), QString(R"($["a.b"][0][1])"));
+        QCOMPARE(model.getJsonPath(model.index(0, 0, object)), QString(R"($["a.b"][0][1])"));
+        QCOMPARE(model.data(model.index(1, 0, object), QJsonTreeModel::JsonPathRole).toString(),
+                 QString(R"($["a.b"][0][1]["c d"])"));
+        QCOMPARE(model.getJsonPath(object), QString(R"($["a.b"][0][1])"));
+
+        // The same node ids under other keys
+        QVERIFY(model.loadJson(QStringLiteral(R"({"x": [[0, {"y": 1, "z": 2}]]})")));
+        const QModelIndex reloaded = model.index(1, 0, model.index(0, 0, model.index(0, 0, model.index(0, 0))));
+        QCOMPARE(model.data(model.index(1, 0, reloaded), QJsonTreeModel::JsonPathRole).toString(),
+                 QString("$.x[0][1].z"));
+    }
+
+    // Flat store: row/parent come from inline indices on wide arrays
+    void testParentAndRowForWideArray()
+    {
+        QStringList elements;
+        for (int i = 0; i < 100000; ++i) {
+            elements.append(QString("{\"id\": %1}").arg(i));
+        }
+
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson("[" + elements.join(",") + "]"));
+
+        QModelIndex root = model.index(0, 0);
+        QCOMPARE(model.rowCount(root), 100000);
+
+        for (int row : {0, 4242, 99999}) {
+            QModelIndex element = model.index(row, 0, root);
+            QCOMPARE(element.row(), row);
+            QCOMPARE(model.parent(element), root);
+            QCOMPARE(model.data(element, QJsonTreeModel::KeyRole).toString(), QString::number(row));
+
+            QModelIndex id = model.index(0, 0, element);
+            QCOMPARE(model.parent(id), element);
+            QCOMPARE(model.data(id, QJsonTreeModel::ValueRole).toInt(), row);
+        }
+    }
+
+    // Copying a collapsed subtree serializes it from the source value
+    void testSerializeUnfetchedSubtree()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(nestedDocument()));
+
+        QModelIndex root = model.index(0, 0);
+        QModelIndex users = model.index(1, 0, root);
+        QVERIFY(model.canFetchMore(users));
+
+        QString serialized = model.serializeNode(users);
+        QVERIFY(model.canFetchMore(users));
+        QVERIFY(serialized.startsWith("[\n"));
+        QVERIFY(serialized.contains("\"name\": \"a\""));
+        QVERIFY(serialized.contains("\"tags\": [\n"));
+    }
+
+    // Invalid JSON leaves an empty model and reports an error
+    void testInvalidJsonClearsModel()
+    {
+        QJsonTreeModel model;
+        QSignalSpy errorSpy(&model, &QJsonTreeModel::loadError);
+
+        QVERIFY(!model.loadJson(QStringLiteral("{broken")));
+        QCOMPARE(errorSpy.count(), 1);
+        QCOMPARE(model.rowCount(), 0);
+        QCOMPARE(model.totalNodeCount(), 0);
+    }
+
+    // Background build publishes the whole tree in a single reset
+    void testLoadJsonAsync()
+    {
+        QJsonTreeModel model;
+        QSignalSpy finishedSpy(&model, &QJsonTreeModel::loadFinished);
+        QSignalSpy progressSpy(&model, &QJsonTreeModel::loadProgress);
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+        model.loadJsonAsync(nestedDocument());
+        QCOMPARE(model.rowCount(), 0);
+
+        QVERIFY(finishedSpy.wait(5000));
+        QCOMPARE(finishedSpy.count(), 1);
+        QVERIFY(finishedSpy.at(0).at(0).toBool());
+        QCOMPARE(resetSpy.count(), 1);
+        QVERIFY(!progressSpy.isEmpty());
+        QCOMPARE(model.totalNodeCount(), 12);
+    }
+
+    // A newer load supersedes one still in flight
+    void testNewerLoadSupersedesStale()
+    {
+        QJsonTreeModel model;
+        QSignalSpy finishedSpy(&model, &QJsonTreeModel::loadFinished);
+
+        model.loadJsonAsync(nestedDocument());
+        model.loadJsonAsync(QStringLiteral("[1, 2, 3]"));
+
+        QVERIFY(finishedSpy.wait(5000));
+        QTest::qWait(50);
+        QCOMPARE(finishedSpy.count(), 1);
+        QCOMPARE(model.data(model.index(0, 0), QJsonTreeModel::ValueTypeRole).toString(),
+                 QString("array"));
+    }
+
+    // Cancelled builds never touch the model
+    void testCancelLoadKeepsCurrentTree()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(QStringLiteral("[1, 2, 3]")));
+        QSignalSpy finishedSpy(&model, &QJsonTreeModel::loadFinished);
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+        model.loadJsonAsync(nestedDocument());
+        model.cancelLoad();
+
+        QTest::qWait(100);
+        QCOMPARE(finishedSpy.count(), 0);
+        QCOMPARE(resetSpy.count(), 0);
+        QCOMPARE(model.rowCount(model.index(0, 0)), 3);
+    }
+
+    // Parse errors from the worker are reported on completion
+    void testLoadJsonAsyncInvalid()
+    {
+        QJsonTreeModel model;
+        QSignalSpy finishedSpy(&model, &QJsonTreeModel::loadFinished);
+        QSignalSpy errorSpy(&model, &QJsonTreeModel::loadError);
+
+        model.loadJsonAsync(QStringLiteral("{broken"));
+
+        QVERIFY(finishedSpy.wait(5000));
+        QVERIFY(!finishedSpy.at(0).at(0).toBool());
+        QCOMPARE(errorSpy.count(), 1);
+        QCOMPARE(model.rowCount(), 0);
+    }
+
+    // The store walk reports how far it got, and stops when told to
+    void testStoreLoadProgressAndCancel()
+    {
+        QJsonArray values;
+        for (int i = 0; i < 5 * QJsonTreeStore::ProgressInterval; ++i)
+            values.append(QJsonObject{{"n", i}});
+
+        QList<double> fractions;
+        QJsonTreeStore store;
+        QVERIFY(store.load(values, [&fractions](double fraction) {
+            fractions.append(fraction);
+            return true;
+        }));
+        QVERIFY(fractions.size() >= 5);
+        for (int i = 1; i < fractions.size(); ++i)
+            QVERIFY(fractions.at(i) >= fractions.at(i - 1));
+        QVERIFY(fractions.last() < 1.0);
+        QCOMPARE(store.subtreeNodeCount(store.node(QJsonTreeStore::RootId).firstChild), int(1 + 2 * values.size()));
+
+        int calls = 0;
+        QVERIFY(!store.load(values, [&calls](double) {
+            ++calls;
+            return false;
+        }));
+        QCOMPARE(calls, 1);
+        QVERIFY(store.isEmpty());
+    }
+
+    // A store built on another thread is swapped in whole, and supersedes
+    // a background load still in flight
+    void testApplyBuiltStore()
+    {
+        QJsonTreeModel model;
+        QSignalSpy finishedSpy(&model, &QJsonTreeModel::loadFinished);
+        model.loadJsonAsync(QStringLiteral("[1, 2, 3]"));
+
+        const QJsonDocument doc = QJsonDocument::fromJson(nestedDocument().toUtf8());
+        QJsonTreeModel::BuildResult built;
+        QScopedPointer<QThread> builder(QThread::create([&built, doc]() {
+            built = QJsonTreeModel::buildStore(doc);
+        }));
+        builder->start();
+        QVERIFY(builder->wait(5000));
+
+        QVERIFY(model.applyBuildResult(std::move(built)));
+        QCOMPARE(model.totalNodeCount(), 12);
+        QTest::qWait(100);
+        QCOMPARE(finishedSpy.count(), 0);
+        QCOMPARE(model.data(model.index(0, 0), QJsonTreeModel::ValueTypeRole).toString(),
+                 QString("object"));
+    }
+
+    // A document source answers in place of the parse, on the build thread
+    void testLoadJsonAsyncFromSource()
+    {
+        QJsonTreeModel model;
+        QSignalSpy finishedSpy(&model, &QJsonTreeModel::loadFinished);
+        const QJsonDocument cached = QJsonDocument::fromJson(nestedDocument().toUtf8());
+        QAtomicInt calls;
+        QByteArray seen;
+
+        model.loadJsonAsync(nestedDocument(), [&](const QByteArray &utf8, QJsonParseError *error) {
+            calls.ref();
+            seen = utf8;
+            error->error = QJsonParseError::NoError;
+            return cached;
+        });
+
+        QVERIFY(finishedSpy.wait(5000));
+        QVERIFY(finishedSpy.at(0).at(0).toBool());
+        QCOMPARE(calls.loadRelaxed(), 1);
+        QCOMPARE(seen, nestedDocument().toUtf8());
+        QCOMPARE(model.totalNodeCount(), 12);
+    }
+
+    // Keys and values match anywhere in the document, in document order
+    void testSearchKeysAndValues()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(nestedDocument()));
+
+        QCOMPARE(paths(model, model.search("name", QJsonTreeModel::SearchKeys)),
+                 QStringList({"$.users[0].name", "$.users[1].name"}));
+        QCOMPARE(paths(model, model.search("2", QJsonTreeModel::SearchValues)),
+                 QStringList({"$.count", "$.users[0].tags[1]"}));
+        // Object and array keys match "users" and "tags"; "s" is in neither value
+        QCOMPARE(model.searchCount("s"), 2);
+        QVERIFY(model.search("missing").isEmpty());
+
+        const QModelIndexList found = model.search("b");
+        QCOMPARE(found.size(), 1);
+        QCOMPARE(model.data(found.first(), QJsonTreeModel::ValueRole).toString(), QString("b"));
+    }
+
+    // Trigram lookups, short-query scans and long unindexed values agree
+    void testSearchMatchingModes()
+    {
+        const QString longValue = QString(300, 'x') + "Hello";
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(QStringLiteral(R"({"a": "Hello World", "b": "say hello", "c": "help", "d": "%1"})")
+                                   .arg(longValue)));
+
+        QCOMPARE(paths(model, model.search("HELLO", QJsonTreeModel::SearchValues)),
+                 QStringList({"$.a", "$.b", "$.d"}));
+        QCOMPARE(paths(model, model.search("Hello", QJsonTreeModel::SearchValues | QJsonTreeModel::CaseSensitive)),
+                 QStringList({"$.a", "$.d"}));
+        QCOMPARE(paths(model, model.search("HELP", QJsonTreeModel::SearchValues | QJsonTreeModel::WholeMatch)),
+                 QStringList({"$.c"}));
+        QCOMPARE(model.searchCount("he", QJsonTreeModel::SearchValues), 4);
+        QCOMPARE(model.searchCount("lo w", QJsonTreeModel::SearchValues), 1);
+        QCOMPARE(model.searchCount("xxxxh", QJsonTreeModel::SearchValues), 1);
+    }
+
+    // Results come a page at a time, fetching only the matches' ancestors
+    void testSearchContinuesAfter()
+    {
+        QStringList items;
+        for (int i = 0; i < 250; ++i)
+            items.append(QStringLiteral(R"({"id": %1, "nested": {"id": 0}})").arg(i));
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson('[' + items.join(',') + ']'));
+
+        const QModelIndexList first = model.search("id", QJsonTreeModel::SearchKeys, 100);
+        QCOMPARE(first.size(), 100);
+        QCOMPARE(model.getJsonPath(first.at(0)), QString("$[0].id"));
+        QCOMPARE(model.getJsonPath(first.at(1)), QString("$[0].nested.id"));
+
+        const QModelIndexList second = model.search("id", QJsonTreeModel::SearchKeys, 100, first.last());
+        QCOMPARE(second.size(), 100);
+        QCOMPARE(model.getJsonPath(second.first()), QString("$[50].id"));
+        QCOMPARE(model.searchCount("id", QJsonTreeModel::SearchKeys), 500);
+
+        // Item 50 holds a returned match; nothing under item 249 was fetched
+        const QModelIndex root = model.index(0, 0);
+        QVERIFY(!model.canFetchMore(model.index(50, 0, root)));
+        QVERIFY(model.canFetchMore(model.index(249, 0, root)));
+    }
+
+    // Paths in the form getJsonPath() returns resolve directly
+    void testSearchPath()
+    {
+        QJsonTreeModel model;
+        QVERIFY(model.loadJson(QStringLiteral(R"({"users": [{"name": "a"}, {"name": "b"}], "a b": {"c": 1}})")));
+
+        const QModelIndexList found = model.search("$.users[1].name", QJsonTreeModel::SearchPath);
+        QCOMPARE(found.size(), 1);
+        QCOMPARE(model.data(found.first(), QJsonTreeModel::ValueRole).toString(), QString("b"));
+        QCOMPARE(paths(model, model.search(R"($["a b"].c)", QJsonTreeModel::SearchPath)),
+                 QStringList({R"($["a b"].c)"}));
+        QCOMPARE(model.search("$", QJsonTreeModel::SearchPath).first(), model.index(0, 0));
+
+        QVERIFY(model.search("$.users[2]", QJsonTreeModel::SearchPath).isEmpty());
+        QVERIFY(model.search("$.users.name", QJsonTreeModel::SearchPath).isEmpty());
+        QVERIFY(model.search("users", QJsonTreeModel::SearchPath).isEmpty());
+    }
+};
+
+QTEST_MAIN(tst_QJsonTreeModel)
+#include "tst_qjsontreemodel.moc"
@@ -0,0 +1,138 @@
+/**
+ * @file tst_taskmetrics.cpp
+ * @brief Unit tests for LatencyHistogram and TaskMetrics
+ *
+ * Tests verify:
+ * - Histogram buckets are exact for small values and within 1 / SubBuckets above
+ * - Percentiles, min, max and mean of recorded values
+ * - Per-name snapshot counters and near-timeout runs
+ * - The trace keeps the most recent MaxTraceEvents tasks
+ */
+#include <QtTest/QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "../taskmetrics.h"
+
+class tst_TaskMetrics : public QObject
+{
+    Q_OBJECT
+
+private:
+    static TaskMetrics::Task makeTask(const QString& name, quint64 id, qint64 waitUs, qint64 runUs)
+    {
+        TaskMetrics::Task task;
+        task.id = id;
+        task.name = name;
+        task.track = 1;
+        task.enqueuedNs = qint64(id) * 1000 * 1000;
+        task.startedNs = task.enqueuedNs + waitUs * 1000;
+        task.finishedNs = task.startedNs + runUs * 1000;
+        return task;
+    }
+
+private slots:
+    void testBucketPrecision()
+    {
+        for (quint64 value = 0; value < quint64(2 * LatencyHistogram::SubBuckets); ++value)
+            QCOMPARE(LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketIndex(value)), value);
+
+        int previous = -1;
+        for (quint64 value = 1; value < 100000000; value = value * 5 / 4 + 1) {
+            const int index = LatencyHistogram::bucketIndex(value);
+            const quint64 upper = LatencyHistogram::bucketUpperBound(index);
+            QVERIFY(index >= previous);
+            QVERIFY(upper >= value);
+            QVERIFY(double(upper - value) / value <= 1.0 / LatencyHistogram::SubBuckets);
+            QVERIFY(index == 0 || LatencyHistogram::bucketUpperBound(index - 1) < value);
+            previous = index;
+        }
+    }
+
+    void testPercentiles()
+    {
+        LatencyHistogram histogram;
+        QCOMPARE(histogram.percentile(50), qint64(0));
+
+        for (int value = 1; value <= 1000; ++value)
+            histogram.record(value);
+
+        QCOMPARE(histogram.count(), qint64(1000));
+        QCOMPARE(histogram.min(), qint64(1));
+        QCOMPARE(histogram.max(), qint64(1000));
+        QCOMPARE(histogram.mean(), 500.5);
+        QCOMPARE(histogram.percentile(100), qint64(1000));
+        QCOMPARE(histogram.percentile(0), qint64(1));
+        for (const double percentile : {50.0, 90.0, 99.0}) {
+            const qint64 value = histogram.percentile(percentile);
+            QVERIFY(value >= qint64(percentile * 10));
+            QVERIFY(value <= qint64(percentile * 10 * (1 + 1.0 / LatencyHistogram::SubBuckets)));
+        }
+    }
+
+    void testSnapshot()
+    {
+        TaskMetrics metrics(1000);
+        metrics.recordFinished(makeTask("formatJson", 1, 2000, 10000), true, false);
+        TaskMetrics::Task slow = makeTask("formatJson", 2, 0, 600000);
+        slow.payloadBytes = 42;
+        metrics.recordFinished(slow, false, false);
+        metrics.recordFinished(makeTask("formatJson", 3, 0, 1000000), false, true);
+        metrics.recordRejected("saveToHistory");
+        metrics.recordSuperseded("validateJson");
+        metrics.recordQueueLength(7);
+        metrics.recordQueueLength(3);
+
+        const QVariantMap snapshot = metrics.snapshot();
+        QCOMPARE(snapshot["watchdogMs"].toInt(), 1000);
+        QCOMPARE(snapshot["peakQueueLength"].toInt(), 7);
+
+        const QVariantMap tasks = snapshot["tasks"].toMap();
+        const QVariantMap format = tasks["formatJson"].toMap();
+        QCOMPARE(format["count"].toLongLong(), 3);
+        QCOMPARE(format["succeeded"].toLongLong(), 1);
+        QCOMPARE(format["failed"].toLongLong(), 2);
+        QCOMPARE(format["timedOut"].toLongLong(), 1);
+        QCOMPARE(format["nearTimeout"].toLongLong(), 2);
+        QCOMPARE(format["payloadBytes"].toLongLong(), 42);
+        QCOMPARE(format["waitMs"].toMap()["max"].toDouble(), 2.0);
+        QCOMPARE(format["runMs"].toMap()["min"].toDouble(), 10.0);
+        QCOMPARE(format["runMs"].toMap()["max"].toDouble(), 1000.0);
+
+        QCOMPARE(tasks["saveToHistory"].toMap()["rejected"].toLongLong(), 1);
+        QCOMPARE(tasks["saveToHistory"].toMap()["count"].toLongLong(), 0);
+        QCOMPARE(tasks["validateJson"].toMap()["superseded"].toLongLong(), 1);
+
+        metrics.reset();
+        QVERIFY(metrics.snapshot()["tasks"].toMap().isEmpty());
+    }
+
+    void testTraceKeepsRecentEvents()
+    {
+        TaskMetrics metrics(1000);
+        const int extra = 10;
+        for (int i = 0; i < TaskMetrics::MaxTraceEvents + extra; ++i)
+            metrics.recordFinished(makeTask("validateJson", quint64(i + 1), 5, 5), true, false);
+
+        const QJsonArray events = QJsonDocument::fromJson(metrics.chromeTrace()).object()["traceEvents"].toArray();
+        int runs = 0;
+        double firstStart = -1;
+        double lastStart = 0;
+        for (const QJsonValue& value : events) {
+            const QJsonObject event = value.toObject();
+            if (event["ph"].toString() != "X")
+                continue;
+            if (firstStart < 0)
+                firstStart = event["ts"].toDouble();
+            QVERIFY(event["ts"].toDouble() > lastStart);
+            lastStart = event["ts"].toDouble();
+            ++runs;
+        }
+        QCOMPARE(runs, TaskMetrics::MaxTraceEvents);
+        // Oldest first, starting after the dropped events
+        QCOMPARE(firstStart, double((extra + 1) * 1000 + 5));
+    }
+};
+
+QTEST_MAIN(tst_TaskMetrics)
+#include "tst_taskmetrics.moc"
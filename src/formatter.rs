@@ -38,10 +38,17 @@ pub fn format_json(input: &str, indent: IndentStyle) -> Result<String, FormatErr
         )
     })?;
 
+    Ok(format_parsed(&value, indent, input.len() * 2))
+}
+
+/// Format an already parsed JSON value with the specified indentation style.
+///
+/// `capacity` is a hint for the output buffer size.
+pub fn format_parsed(value: &Value, indent: IndentStyle, capacity: usize) -> String {
     let indent_str = indent.as_str();
-    let mut output = String::with_capacity(input.len() * 2);
-    format_value(&value, &indent_str, 0, &mut output);
-    Ok(output)
+    let mut output = String::with_capacity(capacity);
+    format_value(value, &indent_str, 0, &mut output);
+    output
 }
 
 /// Recursively format a JSON value with proper indentation.
@@ -2,6 +2,7 @@ use wasm_bindgen::prelude::*;
 
 pub mod formatter;
 pub mod highlighter;
+pub mod processor;
 pub mod types;
 pub mod validator;
 pub mod xml_formatter;
@@ -13,6 +14,7 @@ mod tests;
 // Re-export public types for convenience (Rust API)
 pub use formatter::{format_json, minify_json};
 pub use highlighter::highlight_json;
+pub use processor::{process_json, ProcessResult};
 pub use types::{FormatError, IndentStyle, JsonStats, ValidationResult};
 pub use validator::validate_json;
 pub use xml_formatter::{format_xml, minify_xml};
@@ -99,8 +101,11 @@ pub fn js_minify_json(input: &str) -> Result<String, JsValue> {
 ///   ```
 #[wasm_bindgen(js_name = "validateJson")]
 pub fn js_validate_json(input: &str) -> String {
-    let result = validator::validate_json(input);
+    validation_json(&validator::validate_json(input))
+}
 
+/// Serialize a validation result in the `validateJson` JSON shape.
+fn validation_json(result: &ValidationResult) -> String {
     // Serialize to JavaScript-friendly JSON
     let error_json = match &result.error {
         Some(e) => format!(
@@ -141,6 +146,133 @@ pub fn js_highlight_json(input: &str) -> String {
     highlighter::highlight_json(input)
 }
 
+// ============================================================================
+// UTF-8 byte exports
+// ============================================================================
+//
+// Byte-slice variants of the JSON exports. Callers that already hold UTF-8
+// (the Qt bridge) pass a Uint8Array and receive one back, avoiding the
+// UTF-16 JS string conversions on both sides of the call.
+
+/// Borrow UTF-8 input bytes as `&str`, rejecting invalid encodings.
+fn utf8_input(input: &[u8]) -> Result<&str, JsValue> {
+    std::str::from_utf8(input).map_err(|e| JsValue::from_str(&utf8_error(input, e).to_string()))
+}
+
+/// Describe an invalid UTF-8 sequence as a parse error at its position.
+///
+/// The message names the byte offset; line and column count characters of
+/// the valid prefix, like the JSON parser's positions.
+fn utf8_error(input: &[u8], error: std::str::Utf8Error) -> FormatError {
+    let offset = error.valid_up_to();
+    // The prefix before the bad sequence is valid by definition
+    let prefix = std::str::from_utf8(&input[..offset]).unwrap_or_default();
+    let line = prefix.matches('\n').count() + 1;
+    let column = prefix.rsplit('\n').next().map_or(0, |last| last.chars().count()) + 1;
+    FormatError::new(format!("Invalid UTF-8 at byte offset {}", offset), line, column)
+}
+
+/// Format UTF-8 JSON bytes with specified indentation.
+///
+/// # Returns
+/// * Formatted JSON as UTF-8 bytes on success
+/// * Throws error string on failure
+#[wasm_bindgen(js_name = "formatJsonBytes")]
+pub fn js_format_json_bytes(input: &[u8], indent: &str) -> Result<Vec<u8>, JsValue> {
+    js_format_json(utf8_input(input)?, indent).map(String::into_bytes)
+}
+
+/// Minify UTF-8 JSON bytes.
+///
+/// # Returns
+/// * Minified JSON as UTF-8 bytes on success
+/// * Throws error string on failure
+#[wasm_bindgen(js_name = "minifyJsonBytes")]
+pub fn js_minify_json_bytes(input: &[u8]) -> Result<Vec<u8>, JsValue> {
+    js_minify_json(utf8_input(input)?).map(String::into_bytes)
+}
+
+/// Validate UTF-8 JSON bytes, returning the same JSON string as `validateJson`.
+///
+/// Invalid UTF-8 makes the input invalid, with an error naming the byte
+/// offset of the bad sequence.
+#[wasm_bindgen(js_name = "validateJsonBytes")]
+pub fn js_validate_json_bytes(input: &[u8]) -> String {
+    match std::str::from_utf8(input) {
+        Ok(text) => js_validate_json(text),
+        Err(e) => validation_json(&ValidationResult::invalid(utf8_error(input, e))),
+    }
+}
+
+/// Outputs of `processJsonBytes`, owned by the WASM module until `free()`.
+#[wasm_bindgen]
+pub struct ProcessOutput {
+    validation: String,
+    formatted: Option<Vec<u8>>,
+    minified: Option<Vec<u8>>,
+}
+
+#[wasm_bindgen]
+impl ProcessOutput {
+    /// Validation result in the same JSON shape as `validateJson`.
+    #[wasm_bindgen(getter)]
+    pub fn validation(&self) -> String {
+        self.validation.clone()
+    }
+
+    /// Formatted JSON as UTF-8 bytes, if requested and the input is valid.
+    ///
+    /// Hands the buffer over: later calls return `None`.
+    #[wasm_bindgen(js_name = "takeFormatted")]
+    pub fn take_formatted(&mut self) -> Option<Vec<u8>> {
+        self.formatted.take()
+    }
+
+    /// Minified JSON as UTF-8 bytes, if requested and the input is valid.
+    ///
+    /// Hands the buffer over: later calls return `None`.
+    #[wasm_bindgen(js_name = "takeMinified")]
+    pub fn take_minified(&mut self) -> Option<Vec<u8>> {
+        self.minified.take()
+    }
+}
+
+/// Parse UTF-8 JSON bytes once and produce the requested outputs.
+///
+/// # Arguments
+/// * `input` - UTF-8 encoded JSON
+/// * `indent` - Indent style for the formatted output
+/// * `outputs` - Bitwise OR of 1 (formatted), 2 (minified), 4 (stats)
+#[wasm_bindgen(js_name = "processJsonBytes")]
+pub fn js_process_json_bytes(input: &[u8], indent: &str, outputs: u32) -> Result<ProcessOutput, JsValue> {
+    let style = parse_indent_style(indent)?;
+    // Invalid UTF-8 makes the input invalid, with no outputs
+    let text = match std::str::from_utf8(input) {
+        Ok(text) => text,
+        Err(e) => {
+            return Ok(ProcessOutput {
+                validation: validation_json(&ValidationResult::invalid(utf8_error(input, e))),
+                formatted: None,
+                minified: None,
+            })
+        }
+    };
+    let result = processor::process_json(text, style, outputs);
+    Ok(ProcessOutput {
+        validation: validation_json(&result.validation),
+        formatted: result.formatted.map(String::into_bytes),
+        minified: result.minified.map(String::into_bytes),
+    })
+}
+
+/// Highlight UTF-8 JSON bytes, returning HTML as UTF-8 bytes.
+///
+/// Throws on invalid UTF-8 rather than show replacement characters.
+#[wasm_bindgen(js_name = "highlightJsonBytes")]
+pub fn js_highlight_json_bytes(input: &[u8]) -> Result<Vec<u8>, JsValue> {
+    Ok(highlighter::highlight_json(utf8_input(input)?).into_bytes())
+}
+
 // ============================================================================
 // XML WASM Exports (Spike - Q1 Investigation)
 // ============================================================================
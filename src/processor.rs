@@ -0,0 +1,105 @@
+use crate::formatter::format_parsed;
+use crate::types::{FormatError, IndentStyle, JsonStats, ValidationResult};
+use crate::validator::stats_for;
+use serde_json::Value;
+
+/// Request the indented output.
+pub const OUTPUT_FORMATTED: u32 = 1;
+/// Request the minified output.
+pub const OUTPUT_MINIFIED: u32 = 1 << 1;
+/// Request structure statistics.
+pub const OUTPUT_STATS: u32 = 1 << 2;
+
+/// Outputs derived from a single parse of a JSON document.
+#[derive(Clone, Debug)]
+pub struct ProcessResult {
+    /// Validity and error position; stats are filled only for `OUTPUT_STATS`
+    pub validation: ValidationResult,
+    pub formatted: Option<String>,
+    pub minified: Option<String>,
+}
+
+/// Parse JSON once and produce every requested output from the same value.
+///
+/// # Arguments
+/// * `input` - The JSON string to process
+/// * `indent` - Indentation style for the formatted output
+/// * `outputs` - Bitwise OR of the `OUTPUT_*` flags
+///
+/// # Returns
+/// * `ProcessResult` with the requested outputs, or only the validation
+///   error if the input is invalid
+pub fn process_json(input: &str, indent: IndentStyle, outputs: u32) -> ProcessResult {
+    let value: Value = match serde_json::from_str(input) {
+        Ok(value) => value,
+        Err(e) => {
+            return ProcessResult {
+                validation: ValidationResult::invalid(FormatError::new(
+                    e.to_string(),
+                    e.line(),
+                    e.column(),
+                )),
+                formatted: None,
+                minified: None,
+            }
+        }
+    };
+
+    let stats = if outputs & OUTPUT_STATS != 0 {
+        stats_for(&value)
+    } else {
+        JsonStats::default()
+    };
+    let formatted = (outputs & OUTPUT_FORMATTED != 0)
+        .then(|| format_parsed(&value, indent, input.len() * 2));
+    let minified = (outputs & OUTPUT_MINIFIED != 0)
+        .then(|| serde_json::to_string(&value).unwrap_or_default());
+
+    ProcessResult {
+        validation: ValidationResult::valid(stats),
+        formatted,
+        minified,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::formatter::{format_json, minify_json};
+    use crate::validator::validate_json;
+
+    #[test]
+    fn test_process_matches_separate_operations() {
+        let input = r#"{"name": "test", "items": [1, true, null]}"#;
+        let result = process_json(
+            input,
+            IndentStyle::Spaces(2),
+            OUTPUT_FORMATTED | OUTPUT_MINIFIED | OUTPUT_STATS,
+        );
+
+        assert!(result.validation.is_valid);
+        assert_eq!(result.validation.stats, validate_json(input).stats);
+        assert_eq!(
+            result.formatted.unwrap(),
+            format_json(input, IndentStyle::Spaces(2)).unwrap()
+        );
+        assert_eq!(result.minified.unwrap(), minify_json(input).unwrap());
+    }
+
+    #[test]
+    fn test_process_only_requested_outputs() {
+        let result = process_json("[1, 2]", IndentStyle::Tabs, OUTPUT_MINIFIED);
+        assert!(result.validation.is_valid);
+        assert!(result.formatted.is_none());
+        assert_eq!(result.minified.as_deref(), Some("[1,2]"));
+        assert_eq!(result.validation.stats, JsonStats::default());
+    }
+
+    #[test]
+    fn test_process_invalid_json() {
+        let result = process_json("{invalid}", IndentStyle::Spaces(4), OUTPUT_FORMATTED);
+        assert!(!result.validation.is_valid);
+        assert_eq!(result.validation.error.unwrap().line, 1);
+        assert!(result.formatted.is_none());
+    }
+}
@@ -221,3 +221,11 @@ fn test_performance_1mb_json() {
 
     println!("Performance test: {}KB formatted in {}ms", size_kb, duration_ms);
 }
+
+#[test]
+fn test_format_json_bytes_round_trip() {
+    let input = r#"{"name":"Zoë","age":30}"#;
+    let result = crate::js_format_json_bytes(input.as_bytes(), "spaces:2").unwrap();
+    let expected = format_json(input, IndentStyle::Spaces(2)).unwrap();
+    assert_eq!(result, expected.into_bytes());
+}
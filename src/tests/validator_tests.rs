@@ -189,3 +189,30 @@ fn test_validate_unicode() {
     assert!(result.is_valid);
     assert_eq!(result.stats.string_count, 2);
 }
+
+#[test]
+fn test_validate_bytes_rejects_invalid_utf8() {
+    let input = b"{\"a\": 1,\n \"b\": \"x\xff\"}";
+    let result = crate::js_validate_json_bytes(input);
+    assert!(result.contains(r#""isValid":false"#));
+    assert!(result.contains("Invalid UTF-8 at byte offset 17"));
+    assert!(result.contains(r#""line":2,"column":9"#));
+}
+
+#[test]
+fn test_process_bytes_invalid_utf8_has_no_outputs() {
+    let mut output = crate::js_process_json_bytes(b"[\"\xc3\"]", "spaces:2", 3).unwrap();
+    assert!(output.validation().contains("Invalid UTF-8 at byte offset 2"));
+    assert!(output.take_formatted().is_none());
+    assert!(output.take_minified().is_none());
+}
+
+#[test]
+fn test_process_bytes_outputs_are_taken_once() {
+    let mut output = crate::js_process_json_bytes(br#"{"a":[1,2]}"#, "spaces:2", 3).unwrap();
+    assert!(output.validation().contains(r#""isValid":true"#));
+    assert_eq!(output.take_minified().unwrap(), br#"{"a":[1,2]}"#.to_vec());
+    assert!(output.take_minified().is_none());
+    assert!(output.take_formatted().is_some());
+    assert!(output.take_formatted().is_none());
+}
@@ -10,11 +10,7 @@ use serde_json::Value;
 /// * `ValidationResult` containing validity status, error info (if invalid), and statistics
 pub fn validate_json(input: &str) -> ValidationResult {
     match serde_json::from_str::<Value>(input) {
-        Ok(value) => {
-            let mut stats = JsonStats::default();
-            collect_stats(&value, 0, &mut stats);
-            ValidationResult::valid(stats)
-        }
+        Ok(value) => ValidationResult::valid(stats_for(&value)),
         Err(e) => {
             let error = FormatError::new(e.to_string(), e.line(), e.column());
             ValidationResult::invalid(error)
@@ -22,6 +18,13 @@ pub fn validate_json(input: &str) -> ValidationResult {
     }
 }
 
+/// Collect statistics for an already parsed JSON value.
+pub fn stats_for(value: &Value) -> JsonStats {
+    let mut stats = JsonStats::default();
+    collect_stats(value, 0, &mut stats);
+    stats
+}
+
 /// Recursively collect statistics from a JSON value tree.
 fn collect_stats(value: &Value, depth: usize, stats: &mut JsonStats) {
     // Update max depth